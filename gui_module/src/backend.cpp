@@ -19,7 +19,7 @@ std::string getSharedLibraryPath() {
 void backend::initialize()
 {
     if (is_instance_initialized_before) {
-        log("[Backend] Active instance initialized already!\n");
+        log_info(BACKEND, "[Backend] Active instance initialized already!\n");
         return;
     }
 
@@ -27,11 +27,7 @@ void backend::initialize()
     shuttingDown_ = false;
     runLoop_ = true;
     video_memory_changed = {true};
-    for (int y = 0; y < V_HEIGHT; y++) {
-        for (int x = 0; x < V_WIDTH; x++) {
-            binary_video_buffer[x][y] = '.';
-        }
-    }
+    binary_video_buffer.fill('.');
 
     // Place a message in the middle
     const char* msg = "(Video Memory Not Initialized)";
@@ -39,16 +35,10 @@ void backend::initialize()
     const int mid_x       = (V_WIDTH  - msg_len) / 2;
     constexpr int mid_y   = (V_HEIGHT - 1) / 2;
 
-    for (int i = 0; i < msg_len; i++) {
-        binary_video_buffer[mid_x + i][mid_y] = msg[i];
-    }
+    binary_video_buffer.write_text(mid_x, mid_y, msg);
 
     cursor_pos_ = { 0, 0 };
-    char_at_cursor_position = '.';
-    cursor_position_is_cursor_char_itself = false;
-    cursor_char = '_';
     cursor_visibility = true;
-    cursor_worker_running = false;
 
     ioc_.restart();
 
@@ -58,44 +48,44 @@ void backend::initialize()
 
     acceptor_.open(endpoint.protocol(), ec);
     if (ec) {
-        log("[Backend] Acceptor open: ", ec.message(), "\b");
+        log_error(BACKEND, "[Backend] Acceptor open: ", ec.message(), "\b");
         return;
     }
     acceptor_.set_option(asio::socket_base::reuse_address(true), ec);
     acceptor_.bind(endpoint, ec);
     if (ec) {
-        log("[Backend] Acceptor bind: ", ec.message(), "\n");
+        log_error(BACKEND, "[Backend] Acceptor bind: ", ec.message(), "\n");
         return;
     }
     acceptor_.listen(asio::socket_base::max_listen_connections, ec);
     if (ec) {
-        log("[Backend] Acceptor listen: ", ec.message(), "\n");
+        log_error(BACKEND, "[Backend] Acceptor listen: ", ec.message(), "\n");
         return;
     }
 
-    log("[Backend] Endpoint created! TCP listening on port 8080...\n");
+    log_info(BACKEND, "[Backend] Endpoint created! TCP listening on port 8080...\n");
     // Start async accept
     start_accept();
 
     // 2) Launch a thread to run the io_context so async ops happen
     IOThread = std::thread([this] {
         debug::set_thread_name("IO Thread");
+        if (const auto core = executor::core_for(thread_role_t::IO)) {
+            executor::pin_current_thread(*core);
+        }
         try {
             ioc_.run();
         } catch (std::exception &e) {
-            log("[IO Thread] exception: ", e.what(), "\n");
+            log_error(BACKEND, "[IO Thread] exception: ", e.what(), "\n");
         }
 
-        log("[IO Thread] Thread exited!\n");
+        log_info(BACKEND, "[IO Thread] Thread exited!\n");
     });
 
-    // 3) Launch the render loop in a separate thread
+    // 3) Launch the render loop in a separate thread, viewers draw and blink the cursor themselves
     renderThread_ = std::thread(&backend::render_loop, this);
 
-    // 4) Start cursor worker
-    start_cursor_worker();
-
-    log("[Backend] Backend initialized! Instance created at http://127.0.0.1:8080\n");
+    log_info(BACKEND, "[Backend] Backend initialized! Instance created at http://127.0.0.1:8080\n");
 }
 
 // Called on program exit or plugin unload
@@ -105,44 +95,39 @@ void backend::cleanup()
         // Already shutting down
         return;
     }
-    log("[Backend] Sending shutdown request!\n");
+    log_info(BACKEND, "[Backend] Sending shutdown request!\n");
     // Request shutdown
     request_shutdown();
 
-    log("[Backend] Request sent, waiting for threads to finish!\n");
+    log_info(BACKEND, "[Backend] Request sent, waiting for threads to finish!\n");
     // Wait for render loop to exit
     if (renderThread_.joinable()) {
         renderThread_.join();
     }
-    log("[Backend] Threads finished!\n");
+    log_info(BACKEND, "[Backend] Threads finished!\n");
 
-    log("[Backend] Shutting down cursor worker!\n");
-    // Stop cursor worker
-    stop_cursor_worker();
-    log("[Backend] Cursor worker shutdown complete!\n");
-
-    log("[Backend] Shutting down acceptor!\n");
+    log_info(BACKEND, "[Backend] Shutting down acceptor!\n");
     // The ioc_ won't stop until all async ops are done, but at least we
     // close the acceptor to avoid new connections
     beast::error_code ec;
     acceptor_.close(ec);
-    log("[Backend] Acceptor stopped!\n");
+    log_info(BACKEND, "[Backend] Acceptor stopped!\n");
 
-    log("[Backend] Close all websockets!\n");
+    log_info(BACKEND, "[Backend] Close all websockets!\n");
     // Force close all websockets
     close_all_websockets();
-    log("[Backend] All websockets terminated!\n");
+    log_info(BACKEND, "[Backend] All websockets terminated!\n");
 
-    log("[Backend] Stopping event to IOC!\n");
+    log_info(BACKEND, "[Backend] Stopping event to IOC!\n");
     // Post a stop event to ioc_
     ioc_.stop();
     if (IOThread.joinable()) {
         IOThread.join();
     }
-    log("[Backend] Stopped event to IOC!\n");
+    log_info(BACKEND, "[Backend] Stopped event to IOC!\n");
 
     is_instance_initialized_before = false;
-    log("[Backend] Backend cleanup complete!\n");
+    log_info(BACKEND, "[Backend] Backend cleanup complete!\n");
 }
 
 // Called from "/shutdown" or your own code
@@ -172,7 +157,7 @@ std::string backend::make_html_page()
     std::string webpage = prefix + "/resources/index.html";
     std::ifstream infile(webpage);
     if (!infile.is_open()) {
-        log("[Backend] Failed to open webpage ", webpage, ", using embedded page!\n");
+        log_warning(BACKEND, "[Backend] Failed to open webpage ", webpage, ", using embedded page!\n");
         return fallback_page;
     }
 
@@ -189,7 +174,7 @@ std::string backend::make_html_page()
 void backend::register_websocket(std::shared_ptr<websocket_session> ws)
 {
     std::lock_guard<std::mutex> lock(wsMutex_);
-    websockets_.push_back(ws);
+    awaiting_keyframe_.push_back(ws);
 }
 
 // Start async accept
@@ -215,66 +200,64 @@ void backend::start_accept()
 void backend::render_loop()
 {
     debug::set_thread_name("UI Render");
+    if (const auto core = executor::core_for(thread_role_t::UI)) {
+        executor::pin_current_thread(*core);
+    }
 
-    int frameCount = 0;
+    sent_video_buffer = binary_video_buffer;
+    sent_cursor = { };
     while (runLoop_) {
-        frameCount++;
+        apply_events();
 
-        // Build a text frame
+        // Viewers only hear about what changed since the last frame they got, an idle screen sends nothing
+        std::shared_ptr<const std::string> delta;
+        if (video_memory_changed.exchange(false))
         {
-            std::lock_guard<std::mutex> lk(videoMutex_);
-            auto now = std::chrono::system_clock::now();
-            auto epoch = now.time_since_epoch();
-            const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(epoch).count();
-            const auto seconds = milliseconds / 1000;
-            const auto microseconds = milliseconds % 1000;
-            videoBuffer_[0] = "Frame: " + std::to_string(frameCount)
-                + " Timestamp: " + std::to_string(seconds) + "." + std::to_string(microseconds);
-            videoBuffer_[0].resize(V_WIDTH, ' ');
+            const frame_protocol::cursor_state_t cursor { .position = cursor_pos_, .visible = cursor_visibility };
+            if (auto message = frame_protocol::encode_delta(binary_video_buffer, sent_video_buffer,
+                    cursor, sent_cursor); !message.empty())
+            {
+                delta = std::make_shared<const std::string>(std::move(message));
+                sent_video_buffer = binary_video_buffer;
+                sent_cursor = cursor;
+            }
         }
 
-        // convert
-        if (video_memory_changed)
+        if (delta) {
+            broadcast(delta);
+        }
+
+        // Newcomers start from the screen the others have now
+        std::vector<std::shared_ptr<websocket_session>> newcomers;
         {
-            std::lock_guard<std::mutex> lk(videoMutex_);
-            std::lock_guard<std::mutex> lk2(BinaryBufferMutex);
-            int y = 0;
-            for (auto it = videoBuffer_.begin() + 1;
-                it != videoBuffer_.end(); ++it, ++y)
-            {
-                for (int x = 0; x < V_WIDTH; ++x)
-                {
-                    auto ch = static_cast<char>(binary_video_buffer[x][y]);
-                    if (ch < 0x20 || ch > 0x7e) { // character not displayable
-                        it->at(x) = '.';
-                    } else {
-                        it->at(x) = ch;
-                    }
+            std::lock_guard<std::mutex> lock(wsMutex_);
+            for (const auto & weak : awaiting_keyframe_) {
+                if (auto sp = weak.lock()) {
+                    newcomers.push_back(std::move(sp));
+                    websockets_.push_back(weak);
                 }
             }
 
-            video_memory_changed = false;
+            awaiting_keyframe_.clear();
         }
 
-        std::string text;
+        if (!newcomers.empty())
         {
-            std::lock_guard<std::mutex> lk(videoMutex_);
-            for (auto &row : videoBuffer_) {
-                text += row + "\n";
+            const auto keyframe = std::make_shared<const std::string>(
+                frame_protocol::encode_keyframe(sent_video_buffer, sent_cursor));
+            for (const auto & ws : newcomers) {
+                ws->send_binary(keyframe);
             }
         }
 
-        // Send text to all websockets
-        broadcast(text);
-
         std::this_thread::sleep_for(5ms);
     }
 
-    log("[Render] Exiting loop\n");
+    log_info(BACKEND, "[Render] Exiting loop\n");
 }
 
 // Send a message to all WebSocket sessions
-void backend::broadcast(const std::string &text)
+void backend::broadcast(const std::shared_ptr<const std::string> &data)
 {
     std::lock_guard<std::mutex> lock(wsMutex_);
     // Clean up any that have died
@@ -285,7 +268,7 @@ void backend::broadcast(const std::string &text)
             it = websockets_.erase(it);
         } else {
             // async send
-            sp->send_text(text);
+            sp->send_binary(data);
             ++it;
         }
     }
@@ -300,39 +283,19 @@ void backend::close_all_websockets()
             sp->close(); // calls async_close
         }
     }
-    websockets_.clear();
-}
-
-void backend::swap_cursor_with_char_at_pos()
-{
-    debug::set_thread_name("UI Cursor");
-    while (cursor_worker_running)
-    {
-        if (cursor_visibility)
-        {
-            std::lock_guard<std::mutex> lock(BinaryBufferMutex);
-            const auto [x, y] = cursor_pos_.load();
-            if (cursor_position_is_cursor_char_itself) {
-                binary_video_buffer[x][y] = char_at_cursor_position;
-                cursor_position_is_cursor_char_itself = false;
-            } else {
-                // back up the current character
-                char_at_cursor_position = binary_video_buffer[x][y];
-                // set the position to cursor
-                binary_video_buffer[x][y] = cursor_char;
-                cursor_position_is_cursor_char_itself = true;
-            }
-
-            video_memory_changed = true;
+    for (auto &weak : awaiting_keyframe_) {
+        if (const auto sp = weak.lock()) {
+            sp->close();
         }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
     }
+    websockets_.clear();
+    awaiting_keyframe_.clear();
 }
 
 void backend::set_cursor(int x, int y)
 {
     cursor_pos_.store({x, y});
+    video_memory_changed = true; // viewers get the cursor with the next delta
 }
 
 CursorPosition backend::get_cursor()
@@ -342,25 +305,31 @@ CursorPosition backend::get_cursor()
 
 void backend::display_char(int x, int y, int ch)
 {
-    std::lock_guard<std::mutex> lock(BinaryBufferMutex);
-    if (const auto cur_pos = cursor_pos_.load();
-        cur_pos == CursorPosition { .x = x, .y = y  })
-    {
-        cursor_position_is_cursor_char_itself = false; // force update
-    }
+    events.display_char(x, y, ch);
+}
 
-    binary_video_buffer[x][y] = ch;
-    video_memory_changed = true;
+void backend::display_region(int x, int y, int w, int h, const uint8_t * cells, int stride)
+{
+    events.display_region(x, y, w, h, cells, stride);
+}
+
+void backend::scroll(int lines)
+{
+    events.scroll(lines);
 }
 
 void backend::set_cursor_visibility(bool visibility)
 {
-    if (cursor_position_is_cursor_char_itself && !visibility)
-    {
-        std::lock_guard<std::mutex> lock(BinaryBufferMutex);
-        const auto [x, y] = cursor_pos_.load();
-        binary_video_buffer[x][y] = char_at_cursor_position;
+    events.set_cursor_visibility(visibility);
+}
+
+// Everything posted since the last frame, in one batch. Only the render loop touches binary_video_buffer
+void backend::apply_events()
+{
+    if (!events.drain(frame)) {
+        return;
     }
 
-    cursor_visibility = visibility;
+    cursor_visibility = binary_video_buffer.apply(frame, cursor_visibility);
+    video_memory_changed = true;
 }
@@ -25,14 +25,56 @@ const std::string fallback_page = R"HTML(
     const screenEl = document.getElementById('screen');
     // Connect to WebSocket at /ws
     const ws = new WebSocket("ws://" + location.host + "/ws");
+    ws.binaryType = "arraybuffer";
+
+    // Screen updates, see SysdarftFrameProtocol.h. A keyframe first, then only what changed
+    let rows = [];
+    let cursor = { x: 0, y: 0, visible: false };
+    let blink = true;
+
+    // the server only sends where the cursor is, it is blinked here
+    function render() {
+      screenEl.textContent = rows.map((row, r) => (cursor.visible && blink && r === cursor.y)
+        ? row.map((ch, c) => c === cursor.x ? '_' : ch).join('') : row.join('')).join('\n');
+    }
+
+    setInterval(() => { blink = !blink; render(); }, 500);
 
     ws.onopen = () => {
       console.log("WebSocket open");
     };
 
     ws.onmessage = (evt) => {
-      // The server sends the entire video buffer as text
-      screenEl.textContent = evt.data;
+      const view = new DataView(evt.data);
+      const bytes = new Uint8Array(evt.data);
+      const put = (r, c, glyph) => {
+        if (r < rows.length && c < rows[r].length) {
+          rows[r][c] = (glyph < 0x20 || glyph > 0x7e) ? '.' : String.fromCharCode(glyph);
+        }
+      };
+
+      cursor = { x: view.getUint16(2, true), y: view.getUint16(4, true), visible: (bytes[1] & 1) !== 0 };
+      if (bytes[0] === 1) {
+        const cols = bytes[6];
+        rows = [];
+        for (let r = 0; r < bytes[7]; r++) {
+          rows.push(new Array(cols).fill('.'));
+          for (let c = 0; c < cols; c++) {
+            put(r, c, bytes[8 + r * cols + c]);
+          }
+        }
+      } else if (bytes[0] === 2) {
+        let offset = 8;
+        for (let i = 0; i < view.getUint16(6, true); i++) {
+          const length = bytes[offset + 2];
+          for (let k = 0; k < length; k++) {
+            put(bytes[offset], bytes[offset + 1] + k, bytes[offset + 3 + k]);
+          }
+          offset += 3 + 2 * length;
+        }
+      }
+
+      render();
     };
 
     ws.onclose = () => {
@@ -13,6 +13,10 @@
 #include <mutex>
 #include <atomic>
 #include <SysdarftCursesUI.h>
+#include <SysdarftUIEventQueue.h>
+#include <SysdarftTextFramebuffer.h>
+#include <SysdarftFrameProtocol.h>
+#include <SysdarftExecutor.h>
 #include <fstream>
 #include <unordered_map>
 #include <cctype> // For std::tolower
@@ -34,8 +38,9 @@ public:
     // Start the asynchronous acceptance, then read loop.
     void run(http::request<http::string_body> req);
 
-    // Called to send data (e.g., from a render loop)
+    // Called to send data (e.g., from a render loop). Held back until the handshake is done
     void send_text(const std::string &text);
+    void send_binary(std::shared_ptr<const std::string> data);
 
     // Initiate an async close handshake
     void close();
@@ -52,7 +57,13 @@ private:
 
     std::atomic <bool> closed_ = false; // track if we've initiated a close
     std::atomic <bool> writing_ = false; // track if a write is in progress
-    std::deque<std::string> outbox_; // queued messages
+    bool accepted_ = false; // handshake done, only touched on the executor
+    struct message_t {
+        std::shared_ptr<const std::string> data; // shared by all sessions a frame is broadcast to
+        bool binary;
+    };
+    std::deque<message_t> outbox_; // queued messages
+    void queue(message_t message);
     std::vector < std::thread > input_processor_threads_;
 };
 
@@ -94,16 +105,21 @@ private:
     // Keep track of all websockets (shared_ptr) so we can close them
     std::mutex wsMutex_;
     std::vector<std::weak_ptr<websocket_session>> websockets_;
+    // connected since the last frame, they get a keyframe before any delta
+    std::vector<std::weak_ptr<websocket_session>> awaiting_keyframe_;
 
     std::atomic<bool> shuttingDown_{false};
 
-    // For text "Frame: X" in the UI
-    std::mutex videoMutex_;
-    std::vector<std::string> videoBuffer_;
-    /* raw buffer */
-    /* needs to be converted and discard non-ASCII characters */
-    std::mutex BinaryBufferMutex;
-    std::array < std::array < int, V_HEIGHT >, V_WIDTH > binary_video_buffer{};
+    /* raw buffer, viewers map non-ASCII characters themselves. The cursor is not drawn into it */
+    SysdarftTextFramebuffer binary_video_buffer;
+    // what the viewers have, deltas are taken against it. Both only touched by the render loop
+    SysdarftTextFramebuffer sent_video_buffer;
+    frame_protocol::cursor_state_t sent_cursor { };
+
+    // emulator updates, applied by the render loop once per frame
+    SysdarftUIEventQueue events;
+    ui_frame_t frame;
+    void apply_events();
 
     std::atomic<bool> is_instance_initialized_before = {false};
     std::atomic<bool> video_memory_changed = {true};
@@ -112,7 +128,6 @@ public:
     backend()
         : ioc_()
           , acceptor_(ioc_)
-          , videoBuffer_(V_HEIGHT + 1, std::string(V_WIDTH, '.'))
     { }
 
     // Called once: start acceptor + run ioc in a thread, start render thread
@@ -138,42 +153,21 @@ private:
     void render_loop();
 
     // Send a message to all WebSocket sessions
-    void broadcast(const std::string &text);
+    void broadcast(const std::shared_ptr<const std::string> &data);
 
     // Close all websockets gracefully
     void close_all_websockets();
 
     std::atomic<CursorPosition> cursor_pos_ = { { 0, 0 } };
-    std::atomic<int> char_at_cursor_position = '.';
-    std::atomic<bool> cursor_position_is_cursor_char_itself = false;
-    std::atomic<char> cursor_char = '_';
     std::atomic<bool> cursor_visibility = true;
-    std::atomic<bool> cursor_worker_running = false;
-    std::thread cursor_worker_thread;
-    void swap_cursor_with_char_at_pos();
-
-    void start_cursor_worker()
-    {
-        cursor_worker_running = true;
-        cursor_worker_thread = std::thread(&backend::swap_cursor_with_char_at_pos, this);
-        log("[Cursor] Started cursor worker thread\n");
-    }
-
-    void stop_cursor_worker()
-    {
-        cursor_worker_running = false;
-        if (cursor_worker_thread.joinable()) {
-            cursor_worker_thread.join();
-        }
-
-        log("[Cursor] Stopped cursor worker thread\n");
-    }
 
 public:
     // dummy
     void set_cursor(int, int);
     CursorPosition get_cursor();
     void display_char(int, int, int);
+    void display_region(int, int, int, int, const uint8_t *, int);
+    void scroll(int);
     void set_cursor_visibility(bool);
 };
 
@@ -39,6 +39,8 @@ int SYSDARFT_EXPORT_SYMBOL module_init(void)
     g_ui_set_cursor_install(backend_, set_cursor);
     g_ui_get_cursor_install(backend_, get_cursor);
     g_ui_display_char_install(backend_, display_char);
+    g_ui_display_region_install(backend_, display_region);
+    g_ui_scroll_install(backend_, scroll);
     g_ui_set_cur_vsb_install(backend_, set_cursor_visibility);
     g_input_processor_install(input_dummy, input_monitor);
     log("UI instance overridden!\n");
@@ -15,23 +15,40 @@ void websocket_session::run(http::request<http::string_body> req)
         req,
         [self](beast::error_code ec) {
             if (ec) {
-                log("[WebSocket] accept error: ", ec.message(), "\n");
+                log_error(BACKEND, "[WebSocket] accept error: ", ec.message(), "\n");
                 return;
             }
+
+            // frames queued during the handshake, the keyframe first
+            self->accepted_ = true;
+            if (!self->writing_) {
+                self->do_write();
+            }
+
             self->do_read();
         });
 }
 
 // Called to send data (e.g., from a render loop)
 void websocket_session::send_text(const std::string &text)
+{
+    queue({ .data = std::make_shared<const std::string>(text), .binary = false });
+}
+
+void websocket_session::send_binary(std::shared_ptr<const std::string> data)
+{
+    queue({ .data = std::move(data), .binary = true });
+}
+
+void websocket_session::queue(message_t message)
 {
     // Post to the same I/O context to ensure thread safety
     auto self = shared_from_this();
     asio::post(ws_.get_executor(),
-               [self, text]() {
+               [self, message = std::move(message)]() {
                    // Queue the message in a buffer
-                   self->outbox_.push_back(text);
-                   if (!self->writing_) {
+                   self->outbox_.push_back(message);
+                   if (self->accepted_ && !self->writing_) {
                        self->do_write();
                    }
                }
@@ -54,7 +71,7 @@ void websocket_session::close()
                            [self](beast::error_code ec)
                            {
                                if (ec) {
-                                   log("[WebSocket] close error: ", ec.message(), "\n");
+                                   log_error(BACKEND, "[WebSocket] close error: ", ec.message(), "\n");
                                }
                            });
                    }
@@ -82,16 +99,16 @@ void websocket_session::do_read()
                 self->buffer_.size());
 
             if (ec == websocket::error::closed) {
-                log("[WebSocket] client closed websocket\n");
+                log_info(BACKEND, "[WebSocket] client closed websocket\n");
                 return; // normal closure
             } else if (ec) {
                 // Some error
-                log("[WebSocket] read error: ", ec.message(), "\n");
+                log_error(BACKEND, "[WebSocket] read error: ", ec.message(), "\n");
                 return;
             }
 
             // We have "data"
-            log("[WebSocket] Received: ", std::string(data), "\n");
+            log_debug(BACKEND, "[WebSocket] Received: ", std::string(data), "\n");
             auto input_handler = [](const std::string & _data) {
                 debug::set_thread_name("Async Input Handler");
                 const auto key = convertJsonToKeyEvent(_data);
@@ -121,12 +138,12 @@ void websocket_session::do_write()
     outbox_.pop_front();
 
     auto self = shared_from_this();
-    ws_.text(true);
+    ws_.binary(message.binary);
     ws_.async_write(
-        asio::buffer(message),
+        asio::buffer(*message.data),
         [self, message](beast::error_code ec, std::size_t) {
             if (ec) {
-                log("[WebSocket] write error: ", ec.message(), "\n");
+                log_error(BACKEND, "[WebSocket] write error: ", ec.message(), "\n");
                 return;
             }
             // Send next message if any
@@ -0,0 +1,174 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <getopt.h>
+#include <SysdarftDebug.h>
+#include <SysdarftAssembler.h>
+
+void print_help(const char *program_name)
+{
+    std::cout
+        << "Usage: " << program_name << " [OPTIONS] SOURCE\n"
+        << "Options:\n"
+        << "    -h, --help        Show this help message\n"
+        << "    -v, --version     Show version information\n"
+        << "    -o, --output      Output file (default: a.bin, or a.sdo with --relocatable)\n"
+        << "    -r, --relocatable Write a relocatable object for sysdarft-ld instead of an image. An object\n"
+        << "                      already built from the same source is left untouched\n"
+        << "    -O, --origin      Address the image is mapped at (default: BIOS_START, 0xC1800)\n"
+        << "    -j, --jobs        Number of worker threads (default: one per hardware thread)\n"
+        << "    -s, --symbols     Print the symbol table of the image after assembling\n"
+        << "    -C, --compact     Use the compact encoding: short immediates and register only memory operands\n"
+        << "    -c, --cache       Line cache file. Only lines changed since the last run are encoded again\n"
+        << "    -V, --verbose     Enable verbose mode. Additional debug messages will be printed\n"
+        << std::endl;
+}
+
+void print_version()
+{
+    std::cout
+        << "Sysdarft Assembler Version " << SYSDARFT_VERSION << std::endl
+        << SYSDARFT_INFORMATION << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    debug::set_thread_name("Sysdarft AS");
+
+    static struct option long_options[] = {
+        {"help",    no_argument,       nullptr, 'h'},
+        {"version", no_argument,       nullptr, 'v'},
+        {"output",  required_argument, nullptr, 'o'},
+        {"origin",  required_argument, nullptr, 'O'},
+        {"jobs",    required_argument, nullptr, 'j'},
+        {"symbols", no_argument,       nullptr, 's'},
+        {"relocatable", no_argument,   nullptr, 'r'},
+        {"cache",   required_argument, nullptr, 'c'},
+        {"compact", no_argument,       nullptr, 'C'},
+        {"verbose", no_argument,       nullptr, 'V'},
+        {nullptr,   0,                 nullptr,  0 }
+    };
+
+    try
+    {
+        std::string output;
+        uint64_t origin = BIOS_START;
+        unsigned int jobs = 0;
+        bool print_symbols = false;
+        bool relocatable = false;
+        encoding_mode_t mode = STANDARD_ENCODING;
+        std::string cache_file;
+
+        for (int option; (option = getopt_long(argc, argv, "hvo:O:j:src:CV", long_options, nullptr)) != -1; )
+        {
+            switch (option)
+            {
+            case 'h': print_help(argv[0]); return EXIT_SUCCESS;
+            case 'v': print_version(); return EXIT_SUCCESS;
+            case 'o': output = optarg; break;
+            case 'O': origin = std::stoull(optarg, nullptr, 0); break;
+            case 'j': jobs = static_cast<unsigned int>(std::stoul(optarg, nullptr, 0)); break;
+            case 's': print_symbols = true; break;
+            case 'r': relocatable = true; break;
+            case 'c': cache_file = optarg; break;
+            case 'C': mode = COMPACT_ENCODING; break;
+            case 'V': debug::verbose = true; break;
+            default: print_help(argv[0]); return EXIT_FAILURE;
+            }
+        }
+
+        if (optind + 1 != argc)
+        {
+            log("Expected exactly one source file.\n");
+            print_help(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        const std::string source_file = argv[optind];
+        std::ifstream input(source_file, std::ios::binary);
+        if (!input) {
+            std::cerr << "Cannot open " << source_file << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::stringstream source;
+        source << input.rdbuf();
+
+        if (output.empty()) {
+            output = relocatable ? "a.sdo" : "a.bin";
+        }
+
+        const auto text = source.str();
+        SysdarftAssembler assembler(origin, jobs, mode);
+        if (relocatable && sysdarft_object_t::peek_source_hash(output) == assembler.source_hash(text))
+        {
+            log("[Assembler] ", output, " is up to date\n");
+            return EXIT_SUCCESS;
+        }
+
+        if (!cache_file.empty() && assembler.load_cache(cache_file)) {
+            log("[Assembler] Loaded line cache from ", cache_file, "\n");
+        }
+
+        auto print_statistics = [&assembler]
+        {
+            if (debug::verbose) {
+                const auto [instructions, encoded] = assembler.get_statistics();
+                log("[Assembler] ", instructions, " instructions, ", encoded, " encoded, ",
+                    instructions - encoded, " reused from cache\n");
+            }
+        };
+
+        if (relocatable)
+        {
+            const auto object = assembler.assemble_object(text, source_file);
+            print_statistics();
+            if (!cache_file.empty()) {
+                assembler.save_cache(cache_file);
+            }
+
+            object.save(output);
+            return EXIT_SUCCESS;
+        }
+
+        const auto image = assembler.assemble(text, source_file);
+        print_statistics();
+        if (!cache_file.empty()) {
+            assembler.save_cache(cache_file);
+        }
+
+        if (origin == BIOS_START && image.size() > BIOS_SIZE) {
+            std::cerr << "Warning: image is " << image.size() << " bytes, larger than the BIOS region ("
+                      << BIOS_SIZE << " bytes)" << std::endl;
+        }
+
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+        if (!out) {
+            std::cerr << "Cannot write " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (print_symbols)
+        {
+            for (const auto & [name, value] : assembler.get_symbols())
+            {
+                std::cout << std::hex << std::uppercase << std::setfill('0') << std::setw(16)
+                          << constant_value_to_operand(value) << "  " << name << std::endl;
+            }
+        }
+
+        return EXIT_SUCCESS;
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Argument parsing error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    } catch (...) {
+        std::cerr << "Unknown error occurred." << std::endl;
+        return EXIT_FAILURE;
+    }
+}
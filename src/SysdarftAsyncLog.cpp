@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <thread>
+#include <SysdarftDebug.h>
+
+std::atomic<bool> debug::async_log_enabled = false;
+
+namespace {
+    // Single producer, single consumer. Positions only grow, a record never wraps: the rest of the buffer is
+    // skipped with an empty record instead
+    struct ring_t
+    {
+        explicit ring_t(const std::size_t capacity) : buffer(capacity), mask(capacity - 1) { }
+
+        std::vector<uint8_t> buffer;
+        const uint64_t mask;
+        alignas(64) std::atomic<uint64_t> tail = 0;     // written by the owning thread
+        alignas(64) std::atomic<uint64_t> head = 0;     // written by the consumer
+        std::atomic<bool> retired = false;              // the owning thread exited
+    };
+
+    struct record_header_t
+    {
+        uint64_t size;                  // header included, a multiple of the header size
+        debug::async::print_t print;    // nullptr skips to the beginning of the buffer
+    };
+
+    struct thread_log_t
+    {
+        std::shared_ptr<ring_t> ring;
+        uint64_t generation = 0;
+        std::vector<uint8_t> scratch;
+
+        ~thread_log_t() {
+            if (ring) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local thread_log_t thread_log;
+
+    struct logger_t
+    {
+        std::mutex mutex;   // rings, and draining them
+        std::vector<std::shared_ptr<ring_t>> rings;
+        std::size_t ring_size = 0;
+        std::atomic<uint64_t> generation = 0;   // rings of earlier runs are not drained anymore
+        std::atomic<uint64_t> dropped = 0;
+        std::atomic<bool> stopping = false;
+        std::thread writer;
+
+        ~logger_t() { debug::stop_async_log(); }
+    } logger;
+
+    // caller holds logger.mutex
+    bool drain()
+    {
+        bool printed = false;
+        for (auto it = logger.rings.begin(); it != logger.rings.end();)
+        {
+            auto & ring = **it;
+            const bool retired = ring.retired.load(std::memory_order_acquire);
+            const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+            uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+            while (head != tail)
+            {
+                const uint8_t * record = ring.buffer.data() + (head & ring.mask);
+                record_header_t header { };
+                std::memcpy(&header, record, sizeof(header));
+                if (header.print != nullptr) {
+                    header.print(record + sizeof(header));
+                    printed = true;
+                }
+                head += header.size;
+            }
+
+            ring.head.store(head, std::memory_order_release);
+            if (retired) {
+                it = logger.rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (printed) {
+            std::cout.flush();
+        }
+
+        return printed;
+    }
+
+    void writer_loop()
+    {
+        debug::set_thread_name("Log Writer");
+        while (!logger.stopping.load(std::memory_order_acquire))
+        {
+            bool printed;
+            {
+                std::lock_guard<std::mutex> lock(logger.mutex);
+                printed = drain();
+            }
+
+            if (!printed) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> & debug::async::scratch()
+{
+    return thread_log.scratch;
+}
+
+void debug::async::commit(const print_t print)
+{
+    auto & local = thread_log;
+    if (!local.ring || local.generation != logger.generation.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(logger.mutex);
+        local.ring = std::make_shared<ring_t>(logger.ring_size);
+        local.generation = logger.generation.load(std::memory_order_relaxed);
+        logger.rings.push_back(local.ring);
+    }
+
+    auto & ring = *local.ring;
+    constexpr uint64_t alignment = sizeof(record_header_t);
+    const uint64_t size = (sizeof(record_header_t) + local.scratch.size() + alignment - 1) & ~(alignment - 1);
+    const uint64_t capacity = ring.buffer.size();
+    const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    const uint64_t to_end = capacity - (tail & ring.mask);
+    const uint64_t needed = to_end < size ? to_end + size : size;
+
+    if (size > capacity / 2 || needed > capacity - (tail - ring.head.load(std::memory_order_acquire)))
+    {
+        logger.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t position = tail;
+    if (to_end < size)
+    {
+        const record_header_t skip { .size = to_end, .print = nullptr };
+        std::memcpy(ring.buffer.data() + (position & ring.mask), &skip, sizeof(skip));
+        position += to_end;
+    }
+
+    uint8_t * record = ring.buffer.data() + (position & ring.mask);
+    const record_header_t header { .size = size, .print = print };
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + sizeof(header), local.scratch.data(), local.scratch.size());
+    ring.tail.store(position + size, std::memory_order_release);
+}
+
+void debug::start_async_log(const std::size_t ring_size)
+{
+    std::lock_guard<std::mutex> lock(logger.mutex);
+    if (async_log_enabled) {
+        return;
+    }
+
+    logger.ring_size = std::bit_ceil(std::max<std::size_t>(ring_size, 4096));
+    logger.generation++;
+    logger.stopping = false;
+    logger.writer = std::thread(writer_loop);
+    async_log_enabled = true;
+}
+
+void debug::stop_async_log()
+{
+    if (!async_log_enabled.exchange(false)) {
+        return;
+    }
+
+    logger.stopping = true;
+    if (logger.writer.joinable()) {
+        logger.writer.join();
+    }
+
+    std::lock_guard<std::mutex> lock(logger.mutex);
+    drain();
+    logger.rings.clear();
+}
+
+void debug::flush_log()
+{
+    std::lock_guard<std::mutex> lock(logger.mutex);
+    drain();
+}
+
+uint64_t debug::dropped_log_records()
+{
+    return logger.dropped.load(std::memory_order_relaxed);
+}
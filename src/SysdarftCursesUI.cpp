@@ -1,110 +1,138 @@
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <cstdio>
 #include <cstring>
-#include <mutex>
-#include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
 #include <SysdarftCursesUI.h>
 #include <GlobalEvents.h>
+#include <ncurses.h>
+
+// ncurses defines scroll(win) as a macro, it would rewrite SysdarftCursesUI::scroll()
+#undef scroll
 
 void SysdarftCursesUI::run(std::atomic<bool>& running)
 {
-    debug::set_thread_name("UI Runner");
-
     // 1) Initialize ncurses
     initscr();            // Start curses mode
     cbreak();             // Disable line buffering, pass key presses directly
     noecho();             // Do not echo typed characters automatically
     keypad(stdscr, true); // Enable arrow keys, F-keys, etc.
 
-    // Non-blocking getch() so we can do other logic if needed
-    // (Alternatively, you could block, but this is common in interactive UIs.)
+    // Non-blocking getch(), the thread waits in poll() for keys and events instead
     nodelay(stdscr, true);
-    // ^ Setting this to 'false' means getch() will block.
-    //   If you want partial concurrency or periodic checks, use 'true'.
 
     // 2) Enable mouse events (for scrolling)
     mousemask(ALL_MOUSE_EVENTS, nullptr);
 
     // 3) Initialize video memory
-    {
-        std::lock_guard<std::mutex> lock(g_data_mutex);
-        init_video_memory();
-    }
+    init_video_memory();
+    apply_events();
 
     // 4) Perform an initial rendering
-    {
-        std::lock_guard<std::mutex> lock(g_data_mutex);
-        render_screen();
-    }
+    render_screen();
     refresh();
 
-    while (running)
+    using clock = std::chrono::steady_clock;
+    auto last_frame = clock::now();
+    bool pending = false;   // input or events wait for the next frame
+    // a closed or redirected stdin is always readable, keys only come from a terminal
+    bool watch_input = isatty(STDIN_FILENO);
+
+    while (running && !stopping)
     {
-        // Wait for a key or mouse event
-        int ch = getch();
+        pending |= handle_input();
+
+        const int fps = frame_rate;
+        const auto next_frame = last_frame + (fps > 0 ? std::chrono::microseconds(1000000 / fps)
+                                                      : std::chrono::microseconds(0));
+        const auto now = clock::now();
+        if (pending && now >= next_frame)
+        {
+            // Everything posted since the last frame, in one batch
+            apply_events();
+            render_screen();
+            refresh();
+            last_frame = now;
+            pending = false;
+        }
+
+        // Sleep until a key arrives, or an event while no frame is due anyway. A frame held back by the
+        // frame rate only waits for its time
+        // negative descriptors are ignored by poll()
+        pollfd fds[] = {
+            { .fd = watch_input ? STDIN_FILENO : -1, .events = POLLIN, .revents = 0 },
+            { .fd = pending ? -1 : events.wakeup_fd(), .events = POLLIN, .revents = 0 },
+        };
+
+        int timeout = -1;
+        if (pending) {
+            const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_frame - clock::now());
+            timeout = static_cast<int>(std::max<int64_t>(wait.count(), 0) + 1);
+        }
+
+        if (poll(fds, 2, timeout) > 0)
+        {
+            if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                watch_input = false;
+            }
 
-        // Check if we actually got something
-        if (ch == ERR) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(3));
-            continue;
+            if (fds[1].revents & POLLIN) {
+                pending = true;
+            }
         }
+    }
 
-        // Handle user input
+    // Clean up
+    endwin();
+}
+
+// -----------------------------------------------------
+// handle_input()
+//  Process every key that is ready. True if the screen has to be redrawn
+// -----------------------------------------------------
+bool SysdarftCursesUI::handle_input()
+{
+    bool redraw = false;
+    for (int ch = getch(); ch != ERR; ch = getch())
+    {
+        // 1) Check for mouse events (wheel up/down)
+        if (ch == KEY_MOUSE)
         {
-            // 1) Check for mouse events (wheel up/down)
-            if (ch == KEY_MOUSE)
+            MEVENT me;
+            if (getmouse(&me) == OK)
             {
-                MEVENT me;
-                if (getmouse(&me) == OK)
+                // Wheel up -> bstate & BUTTON4_PRESSED
+                // Wheel down -> bstate & BUTTON5_PRESSED
+                if (me.bstate & BUTTON4_PRESSED)
                 {
-                    // Wheel up -> bstate & BUTTON4_PRESSED
-                    // Wheel down -> bstate & BUTTON5_PRESSED
-                    if (me.bstate & BUTTON4_PRESSED)
-                    {
-                        if (offset_y > 0)
-                        {
-                            std::lock_guard<std::mutex> lock(g_data_mutex);
-                            --offset_y;
-                            render_screen();
-                            refresh();
-                        }
-                    }
-                    else if (me.bstate & BUTTON5_PRESSED)
+                    if (offset_y > 0)
                     {
-                        std::lock_guard<std::mutex> lock(g_data_mutex);
-                        ++offset_y;
-                        render_screen();
-                        refresh();
+                        --offset_y;
+                        redraw = true;
                     }
                 }
+                else if (me.bstate & BUTTON5_PRESSED)
+                {
+                    ++offset_y;
+                    redraw = true;
+                }
             }
-            // 2) **Press Ctrl+L to re-render** (Ctrl+L is ASCII 12) (or it just resizes itself)
-            else if (ch == 12 || ch == 410)
-            {
-                std::lock_guard<std::mutex> lock(g_data_mutex);
-                // Just re-render the screen
-                render_screen();
-                refresh();
-            } else {
-                g_input_processor(ch);
-            }
-
-            if (video_memory_changed)
-            {
-                std::lock_guard<std::mutex> lock(g_data_mutex);
-                render_screen();
-                refresh();
-                video_memory_changed = false;
-            }
-
-            // 3 ms delay
-            std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        }
+        // 2) **Press Ctrl+L to re-render** (Ctrl+L is ASCII 12), repainting the whole terminal
+        else if (ch == 12) {
+            clearok(curscr, true);
+            on_screen_valid = false;
+            redraw = true;
+        } else if (ch == KEY_RESIZE) {
+            redraw = true;
+        } else {
+            g_input_processor(ch);
         }
     }
 
-    // Clean up
-    endwin();
+    return redraw;
 }
 
 // -----------------------------------------------------
@@ -113,11 +141,7 @@ void SysdarftCursesUI::run(std::atomic<bool>& running)
 // -----------------------------------------------------
 void SysdarftCursesUI::init_video_memory()
 {
-    for (int y = 0; y < V_HEIGHT; y++) {
-        for (int x = 0; x < V_WIDTH; x++) {
-            video_memory[x][y] = '.';
-        }
-    }
+    video_memory.fill('.');
 
     // Place a message in the middle
     const auto msg = "(Video Memory Not Initialized)";
@@ -125,14 +149,42 @@ void SysdarftCursesUI::init_video_memory()
     const int mid_x       = (V_WIDTH  - msg_len) / 2;
     constexpr int mid_y       = (V_HEIGHT - 1) / 2;
 
-    for (int i = 0; i < msg_len; i++) {
-        video_memory[mid_x + i][mid_y] = static_cast<unsigned char>(msg[i]);
+    video_memory.write_text(mid_x, mid_y, msg);
+
+    on_screen_valid = false;
+}
+
+// -----------------------------------------------------
+// apply_events()
+//  Copy the coalesced updates of this frame into video_memory
+// -----------------------------------------------------
+bool SysdarftCursesUI::apply_events()
+{
+    if (!events.drain(frame)) {
+        return false;
     }
+
+    cursor_visible = video_memory.apply(frame, cursor_visible);
+    return true;
+}
+
+// -----------------------------------------------------
+// curses_attributes()
+//  Text attributes of a framebuffer cell as curses video attributes
+// -----------------------------------------------------
+static chtype curses_attributes(const uint8_t attribute)
+{
+    chtype result = A_NORMAL;
+    if (attribute & SysdarftTextFramebuffer::ATTR_BOLD)      result |= A_BOLD;
+    if (attribute & SysdarftTextFramebuffer::ATTR_REVERSE)   result |= A_REVERSE;
+    if (attribute & SysdarftTextFramebuffer::ATTR_UNDERLINE) result |= A_UNDERLINE;
+    if (attribute & SysdarftTextFramebuffer::ATTR_BLINK)     result |= A_BLINK;
+    return result;
 }
 
 // -----------------------------------------------------
 // render_screen()
-//  Clear the terminal and draw the portion of video_memory
+//  Write the cells of video_memory that differ from the terminal
 // -----------------------------------------------------
 void SysdarftCursesUI::render_screen()
 {
@@ -141,31 +193,58 @@ void SysdarftCursesUI::render_screen()
 
     recalc_offsets(rows, cols);
 
-    curs_set(FALSE);
-    clear();
+    // The picture moved. Blanking the virtual screen costs nothing on the wire, refresh() only sends
+    // what really changed on the terminal
+    if (rows != shown_rows || cols != shown_cols || offset_x != shown_offset_x || offset_y != shown_offset_y)
+    {
+        erase();
+        on_screen_valid = false;
+        shown_rows = rows;
+        shown_cols = cols;
+        shown_offset_x = offset_x;
+        shown_offset_y = offset_y;
+    }
 
     // Clip the drawing to what fits on the screen
-    const int max_x = (cols >= V_WIDTH)  ? V_WIDTH  : cols;
-    const int max_y = (rows >= V_HEIGHT) ? V_HEIGHT : rows;
+    const int max_x = std::min(V_WIDTH, cols - offset_x);
+    const int max_y = std::min(V_HEIGHT, rows - offset_y);
 
-    for (int y = 0; y < max_y; y++)
+    std::array < chtype, V_WIDTH > line { };
+    for (int y = 0; y < max_y && max_x > 0; y++)
     {
-        for (int x = 0; x < max_x; x++)
+        // compares the whole row 16 cells at a time, unchanged rows cost next to nothing
+        if (on_screen_valid) {
+            video_memory.changed_spans(on_screen, y, spans);
+        } else {
+            spans.assign(1, { .begin = 0, .length = max_x });
+        }
+
+        const uint8_t * glyphs = video_memory.glyph_row(y);
+        const uint8_t * attributes = video_memory.attribute_row(y);
+        for (const auto & [begin, span_length] : spans)
         {
-            const int sx = offset_x + x;
-            const int sy = offset_y + y;
+            const int length = std::min(span_length, max_x - begin);
+            if (length <= 0) {
+                continue;
+            }
 
-            if (sx >= 0 && sx < cols && sy >= 0 && sy < rows) {
-                mvaddch(sy, sx, video_memory[x][y]);
+            for (int x = begin; x < begin + length; x++) {
+                line[x] = glyphs[x] | curses_attributes(attributes[x]);
             }
+
+            mvaddchnstr(offset_y + y, offset_x + begin, line.data() + begin, length);
         }
+
+        on_screen.copy_row(video_memory, y);
     }
 
+    on_screen_valid = true;
+
     const auto [x, y] = current_cursor_position.load();
     const int screen_x = offset_x + x;
     const int screen_y = offset_y + y;
     move(screen_y, screen_x);
-    curs_set(TRUE);
+    curs_set(cursor_visible);
 }
 
 // -----------------------------------------------------
@@ -202,21 +281,25 @@ void SysdarftCursesUI::recalc_offsets(int rows, int cols)
 
 void SysdarftCursesUI::initialize()
 {
+    stopping = false;
     renderer.start();
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 }
 
 void SysdarftCursesUI::cleanup()
 {
-    log("[Curses] Stopping renderer...\n");
+    log_info(UI, "[Curses] Stopping renderer...\n");
+    stopping = true;
+    events.wake();
     renderer.stop();
-    log("[Curses] Shutdown procedure finished!\n");
+    log_info(UI, "[Curses] Shutdown procedure finished!\n");
 }
 
 void SysdarftCursesUI::set_cursor(const int x, const int y)
 {
     const decltype(current_cursor_position.load()) pos = {.x = x, .y = y};
     current_cursor_position = pos;
+    events.set_cursor(x, y);
 }
 
 CursorPosition SysdarftCursesUI::get_cursor()
@@ -226,13 +309,25 @@ CursorPosition SysdarftCursesUI::get_cursor()
 
 void SysdarftCursesUI::display_char(int x, int y, int ch)
 {
-    std::lock_guard<std::mutex> lock(g_data_mutex);
-    video_memory[x][y] = ch;
-    video_memory_changed = true;
+    events.display_char(x, y, ch);
+}
+
+void SysdarftCursesUI::display_region(int x, int y, int w, int h, const uint8_t * cells, int stride)
+{
+    events.display_region(x, y, w, h, cells, stride);
+}
+
+void SysdarftCursesUI::scroll(int lines)
+{
+    events.scroll(lines);
 }
 
 void SysdarftCursesUI::set_cursor_visibility(bool visible)
 {
-    std::lock_guard<std::mutex> lock(g_data_mutex);
-    curs_set(visible);
+    events.set_cursor_visibility(visible);
+}
+
+void SysdarftCursesUI::set_frame_rate(const int fps)
+{
+    frame_rate = std::max(fps, 0);
 }
@@ -7,18 +7,25 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
 #include <dirent.h>
+#include <elf.h>
 #include <execinfo.h>
+#include <fcntl.h>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <regex>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -42,6 +49,66 @@ struct ThreadInfo {
 std::mutex debug::log_mutex;
 std::atomic<bool> debug::verbose = false;
 
+static_assert(static_cast<std::size_t>(debug::log_subsystem_t::COUNT) == 6);
+std::array < std::atomic < debug::log_level_t >, static_cast<std::size_t>(debug::log_subsystem_t::COUNT) >
+    debug::log_levels = {
+        log_level_t::INFO, log_level_t::INFO, log_level_t::INFO,
+        log_level_t::INFO, log_level_t::INFO, log_level_t::INFO,
+    };
+
+bool debug::set_log_levels(const std::string & spec)
+{
+    static const std::map < std::string, log_level_t, std::less<> > level_names = {
+        { "trace", log_level_t::TRACE }, { "debug", log_level_t::DEBUG }, { "info", log_level_t::INFO },
+        { "warning", log_level_t::WARNING }, { "error", log_level_t::ERROR }, { "none", log_level_t::NONE },
+    };
+
+    static const std::map < std::string, log_subsystem_t, std::less<> > subsystem_names = {
+        { "general", log_subsystem_t::GENERAL }, { "cpu", log_subsystem_t::CPU },
+        { "memory", log_subsystem_t::MEMORY }, { "ui", log_subsystem_t::UI },
+        { "backend", log_subsystem_t::BACKEND }, { "module", log_subsystem_t::MODULE },
+    };
+
+    std::vector < std::pair < std::optional < log_subsystem_t >, log_level_t > > changes;
+    std::stringstream items(spec);
+    for (std::string item; std::getline(items, item, ',');)
+    {
+        const auto equals = item.find('=');
+        const auto level = level_names.find(equals == std::string::npos ? item : item.substr(equals + 1));
+        if (level == level_names.end()) {
+            return false;
+        }
+
+        if (equals == std::string::npos) {
+            changes.emplace_back(std::nullopt, level->second);
+            continue;
+        }
+
+        const auto subsystem = subsystem_names.find(item.substr(0, equals));
+        if (subsystem == subsystem_names.end()) {
+            return false;
+        }
+        changes.emplace_back(subsystem->second, level->second);
+    }
+
+    if (changes.empty()) {
+        return false;
+    }
+
+    for (const auto & [subsystem, level] : changes)
+    {
+        if (subsystem) {
+            set_log_level(*subsystem, level);
+        } else {
+            for (auto & current : log_levels) {
+                current = level;
+            }
+        }
+    }
+
+    return true;
+}
+
 std::string debug::separate_before_slash(const std::string& input)
 {
     size_t pos = input.find('/');
@@ -70,10 +137,9 @@ debug::backtrace_info debug::obtain_stack_frame()
     return result;
 }
 
-std::string debug::get_current_date_time()
+std::string format_date_time(const std::chrono::system_clock::time_point now)
 {
     using namespace std::chrono;
-    const auto now = system_clock::now();
     const auto now_time_t = system_clock::to_time_t(now);
     const std::tm local_time = *std::localtime(&now_time_t);
 
@@ -89,6 +155,11 @@ std::string debug::get_current_date_time()
     return ret.str();
 }
 
+std::string debug::get_current_date_time()
+{
+    return format_date_time(std::chrono::system_clock::now());
+}
+
 debug::cmd_status debug::_exec_command(
     const std::string& cmd, const std::vector<std::string>& args)
 {
@@ -199,15 +270,193 @@ size_t max_line_length(const std::string& input)
     return max_length;
 }
 
-std::string initialize_error_msg(const std::string& msg, const int _errno)
+struct debug::error_report_t
 {
-    std::string result;
-    if (debug::verbose)
+    std::string message;
+    int error_number {};
+    std::chrono::system_clock::time_point thrown_at;
+    std::vector < void * > frames;
+
+    std::once_flag built;
+    std::string text;
+};
+
+namespace {
+    struct elf_function_t
     {
-        std::ostringstream err_msg;
+        uintptr_t start;
+        uintptr_t size;
+        std::string name;
+    };
+
+    // Functions of an object file, sorted by address. Shared objects and PIE executables are relocatable,
+    // their addresses are relative to the load base
+    struct elf_object_t
+    {
+        bool relocatable = false;
+        std::vector < elf_function_t > functions;
+    };
+
+    // reads the symbol table, the dynamic one if the file is stripped. dladdr() only sees exported symbols,
+    // which leaves most of our own frames unnamed
+    elf_object_t read_elf_functions(const char * path)
+    {
+        elf_object_t object;
+        const int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return object;
+        }
+
+        struct stat status { };
+        void * image = MAP_FAILED;
+        if (fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) > sizeof(Elf64_Ehdr)) {
+            image = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+
+        if (image == MAP_FAILED) {
+            return object;
+        }
+
+        const auto * base = static_cast<const uint8_t *>(image);
+        const auto size = static_cast<std::size_t>(status.st_size);
+        const auto * header = reinterpret_cast<const Elf64_Ehdr *>(base);
+        if (std::memcmp(header->e_ident, ELFMAG, SELFMAG) == 0 && header->e_ident[EI_CLASS] == ELFCLASS64
+            && header->e_shoff + header->e_shnum * sizeof(Elf64_Shdr) <= size)
+        {
+            object.relocatable = header->e_type == ET_DYN;
+            const auto * sections = reinterpret_cast<const Elf64_Shdr *>(base + header->e_shoff);
+            auto collect = [&](const Elf64_Word type)
+            {
+                for (unsigned i = 0; i < header->e_shnum; i++)
+                {
+                    const auto & table = sections[i];
+                    if (table.sh_type != type || table.sh_link >= header->e_shnum
+                        || table.sh_entsize != sizeof(Elf64_Sym) || table.sh_offset + table.sh_size > size)
+                    {
+                        continue;
+                    }
 
-        const std::string current_time = debug::get_current_date_time();
-        err_msg << "Exception Thrown at " << current_time << "\n";
+                    const auto & strings = sections[table.sh_link];
+                    if (strings.sh_offset + strings.sh_size > size || strings.sh_size == 0) {
+                        continue;
+                    }
+
+                    const auto * symbols = reinterpret_cast<const Elf64_Sym *>(base + table.sh_offset);
+                    const auto * names = reinterpret_cast<const char *>(base + strings.sh_offset);
+                    for (std::size_t j = 0; j < table.sh_size / sizeof(Elf64_Sym); j++)
+                    {
+                        const auto & symbol = symbols[j];
+                        if (ELF64_ST_TYPE(symbol.st_info) == STT_FUNC && symbol.st_value != 0
+                            && symbol.st_name < strings.sh_size)
+                        {
+                            object.functions.push_back({
+                                .start = symbol.st_value,
+                                .size = symbol.st_size,
+                                .name = std::string(names + symbol.st_name,
+                                    strnlen(names + symbol.st_name, strings.sh_size - symbol.st_name)),
+                            });
+                        }
+                    }
+                }
+            };
+
+            collect(SHT_SYMTAB);
+            if (object.functions.empty()) {
+                collect(SHT_DYNSYM);
+            }
+        }
+
+        munmap(image, size);
+        std::ranges::sort(object.functions, { }, &elf_function_t::start);
+        return object;
+    }
+
+    std::string demangle(const std::string & name)
+    {
+        int status = 0;
+        char * demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+        if (status != 0 || demangled == nullptr) {
+            return name;
+        }
+
+        std::string result(demangled);
+        free(demangled);
+        return result;
+    }
+
+    struct frame_symbol_t
+    {
+        std::string function;   // empty if unknown
+        std::string location;   // object file and offset, for addr2line
+    };
+
+    // Resolves return addresses in process. Object files are read once, every address only once
+    class symbolizer_t
+    {
+        std::mutex mutex;
+        std::map < std::string, elf_object_t > objects;
+        std::unordered_map < const void *, frame_symbol_t > frames;
+
+    public:
+        frame_symbol_t resolve(const void * address)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (const auto it = frames.find(address); it != frames.end()) {
+                return it->second;
+            }
+
+            // a return address can be the first byte after the calling function
+            const auto caller = reinterpret_cast<uintptr_t>(address) - 1;
+            frame_symbol_t symbol;
+            Dl_info info { };
+            if (dladdr(reinterpret_cast<const void *>(caller), &info) != 0 && info.dli_fname != nullptr)
+            {
+                auto object = objects.find(info.dli_fname);
+                if (object == objects.end()) {
+                    object = objects.emplace(info.dli_fname, read_elf_functions(info.dli_fname)).first;
+                }
+
+                const auto & functions = object->second.functions;
+                const auto base = object->second.relocatable ? reinterpret_cast<uintptr_t>(info.dli_fbase) : 0;
+                const auto relative = caller - base;
+                auto function = std::ranges::upper_bound(functions, relative, { }, &elf_function_t::start);
+                if (function != functions.begin() && relative < std::prev(function)->start
+                    + std::max<uintptr_t>(std::prev(function)->size, 1))
+                {
+                    --function;
+                    std::stringstream name;
+                    name << demangle(function->name) << "+0x" << std::hex << relative + 1 - function->start;
+                    symbol.function = name.str();
+                } else if (info.dli_sname != nullptr) {
+                    std::stringstream name;
+                    name << demangle(info.dli_sname) << "+0x" << std::hex
+                         << caller + 1 - reinterpret_cast<uintptr_t>(info.dli_saddr);
+                    symbol.function = name.str();
+                }
+
+                std::stringstream location;
+                location << info.dli_fname << " +0x" << std::hex
+                         << caller + 1 - reinterpret_cast<uintptr_t>(info.dli_fbase);
+                symbol.location = location.str();
+            }
+
+            frames.emplace(address, symbol);
+            return symbol;
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            objects.clear();
+            frames.clear();
+        }
+    } symbolizer;
+
+    std::string build_error_report(const debug::error_report_t & report)
+    {
+        std::ostringstream err_msg;
+        err_msg << "Exception Thrown at " << format_date_time(report.thrown_at) << "\n";
 
         auto replace_all = [](std::string& input, const std::string& target,
                                const std::string& replacement) {
@@ -220,98 +469,93 @@ std::string initialize_error_msg(const std::string& msg, const int _errno)
             }
         };
 
-        std::string processed_msg = msg;
+        std::string processed_msg = report.message;
         if (!processed_msg.empty() && processed_msg.back() == '\n') {
             processed_msg.pop_back();
         }
         replace_all(processed_msg, "\n", "\n>>> ");
 
         err_msg << "Error description:\n>>> " << processed_msg << "\n";
-        err_msg << "System Error: errno=" << _errno << ": " << strerror(_errno)
+        err_msg << "System Error: errno=" << report.error_number << ": " << strerror(report.error_number)
                 << "\n";
-        const std::regex pattern(R"(([^\(]+)\(([^\)]*)\) \[([^\]]+)\])");
-        std::smatch matches;
 
         err_msg << "\nBacktrace starts here:\n";
-        auto frame_backtrace = debug::obtain_stack_frame();
-
-        for (size_t i = 0; i < frame_backtrace.size(); ++i)
+        for (size_t i = 0; i < report.frames.size(); ++i)
         {
             std::stringstream prefix;
-            prefix << "Frame #" << i << " " << frame_backtrace[i].second << ": ";
+            prefix << "Frame #" << i << " " << report.frames[i] << ": ";
             err_msg << prefix.str();
 
-            if (std::regex_search(frame_backtrace[i].first, matches, pattern)
-                && matches.size() > 3)
-            {
-                const std::string& executable_path = matches[1].str();
-                const std::string& traced_address = matches[2].str();
-                const std::string& traced_runtime_address
-                    = matches[3].str();
-
-                auto generate_addr2line_trace_info
-                    = [&](const std::string& address)
-                    {
-                        auto [fd_stdout, fd_stderr, exit_status]
-                            = debug::exec_command("addr2line",
-                                "--demangle", "-f", "-p", "-a", "-e",
-                                executable_path, address);
-                        if (exit_status != 0) {
-                            err_msg << "\tObtaining backtrace information failed for "
-                                    << executable_path << " with offset "
-                                    << address << ": " << fd_stderr
-                                    << "\n";
-                        } else {
-                            std::string caller, path;
-                            size_t pos = fd_stdout.find('/');
-                            if (pos != std::string::npos) {
-                                caller = fd_stdout.substr(0, pos - 4);
-                                path = fd_stdout.substr(pos);
-                            }
-
-                            size_t pos2 = caller.find('(');
-                            if (pos2 != std::string::npos) {
-                                caller = caller.substr(0, pos2);
-                            }
-
-                            if (!caller.empty() && !path.empty())
-                            {
-                                const std::string prefix_spaces(prefix.str().length() - 9, ' ');
-                                err_msg << caller << "\n" << prefix_spaces << "at " << path;
-                            } else {
-                                err_msg << fd_stdout;
-                            }
-                        }
-                    };
-
-                if (traced_address.empty()) {
-                    generate_addr2line_trace_info(traced_runtime_address);
-                } else {
-                    generate_addr2line_trace_info(traced_address);
-                }
+            const auto [function, location] = symbolizer.resolve(report.frames[i]);
+            if (!function.empty()) {
+                const std::string prefix_spaces(prefix.str().length() - 3, ' ');
+                err_msg << function << "\n" << prefix_spaces << "at " << location;
+            } else if (!location.empty()) {
+                err_msg << location;
             } else {
-                err_msg << "No trace information\n";
+                err_msg << "No trace information";
             }
             err_msg << "\n";
         }
         err_msg << "Backtrace ends here.\n";
 
+        // taken when the report is first requested, not when the error was thrown
         err_msg << "\nThread Information:\n" << debug::get_verbose_info() << "\n";
 
         return err_msg.str();
     }
 
-    return ">>> " + msg + " (errno=" + std::to_string(_errno) + ") <<<";
+    const std::string & report_text(debug::error_report_t & report)
+    {
+        std::call_once(report.built, [&report] { report.text = build_error_report(report); });
+        return report.text;
+    }
+}
+
+void debug::forget_symbols()
+{
+    symbolizer.clear();
 }
 
 std::string last_sysdarft_error_;
+std::atomic < std::shared_ptr < debug::error_report_t > > last_error_report;
 
 SysdarftBaseError::SysdarftBaseError(
     const std::string& msg)
-    : runtime_error(initialize_error_msg(msg, errno))
+    : runtime_error(">>> " + msg + " (errno=" + std::to_string(errno) + ") <<<")
     , cur_errno(errno)
+    , bare_message(msg)
 {
+    if (debug::verbose)
+    {
+        // backtrace() only walks the stack, everything else is left to what()
+        report = std::make_shared<debug::error_report_t>();
+        report->message = msg;
+        report->error_number = cur_errno;
+        report->thrown_at = std::chrono::system_clock::now();
+
+        void* buffer[MAX_STACK_FRAMES] = {};
+        const int frames = backtrace(buffer, MAX_STACK_FRAMES);
+        if (frames > 1) {
+            report->frames.assign(buffer + 1, buffer + frames);
+        }
+    }
+
     last_sysdarft_error_ = this->runtime_error::what();
+    last_error_report.store(report);
+}
+
+const char * SysdarftBaseError::what() const noexcept
+{
+    if (!report) {
+        return runtime_error::what();
+    }
+
+    try {
+        return report_text(*report).c_str();
+    } catch (...) {
+        return runtime_error::what();
+    }
 }
 
 bool isDigits(const std::string& str)
@@ -543,9 +787,10 @@ void handle_sigabrt(int /* signum */)
         = "[FATAL ERROR] Program is terminated using SIGABRT (Signal Abort)!\n";
 #ifdef __DEBUG__
     debug::verbose = true;
+    const auto last_report = last_error_report.load();
     const SysdarftBaseError Error(
-        "Abnormal termination!\nLast captured error:\n" + last_sysdarft_error_
-        + "\n");
+        "Abnormal termination!\nLast captured error:\n"
+        + (last_report ? report_text(*last_report) : last_sysdarft_error_) + "\n");
     const std::string str = Error.what();
     write(STDERR_FILENO, prefix, strlen(prefix));
     write(STDERR_FILENO, str.c_str(), str.length() - 1);
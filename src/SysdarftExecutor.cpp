@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <sched.h>
+#include <SysdarftExecutor.h>
+
+namespace {
+    void name_current_thread(const std::string & name) {
+        // the kernel takes at most 15 characters and rejects longer names
+        debug::set_thread_name(name.substr(0, 15));
+    }
+}
+
+std::vector < unsigned > executor::usable_cores()
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return { };
+    }
+
+    std::vector < unsigned > cores;
+    for (unsigned core = 0; core < CPU_SETSIZE; core++) {
+        if (CPU_ISSET(core, &set)) {
+            cores.push_back(core);
+        }
+    }
+
+    return cores;
+}
+
+std::optional < unsigned > executor::core_for(const thread_role_t role)
+{
+    // the last cores, core 0 usually handles most device interrupts. At least one is left for
+    // everything else
+    static const auto cores = usable_cores();
+    if (cores.size() < 4) {
+        return std::nullopt;
+    }
+
+    return cores[cores.size() - 1 - static_cast<unsigned>(role)];
+}
+
+bool executor::pin_current_thread(const std::vector < unsigned > & cores)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto core : cores) {
+        if (core < CPU_SETSIZE) {
+            CPU_SET(core, &set);
+        }
+    }
+
+    return CPU_COUNT(&set) != 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+SysdarftThread::SysdarftThread(std::string _name, body_t _body, const std::optional < unsigned > _core)
+    : name(std::move(_name)), body(std::move(_body)), core(_core)
+{
+}
+
+SysdarftThread::~SysdarftThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+        run_requested = false;
+        running = false;
+        cv.notify_all();
+    }
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void SysdarftThread::start()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (run_requested || body_active) {
+        return;
+    }
+
+    if (!thread.joinable()) {
+        thread = std::thread(&SysdarftThread::main_loop, this);
+    }
+
+    running = true;
+    run_requested = true;
+    cv.notify_all();
+}
+
+void SysdarftThread::stop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    running = false;
+    run_requested = false;
+
+    if (std::this_thread::get_id() != thread.get_id()) {
+        cv.wait(lock, [this] { return !body_active; });
+    }
+}
+
+void SysdarftThread::main_loop()
+{
+    name_current_thread(name);
+    if (core && !executor::pin_current_thread(*core)) {
+        log_warning(GENERAL, "[Executor] Cannot pin ", name, " to core ", *core, ", it runs unpinned\n");
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv.wait(lock, [this] { return run_requested || exiting; });
+        if (!run_requested) {
+            return;
+        }
+
+        run_requested = false;
+        body_active = true;
+        lock.unlock();
+
+        try {
+            body(running);
+        } catch (const std::exception & error) {
+            log_error(GENERAL, "[Executor] ", name, " stopped by an exception: ", error.what(), "\n");
+        }
+
+        lock.lock();
+        body_active = false;
+        running = false;
+        cv.notify_all();
+    }
+}
+
+SysdarftThreadPool::SysdarftThreadPool(const unsigned threads, const std::string & name)
+{
+    for (unsigned i = 0; i < std::max(1u, threads); i++)
+    {
+        workers.emplace_back([this, thread_name = name + " " + std::to_string(i)]
+        {
+            name_current_thread(thread_name);
+
+            // keep background work off the CPU core
+            if (const auto cpu = executor::core_for(thread_role_t::CPU))
+            {
+                auto cores = executor::usable_cores();
+                std::erase(cores, *cpu);
+                executor::pin_current_thread(cores);
+            }
+
+            worker();
+        });
+    }
+}
+
+SysdarftThreadPool::~SysdarftThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+        cv.notify_all();
+    }
+
+    for (auto & thread : workers) {
+        thread.join();
+    }
+}
+
+SysdarftThreadPool & SysdarftThreadPool::shared()
+{
+    static SysdarftThreadPool pool([]
+    {
+        const auto cores = static_cast<unsigned>(executor::usable_cores().size());
+        return executor::core_for(thread_role_t::CPU) ? cores - 1 : cores;
+    }());
+
+    return pool;
+}
+
+void SysdarftThreadPool::execute(std::function < void() > job)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.emplace_back(std::move(job));
+    cv.notify_one();
+}
+
+void SysdarftThreadPool::worker()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv.wait(lock, [this] { return !jobs.empty() || exiting; });
+        if (jobs.empty()) {
+            return;
+        }
+
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        try {
+            job();
+        } catch (const std::exception & error) {
+            log_error(GENERAL, "[Executor] Pool job failed: ", error.what(), "\n");
+        }
+
+        lock.lock();
+    }
+}
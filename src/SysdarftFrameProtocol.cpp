@@ -0,0 +1,190 @@
+#include <vector>
+#include <SysdarftFrameProtocol.h>
+
+namespace {
+    // a run header costs three bytes, two unchanged cells in between cost four
+    constexpr int run_merge_gap = 2;
+
+    void put_u8(std::string & out, const uint8_t value) {
+        out.push_back(static_cast<char>(value));
+    }
+
+    void put_u16(std::string & out, const uint16_t value)
+    {
+        put_u8(out, static_cast<uint8_t>(value));
+        put_u8(out, static_cast<uint8_t>(value >> 8));
+    }
+
+    void put_header(std::string & out, const uint8_t type, const frame_protocol::cursor_state_t & cursor)
+    {
+        put_u8(out, type);
+        put_u8(out, cursor.visible ? frame_protocol::CURSOR_VISIBLE : 0);
+        put_u16(out, static_cast<uint16_t>(cursor.position.x));
+        put_u16(out, static_cast<uint16_t>(cursor.position.y));
+    }
+
+    class reader_t
+    {
+        std::string_view data;
+
+    public:
+        explicit reader_t(const std::string_view _data) : data(_data) { }
+
+        bool u8(uint8_t & value)
+        {
+            if (data.empty()) {
+                return false;
+            }
+
+            value = static_cast<uint8_t>(data.front());
+            data.remove_prefix(1);
+            return true;
+        }
+
+        bool u16(uint16_t & value)
+        {
+            uint8_t low, high;
+            if (!u8(low) || !u8(high)) {
+                return false;
+            }
+
+            value = static_cast<uint16_t>(low | high << 8);
+            return true;
+        }
+
+        bool bytes(const std::size_t count, std::string_view & value)
+        {
+            if (data.size() < count) {
+                return false;
+            }
+
+            value = data.substr(0, count);
+            data.remove_prefix(count);
+            return true;
+        }
+
+        [[nodiscard]] bool done() const {
+            return data.empty();
+        }
+    };
+}
+
+std::string frame_protocol::encode_keyframe(const SysdarftTextFramebuffer & frame, const cursor_state_t & cursor)
+{
+    constexpr int width = SysdarftTextFramebuffer::width;
+    constexpr int height = SysdarftTextFramebuffer::height;
+
+    std::string out;
+    out.reserve(8 + 2 * width * height);
+    put_header(out, KEYFRAME, cursor);
+    put_u8(out, width);
+    put_u8(out, height);
+
+    for (int y = 0; y < height; y++) {
+        out.append(reinterpret_cast<const char *>(frame.glyph_row(y)), width);
+    }
+
+    for (int y = 0; y < height; y++) {
+        out.append(reinterpret_cast<const char *>(frame.attribute_row(y)), width);
+    }
+
+    return out;
+}
+
+std::string frame_protocol::encode_delta(const SysdarftTextFramebuffer & frame,
+    const SysdarftTextFramebuffer & previous, const cursor_state_t & cursor,
+    const cursor_state_t & previous_cursor)
+{
+    std::string runs;
+    uint16_t run_count = 0;
+    std::vector < ui_span_t > spans;
+    for (int y = 0; y < SysdarftTextFramebuffer::height; y++)
+    {
+        frame.changed_spans(previous, y, spans, run_merge_gap);
+        for (const auto & [begin, length] : spans)
+        {
+            put_u8(runs, static_cast<uint8_t>(y));
+            put_u8(runs, static_cast<uint8_t>(begin));
+            put_u8(runs, static_cast<uint8_t>(length));
+            runs.append(reinterpret_cast<const char *>(frame.glyph_row(y)) + begin, length);
+            runs.append(reinterpret_cast<const char *>(frame.attribute_row(y)) + begin, length);
+            run_count++;
+        }
+    }
+
+    if (run_count == 0 && cursor == previous_cursor) {
+        return { };
+    }
+
+    std::string out;
+    out.reserve(8 + runs.size());
+    put_header(out, DELTA, cursor);
+    put_u16(out, run_count);
+    out += runs;
+    return out;
+}
+
+bool frame_protocol::apply(const std::string_view message, SysdarftTextFramebuffer & frame, cursor_state_t & cursor)
+{
+    reader_t in(message);
+    uint8_t type, flags;
+    uint16_t x, y;
+    if (!in.u8(type) || !in.u8(flags) || !in.u16(x) || !in.u16(y)) {
+        return false;
+    }
+
+    auto set_cells = [&frame](const int row, const int column, const std::string_view glyphs,
+        const std::string_view attributes)
+    {
+        for (std::size_t i = 0; i < glyphs.size(); i++) {
+            frame.set_cell(column + static_cast<int>(i), row,
+                static_cast<uint8_t>(glyphs[i]) | static_cast<uint8_t>(attributes[i]) << 8);
+        }
+    };
+
+    if (type == KEYFRAME)
+    {
+        uint8_t columns, rows;
+        std::string_view glyphs, attributes;
+        if (!in.u8(columns) || !in.u8(rows) || columns != SysdarftTextFramebuffer::width
+            || rows != SysdarftTextFramebuffer::height || !in.bytes(columns * rows, glyphs)
+            || !in.bytes(columns * rows, attributes) || !in.done())
+        {
+            return false;
+        }
+
+        for (int row = 0; row < rows; row++) {
+            set_cells(row, 0, glyphs.substr(row * columns, columns), attributes.substr(row * columns, columns));
+        }
+    }
+    else if (type == DELTA)
+    {
+        uint16_t runs;
+        if (!in.u16(runs)) {
+            return false;
+        }
+
+        for (uint16_t run = 0; run < runs; run++)
+        {
+            uint8_t row, column, length;
+            std::string_view glyphs, attributes;
+            if (!in.u8(row) || !in.u8(column) || !in.u8(length) || row >= SysdarftTextFramebuffer::height
+                || column + length > SysdarftTextFramebuffer::width || !in.bytes(length, glyphs)
+                || !in.bytes(length, attributes))
+            {
+                return false;
+            }
+
+            set_cells(row, column, glyphs, attributes);
+        }
+
+        if (!in.done()) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    cursor = { .position = { .x = x, .y = y }, .visible = (flags & CURSOR_VISIBLE) != 0 };
+    return true;
+}
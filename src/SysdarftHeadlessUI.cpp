@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <poll.h>
+#include <SysdarftHeadlessUI.h>
+
+void SysdarftHeadlessUI::install()
+{
+    GlobalEventProcessor.install_instance(UI_INSTANCE_NAME, this, UI_CLEANUP_METHOD_NAME,
+        &SysdarftHeadlessUI::cleanup);
+    GlobalEventProcessor.install_instance(UI_INSTANCE_NAME, this, UI_INITIALIZE_METHOD_NAME,
+        &SysdarftHeadlessUI::initialize);
+    GlobalEventProcessor.install_instance(UI_INSTANCE_NAME, this, UI_SET_CURSOR_METHOD_NAME,
+        &SysdarftHeadlessUI::set_cursor);
+    GlobalEventProcessor.install_instance(UI_INSTANCE_NAME, this, UI_GET_CURSOR_METHOD_NAME,
+        &SysdarftHeadlessUI::get_cursor);
+    GlobalEventProcessor.install_instance(UI_INSTANCE_NAME, this, UI_DISPLAY_CHAR_METHOD_NAME,
+        &SysdarftHeadlessUI::display_char);
+    GlobalEventProcessor.install_instance(UI_INSTANCE_NAME, this, UI_DISPLAY_REGION_METHOD_NAME,
+        &SysdarftHeadlessUI::display_region);
+    GlobalEventProcessor.install_instance(UI_INSTANCE_NAME, this, UI_SCROLL_METHOD_NAME,
+        &SysdarftHeadlessUI::scroll);
+    GlobalEventProcessor.install_instance(UI_INSTANCE_NAME, this, UI_SET_CURSOR_VISIBILITY_METHOD_NAME,
+        &SysdarftHeadlessUI::set_cursor_visibility);
+}
+
+void SysdarftHeadlessUI::set_dump(const std::string & path, const dump_mode_t mode,
+    const std::chrono::milliseconds interval)
+{
+    dump_path = path;
+    dump_mode = mode;
+    dump_interval = std::max(interval, std::chrono::milliseconds(1));
+}
+
+void SysdarftHeadlessUI::run(std::atomic<bool>& running)
+{
+    using clock = std::chrono::steady_clock;
+    auto last_dump = clock::now() - dump_interval;
+
+    while (running && !stopping)
+    {
+        uint64_t requested;
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex);
+            requested = flush_requested;
+        }
+
+        if (apply_events())
+        {
+            changed_since_dump = true;
+            if (dump_mode == dump_mode_t::ON_CHANGE) {
+                dump_frame();
+            }
+        }
+
+        const auto now = clock::now();
+        if (dump_mode == dump_mode_t::INTERVAL && changed_since_dump && now - last_dump >= dump_interval)
+        {
+            dump_frame();
+            last_dump = now;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex);
+            flush_completed = requested;
+            flushed.notify_all();
+        }
+
+        // Sleep until something is posted, or a frame held back by the interval is due
+        int timeout = -1;
+        if (dump_mode == dump_mode_t::INTERVAL && changed_since_dump) {
+            const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                last_dump + dump_interval - clock::now());
+            timeout = static_cast<int>(std::max<int64_t>(wait.count(), 0) + 1);
+        }
+
+        pollfd wakeup { .fd = events.wakeup_fd(), .events = POLLIN, .revents = 0 };
+        poll(&wakeup, 1, timeout);
+    }
+
+    // nobody is left to wait for
+    std::lock_guard<std::mutex> lock(flush_mutex);
+    flush_completed = flush_requested;
+    flushed.notify_all();
+}
+
+bool SysdarftHeadlessUI::apply_events()
+{
+    if (!events.drain(frame)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(screen_mutex);
+    cursor_visible = video_memory.apply(frame, cursor_visible);
+    frame_count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SysdarftHeadlessUI::dump_frame()
+{
+    changed_since_dump = false;
+    if (!dump_file.is_open()) {
+        return;
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started);
+    const auto [cursor_x, cursor_y] = current_cursor_position.load();
+    dump_file << "Frame " << get_frame_count() << " at " << elapsed.count() << " ms, cursor "
+              << cursor_x << "," << cursor_y << (cursor_visible ? "" : " (hidden)") << "\n";
+
+    std::string row(V_WIDTH, ' ');
+    for (int y = 0; y < V_HEIGHT; y++)
+    {
+        const uint8_t * glyphs = video_memory.glyph_row(y);
+        for (int x = 0; x < V_WIDTH; x++) {
+            // character not displayable
+            row[x] = glyphs[x] < 0x20 || glyphs[x] > 0x7e ? '.' : static_cast<char>(glyphs[x]);
+        }
+        dump_file << row << "\n";
+    }
+
+    dump_file << "\n";
+    dump_file.flush();
+}
+
+void SysdarftHeadlessUI::flush()
+{
+    if (!worker.is_running())
+    {
+        apply_events();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(flush_mutex);
+    const uint64_t target = ++flush_requested;
+    events.wake();
+    flushed.wait(lock, [&] { return flush_completed >= target; });
+}
+
+SysdarftTextFramebuffer SysdarftHeadlessUI::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(screen_mutex);
+    return video_memory;
+}
+
+void SysdarftHeadlessUI::initialize()
+{
+    {
+        std::lock_guard<std::mutex> lock(screen_mutex);
+        video_memory.fill(' ');
+    }
+
+    if (dump_mode != dump_mode_t::NEVER) {
+        dump_file.open(dump_path, std::ios::out | std::ios::trunc);
+        if (!dump_file) {
+            log_error(UI, "[Headless] Cannot open ", dump_path, ", frames are not dumped\n");
+        }
+    }
+
+    started = std::chrono::steady_clock::now();
+    changed_since_dump = false;
+    stopping = false;
+    worker.start();
+}
+
+void SysdarftHeadlessUI::cleanup()
+{
+    log_info(UI, "[Headless] Stopping...\n");
+    stopping = true;
+    events.wake();
+    worker.stop();
+
+    // everything posted before, and a frame the interval held back
+    if (apply_events()) {
+        changed_since_dump = true;
+    }
+
+    if (dump_mode != dump_mode_t::NEVER && changed_since_dump) {
+        dump_frame();
+    }
+
+    dump_file.close();
+    log_info(UI, "[Headless] Shutdown procedure finished!\n");
+}
+
+void SysdarftHeadlessUI::set_cursor(const int x, const int y)
+{
+    const decltype(current_cursor_position.load()) pos = {.x = x, .y = y};
+    current_cursor_position = pos;
+    events.set_cursor(x, y);
+}
+
+CursorPosition SysdarftHeadlessUI::get_cursor()
+{
+    return current_cursor_position;
+}
+
+void SysdarftHeadlessUI::display_char(int x, int y, int ch)
+{
+    events.display_char(x, y, ch);
+}
+
+void SysdarftHeadlessUI::display_region(int x, int y, int w, int h, const uint8_t * cells, int stride)
+{
+    events.display_region(x, y, w, h, cells, stride);
+}
+
+void SysdarftHeadlessUI::scroll(int lines)
+{
+    events.scroll(lines);
+}
+
+void SysdarftHeadlessUI::set_cursor_visibility(bool visible)
+{
+    events.set_cursor_visibility(visible);
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <getopt.h>
+#include <SysdarftDebug.h>
+#include <SysdarftAssembler.h>
+
+void print_help(const char *program_name)
+{
+    std::cout
+        << "Usage: " << program_name << " [OPTIONS] OBJECT...\n"
+        << "Options:\n"
+        << "    -h, --help        Show this help message\n"
+        << "    -v, --version     Show version information\n"
+        << "    -o, --output      Output image file (default: a.bin)\n"
+        << "    -O, --origin      Address the image is mapped at (default: BIOS_START, 0xC1800)\n"
+        << "    -s, --symbols     Print the symbol table after linking\n"
+        << "    -V, --verbose     Enable verbose mode. Additional debug messages will be printed\n"
+        << std::endl;
+}
+
+void print_version()
+{
+    std::cout
+        << "Sysdarft Linker Version " << SYSDARFT_VERSION << std::endl
+        << SYSDARFT_INFORMATION << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    debug::set_thread_name("Sysdarft LD");
+
+    static struct option long_options[] = {
+        {"help",    no_argument,       nullptr, 'h'},
+        {"version", no_argument,       nullptr, 'v'},
+        {"output",  required_argument, nullptr, 'o'},
+        {"origin",  required_argument, nullptr, 'O'},
+        {"symbols", no_argument,       nullptr, 's'},
+        {"verbose", no_argument,       nullptr, 'V'},
+        {nullptr,   0,                 nullptr,  0 }
+    };
+
+    try
+    {
+        std::string output = "a.bin";
+        uint64_t origin = BIOS_START;
+        bool print_symbols = false;
+
+        for (int option; (option = getopt_long(argc, argv, "hvo:O:sV", long_options, nullptr)) != -1; )
+        {
+            switch (option)
+            {
+            case 'h': print_help(argv[0]); return EXIT_SUCCESS;
+            case 'v': print_version(); return EXIT_SUCCESS;
+            case 'o': output = optarg; break;
+            case 'O': origin = std::stoull(optarg, nullptr, 0); break;
+            case 's': print_symbols = true; break;
+            case 'V': debug::verbose = true; break;
+            default: print_help(argv[0]); return EXIT_FAILURE;
+            }
+        }
+
+        if (optind == argc)
+        {
+            log("Expected at least one object file.\n");
+            print_help(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        std::vector < sysdarft_object_t > objects;
+        for (int i = optind; i < argc; i++) {
+            objects.push_back(sysdarft_object_t::load(argv[i]));
+        }
+
+        std::map < std::string, constant_value_t, std::less<> > symbols;
+        const auto image = link_objects(objects, origin, symbols);
+        if (debug::verbose) {
+            log("[Linker] ", objects.size(), " objects, ", image.size(), " bytes\n");
+        }
+
+        if (origin == BIOS_START && image.size() > BIOS_SIZE) {
+            std::cerr << "Warning: image is " << image.size() << " bytes, larger than the BIOS region ("
+                      << BIOS_SIZE << " bytes)" << std::endl;
+        }
+
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+        if (!out) {
+            std::cerr << "Cannot write " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (print_symbols)
+        {
+            for (const auto & [name, value] : symbols)
+            {
+                std::cout << std::hex << std::uppercase << std::setfill('0') << std::setw(16)
+                          << constant_value_to_operand(value) << "  " << name << std::endl;
+            }
+        }
+
+        return EXIT_SUCCESS;
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Argument parsing error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    } catch (...) {
+        std::cerr << "Unknown error occurred." << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -6,6 +6,7 @@
 #include <stdexcept>
 #include <SysdarftDebug.h>
 #include <SysdarftModule.h>
+#include <SysdarftIOHub.h>
 
 // Each option name maps to a list of string values.
 using ParsedOptions = std::map<std::string, std::vector<std::string>>;
@@ -74,6 +75,8 @@ void print_help(const char *program_name)
         << "    -v, --version     Show version information\n"
         << "    -m, --module      Load a configuration file\n"
         << "    -V, --verbose     Enable verbose mode. Additional debug messages will be printed\n"
+        << "    -l, --log-level   Log levels, e.g. \"info,cpu=trace,ui=none\". Subsystems are general,\n"
+        << "                      cpu, memory, ui, backend and module\n"
         << std::endl;
 }
 
@@ -93,11 +96,14 @@ int main(int argc, char** argv)
         {"version", no_argument,       nullptr, 'v'},
         {"module",  required_argument, nullptr, 'm'},
         {"verbose", no_argument,       nullptr, 'V'},
+        {"log-level", required_argument, nullptr, 'l'},
         {nullptr,   0,                 nullptr,  0 }
     };
 
     try
     {
+        // declared before the modules, devices are detached from it when they are unloaded
+        SysdarftIOHub io_hub;
         std::vector < std::unique_ptr<SysdarftModule> > loaded_modules;
         auto [parsed_options, positional_args] = get_args(argc, argv, long_options);
 
@@ -120,18 +126,35 @@ int main(int argc, char** argv)
             return EXIT_SUCCESS;
         }
 
+        // From here on the emulator logs from its hot paths, printing is left to a writer thread
+        debug::start_async_log();
+
         // Handle --verbose option
         if (parsed_options.contains("verbose")) {
             debug::verbose = true;
             log("Verbose mode enabled.\n");
         }
 
+        // Handle --log-level option
+        if (parsed_options.contains("log-level"))
+        {
+            for (const auto & spec : parsed_options["log-level"]) {
+                if (!debug::set_log_levels(spec)) {
+                    throw std::invalid_argument("Invalid log level: " + spec);
+                }
+            }
+        }
+
         // Handle --module option
         if (parsed_options.contains("module"))
         {
             const auto module_path = parsed_options["module"];
-            for (const auto & path : module_path) {
-                loaded_modules.emplace_back(std::make_unique<SysdarftModule>(path));
+            for (const auto & path : module_path)
+            {
+                auto & module = loaded_modules.emplace_back(std::make_unique<SysdarftModule>(path));
+                if (module->is_device()) {
+                    module->attach_device(io_hub);
+                }
             }
         }
 
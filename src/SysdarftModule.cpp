@@ -1,28 +1,101 @@
 #include <SysdarftModule.h>
+#include <SysdarftIOHub.h>
 
-SysdarftModule::SysdarftModule(const std::string & module_path)
+SysdarftModule::SysdarftModule(const std::string & module_path) : path(module_path)
 {
-    handle = dlopen(module_path.c_str(), RTLD_LAZY);
+    load();
+}
+
+void SysdarftModule::load()
+{
+    handle = dlopen(path.c_str(), RTLD_LAZY);
     if (!handle) {
         throw SysdarftModuleLibraryLoadError(dlerror());
     }
 
     try {
+        check_device_abi();
         init();
     } catch (const std::exception &) {
-        dlclose(handle);
+        close_library();
+        handle = nullptr;
+        device_abi_version = 0;
+
+        std::lock_guard<std::mutex> lock(ModuleCallMutex);
+        symbols.clear();
         throw;
     }
+
+    log_info(MODULE, "[Module] Loaded ", path, device_abi_version ? " as a device\n" : "\n");
 }
 
 void SysdarftModule::unload()
 {
     if (handle)
     {
+        detach_device();
         call<void>("module_exit");
-        dlclose(handle);
+        close_library();
         handle = nullptr;
+        device_abi_version = 0;
+
+        std::lock_guard<std::mutex> lock(ModuleCallMutex);
+        symbols.clear();
+    }
+}
+
+void SysdarftModule::reload()
+{
+    if (device_host == nullptr)
+    {
+        unload();
+        load();
+        return;
+    }
+
+    log_info(MODULE, "[Module] Reloading device ", path, " at a safe point\n");
+    auto & hub = *device_hub;
+    hub.quiesce([this, &hub]
+    {
+        const auto state = save_device_state();
+        unload();
+        load();
+
+        if (is_device())
+        {
+            attach_device(hub);
+            if (state) {
+                restore_device_state(*state);
+            }
+        }
+    });
+}
+
+// Queued log records print through functions instantiated in the module, they have to be printed
+// while its code is still mapped. A reloaded module can be a new build at the same addresses, its
+// frames must not be named from the old symbols
+void SysdarftModule::close_library()
+{
+    debug::flush_log();
+    dlclose(handle);
+    debug::forget_symbols();
+}
+
+void * SysdarftModule::resolve(const std::string & function_name)
+{
+    std::lock_guard<std::mutex> lock(ModuleCallMutex);
+    if (const auto it = symbols.find(function_name); it != symbols.end()) {
+        return it->second;
     }
+
+    dlerror();
+    void * entry = dlsym(handle, function_name.c_str());
+    if (const char * error = dlerror()) {
+        throw SysdarftModuleSymbolResolutionError(error);
+    }
+
+    symbols.emplace(function_name, entry);
+    return entry;
 }
 
 void SysdarftModule::init()
@@ -31,3 +104,109 @@ void SysdarftModule::init()
         throw SysdarftModuleLibraryLoadError("Module initialization failed");
     }
 }
+
+void SysdarftModule::check_device_abi()
+{
+    dlerror();
+    const auto * version = static_cast<const uint32_t *>(dlsym(handle, "sysdarft_device_abi_version"));
+    if (dlerror() != nullptr || version == nullptr) {
+        return; // not a device
+    }
+
+    const uint32_t major = *version >> 16;
+    const uint32_t minor = *version & 0xFFFF;
+    if (major != SYSDARFT_DEVICE_ABI_VERSION_MAJOR || minor > SYSDARFT_DEVICE_ABI_VERSION_MINOR)
+    {
+        throw SysdarftModuleLibraryLoadError(path + ": device ABI version "
+            + std::to_string(major) + "." + std::to_string(minor) + " is not supported, the emulator implements "
+            + std::to_string(SYSDARFT_DEVICE_ABI_VERSION_MAJOR) + "." + std::to_string(SYSDARFT_DEVICE_ABI_VERSION_MINOR));
+    }
+
+    // a device without its entry points is as broken as a wrong version
+    (void)resolve("sysdarft_device_attach");
+    (void)resolve("sysdarft_device_detach");
+
+    dlerror();
+    const bool can_save = dlsym(handle, "sysdarft_device_save_state") != nullptr;
+    const bool can_restore = dlsym(handle, "sysdarft_device_restore_state") != nullptr;
+    dlerror();
+    if (can_save != can_restore) {
+        throw SysdarftModuleLibraryLoadError(path + ": device exports only one of save_state and restore_state");
+    }
+
+    device_has_state = can_save;
+    device_abi_version = *version;
+}
+
+std::optional < std::vector < uint8_t > > SysdarftModule::save_device_state()
+{
+    if (!device_has_state) {
+        return std::nullopt;
+    }
+
+    const auto save = bind<int64_t(void *, void *, uint64_t)>("sysdarft_device_save_state");
+    std::vector < uint8_t > state;
+    int64_t size = save(device, nullptr, 0);
+
+    // the state may grow between the calls
+    while (size >= 0 && static_cast<uint64_t>(size) > state.size())
+    {
+        state.resize(size);
+        size = save(device, state.data(), state.size());
+    }
+
+    if (size < 0) {
+        throw SysdarftModuleDeviceStateError(path + ": saving failed with " + std::to_string(size));
+    }
+
+    state.resize(size);
+    return state;
+}
+
+void SysdarftModule::restore_device_state(const std::vector < uint8_t > & state)
+{
+    if (!device_has_state) {
+        return; // the new build starts fresh
+    }
+
+    const auto restore = bind<int(void *, const void *, uint64_t)>("sysdarft_device_restore_state");
+    if (const int result = restore(device, state.data(), state.size()); result != SYSDARFT_DEVICE_OK) {
+        throw SysdarftModuleDeviceStateError(path + ": restoring failed with " + std::to_string(result));
+    }
+}
+
+void SysdarftModule::attach_device(SysdarftIOHub & hub)
+{
+    if (!is_device()) {
+        throw SysdarftModuleLibraryLoadError("Module is not a device");
+    }
+
+    if (device_host != nullptr) {
+        throw SysdarftModuleLibraryLoadError("Device is already attached");
+    }
+
+    const auto * host = hub.connect();
+    void * instance = nullptr;
+    if (bind<int(const sysdarft_host_api_t *, void **)>("sysdarft_device_attach")(host, &instance) != SYSDARFT_DEVICE_OK)
+    {
+        hub.disconnect(host);
+        throw SysdarftModuleLibraryLoadError("Device attach failed");
+    }
+
+    device_hub = &hub;
+    device_host = host;
+    device = instance;
+}
+
+void SysdarftModule::detach_device()
+{
+    if (device_host == nullptr) {
+        return;
+    }
+
+    bind<void(void *)>("sysdarft_device_detach")(device);
+    device_hub->disconnect(device_host);
+    device_hub = nullptr;
+    device_host = nullptr;
+    device = nullptr;
+}
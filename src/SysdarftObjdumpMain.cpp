@@ -0,0 +1,335 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <SysdarftDebug.h>
+#include <SysdarftMemory.h>
+#include <EncodingDecoding.h>
+#include <SysdarftExecutor.h>
+
+class SysdarftObjdumpError final : public SysdarftBaseError
+{
+public:
+    explicit SysdarftObjdumpError(const std::string & message) :
+        SysdarftBaseError("Disassembler error: " + message) { }
+};
+
+// Read only mapping of the whole image
+class mapped_image
+{
+private:
+    const uint8_t * data = nullptr;
+    std::size_t size = 0;
+
+public:
+    explicit mapped_image(const std::string & path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            throw SysdarftObjdumpError("Cannot open " + path);
+        }
+
+        struct stat status { };
+        if (fstat(fd, &status) == -1) {
+            close(fd);
+            throw SysdarftObjdumpError("Cannot stat " + path);
+        }
+
+        size = static_cast<std::size_t>(status.st_size);
+        if (size != 0)
+        {
+            void * mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                throw SysdarftObjdumpError("Cannot map " + path);
+            }
+
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            data = static_cast<const uint8_t *>(mapping);
+        }
+
+        close(fd);
+    }
+
+    ~mapped_image()
+    {
+        if (data != nullptr) {
+            munmap(const_cast<uint8_t *>(data), size);
+        }
+    }
+
+    mapped_image(const mapped_image &) = delete;
+    mapped_image & operator=(const mapped_image &) = delete;
+
+    [[nodiscard]] std::span < const uint8_t > span() const {
+        return { data, size };
+    }
+};
+
+// One large output buffer in front of write(2). Chunks larger than the buffer bypass it
+class buffered_writer
+{
+private:
+    int fd;
+    std::vector < char > buffer;
+    std::size_t used = 0;
+
+    void write_all(const char * data, std::size_t length) const
+    {
+        while (length != 0)
+        {
+            const auto written = ::write(fd, data, length);
+            if (written == -1)
+            {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throw SysdarftObjdumpError("Write failed: " + std::string(strerror(errno)));
+            }
+
+            data += written;
+            length -= static_cast<std::size_t>(written);
+        }
+    }
+
+public:
+    explicit buffered_writer(const int _fd, const std::size_t capacity = 4 * 1024 * 1024)
+        : fd(_fd), buffer(capacity) { }
+
+    void write(const std::string_view data)
+    {
+        if (used + data.size() > buffer.size()) {
+            flush();
+        }
+
+        if (data.size() >= buffer.size()) {
+            write_all(data.data(), data.size());
+            return;
+        }
+
+        std::memcpy(buffer.data() + used, data.data(), data.size());
+        used += data.size();
+    }
+
+    void flush()
+    {
+        write_all(buffer.data(), used);
+        used = 0;
+    }
+
+    ~buffered_writer()
+    {
+        try {
+            flush();
+        } catch (...) {
+            // nothing left to report to
+        }
+    }
+};
+
+// "ADDRESS  NAME" per line, as printed by sysdarft-as --symbols
+std::multimap < uint64_t, std::string > load_symbols(const std::string & path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw SysdarftObjdumpError("Cannot open symbol file " + path);
+    }
+
+    std::multimap < uint64_t, std::string > symbols;
+    std::string address, name;
+    while (file >> address >> name) {
+        symbols.emplace(std::stoull(address, nullptr, 16), name);
+    }
+
+    return symbols;
+}
+
+void append_address(std::string & output, const uint64_t address)
+{
+    char buffer[16];
+    for (int i = 15; i >= 0; i--) {
+        buffer[i] = "0123456789ABCDEF"[(address >> ((15 - i) * 4)) & 0xF];
+    }
+
+    output.append(buffer, sizeof(buffer));
+}
+
+void disassemble_chunk(std::string & output, const std::span < const uint8_t > image,
+    const uint64_t begin, const uint64_t end, const uint64_t origin,
+    const std::multimap < uint64_t, std::string > & symbols)
+{
+    output.clear();
+    output.reserve((end - begin) * 6);
+
+    // labels every symbol below limit, the ones not at address are inside the previous instruction
+    auto symbol = symbols.lower_bound(origin + begin);
+    auto label = [&](const uint64_t address, const uint64_t limit)
+    {
+        for (; symbol != symbols.end() && symbol->first < limit; ++symbol)
+        {
+            output.append("\n");
+            output.append(symbol->second);
+            output.append(":");
+            if (symbol->first != address) {
+                output.append(" ; not on an instruction boundary, at ");
+                append_address(output, symbol->first);
+            }
+            output.append("\n");
+        }
+    };
+
+    for (uint64_t offset = begin; offset < end; )
+    {
+        const uint64_t address = origin + offset;
+        label(address, address + 1);
+
+        append_address(output, address);
+        output.append(": ");
+        decode_instruction(output, image, offset);
+        output.append("\n");
+    }
+
+    // inside the last instruction, the next chunk starts after them. The last chunk also takes a
+    // symbol right after the image, like a label at the end of the source
+    label(origin + end, origin + end + (end == image.size() ? 1 : 0));
+}
+
+void print_help(const char *program_name)
+{
+    std::cout
+        << "Usage: " << program_name << " [OPTIONS] IMAGE\n"
+        << "Options:\n"
+        << "    -h, --help        Show this help message\n"
+        << "    -v, --version     Show version information\n"
+        << "    -o, --output      Write the listing to a file instead of stdout\n"
+        << "    -O, --origin      Address of the first byte of the image (default: BIOS_START, 0xC1800)\n"
+        << "    -j, --jobs        Number of worker threads (default: one per hardware thread)\n"
+        << "    -s, --symbols     Symbol file to label the listing with, as written by sysdarft-as --symbols\n"
+        << "    -V, --verbose     Enable verbose mode. Additional debug messages will be printed\n"
+        << std::endl;
+}
+
+void print_version()
+{
+    std::cout
+        << "Sysdarft Disassembler Version " << SYSDARFT_VERSION << std::endl
+        << SYSDARFT_INFORMATION << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    debug::set_thread_name("Sysdarft Objdump");
+
+    static struct option long_options[] = {
+        {"help",    no_argument,       nullptr, 'h'},
+        {"version", no_argument,       nullptr, 'v'},
+        {"output",  required_argument, nullptr, 'o'},
+        {"origin",  required_argument, nullptr, 'O'},
+        {"jobs",    required_argument, nullptr, 'j'},
+        {"symbols", required_argument, nullptr, 's'},
+        {"verbose", no_argument,       nullptr, 'V'},
+        {nullptr,   0,                 nullptr,  0 }
+    };
+
+    try
+    {
+        std::string output_file;
+        uint64_t origin = BIOS_START;
+        unsigned int jobs = 0;
+        std::multimap < uint64_t, std::string > symbols;
+
+        for (int option; (option = getopt_long(argc, argv, "hvo:O:j:s:V", long_options, nullptr)) != -1; )
+        {
+            switch (option)
+            {
+            case 'h': print_help(argv[0]); return EXIT_SUCCESS;
+            case 'v': print_version(); return EXIT_SUCCESS;
+            case 'o': output_file = optarg; break;
+            case 'O': origin = std::stoull(optarg, nullptr, 0); break;
+            case 'j': jobs = static_cast<unsigned int>(std::stoul(optarg, nullptr, 0)); break;
+            case 's': symbols = load_symbols(optarg); break;
+            case 'V': debug::verbose = true; break;
+            default: print_help(argv[0]); return EXIT_FAILURE;
+            }
+        }
+
+        if (optind + 1 != argc)
+        {
+            log("Expected exactly one image file.\n");
+            print_help(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        if (jobs == 0) {
+            jobs = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        const mapped_image mapping(argv[optind]);
+        const auto image = mapping.span();
+
+        // Instruction boundaries only cost a few byte reads each, find them up front so the
+        // chunks can be formatted independently
+        constexpr uint64_t chunk_size = 256 * 1024;
+        std::vector < uint64_t > boundaries { 0 };
+        for (uint64_t offset = 0; offset < image.size(); )
+        {
+            skip_instruction(image, offset);
+            if (offset - boundaries.back() >= chunk_size && offset < image.size()) {
+                boundaries.push_back(offset);
+            }
+        }
+        boundaries.push_back(image.size());
+
+        const int fd = output_file.empty() ? STDOUT_FILENO
+            : open(output_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1) {
+            throw SysdarftObjdumpError("Cannot open " + output_file);
+        }
+
+        {
+            buffered_writer writer(fd);
+
+            // a window of chunks at a time keeps memory bounded for large images
+            const std::size_t chunks = boundaries.size() - 1;
+            const std::size_t window = jobs * 2;
+            std::vector < std::string > listings(std::min(window, chunks));
+            for (std::size_t first = 0; first < chunks; first += window)
+            {
+                const std::size_t count = std::min(window, chunks - first);
+                run_in_parallel(count, jobs, [&](const std::size_t i) {
+                    disassemble_chunk(listings[i], image, boundaries[first + i], boundaries[first + i + 1],
+                        origin, symbols);
+                });
+
+                for (std::size_t i = 0; i < count; i++) {
+                    writer.write(listings[i]);
+                }
+            }
+
+            writer.flush();
+        }
+
+        if (fd != STDOUT_FILENO) {
+            close(fd);
+        }
+
+        return EXIT_SUCCESS;
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Argument parsing error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    } catch (...) {
+        std::cerr << "Unknown error occurred." << std::endl;
+        return EXIT_FAILURE;
+    }
+}
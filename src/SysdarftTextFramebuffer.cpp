@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <SysdarftTextFramebuffer.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static_assert(SysdarftTextFramebuffer::stride % 64 == 0, "a row has to fill whole mask words");
+
+void SysdarftTextFramebuffer::fill(const uint8_t glyph, const uint8_t attribute)
+{
+    for (int y = 0; y < height; y++)
+    {
+        std::fill_n(glyphs[y].begin(), width, glyph);
+        std::fill_n(attributes[y].begin(), width, attribute);
+    }
+}
+
+void SysdarftTextFramebuffer::write_text(const int x, const int y, const std::string_view text,
+    const uint8_t attribute)
+{
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return;
+    }
+
+    const auto length = std::min<std::size_t>(text.size(), width - x);
+    std::memcpy(glyphs[y].data() + x, text.data(), length);
+    std::fill_n(attributes[y].begin() + x, length, attribute);
+}
+
+void SysdarftTextFramebuffer::copy_row(const SysdarftTextFramebuffer & from, const int y)
+{
+    glyphs[y] = from.glyphs[y];
+    attributes[y] = from.attributes[y];
+}
+
+bool SysdarftTextFramebuffer::apply(const ui_frame_t & frame, const bool cursor_visible)
+{
+    for (const auto & [x, y, ch] : frame.cells) {
+        set_cell(x, y, ch);
+    }
+
+    return frame.cursor_visibility.value_or(cursor_visible);
+}
+
+SysdarftTextFramebuffer::row_mask_t
+SysdarftTextFramebuffer::changed_cells(const SysdarftTextFramebuffer & previous, const int y) const
+{
+    row_mask_t mask { };
+    const uint8_t * glyph = glyphs[y].data();
+    const uint8_t * old_glyph = previous.glyphs[y].data();
+    const uint8_t * attribute = attributes[y].data();
+    const uint8_t * old_attribute = previous.attributes[y].data();
+
+#if defined(__SSE2__)
+    for (int x = 0; x < stride; x += 16)
+    {
+        const auto load = [x](const uint8_t * row) {
+            return _mm_load_si128(reinterpret_cast<const __m128i *>(row + x));
+        };
+
+        const __m128i same = _mm_and_si128(_mm_cmpeq_epi8(load(glyph), load(old_glyph)),
+            _mm_cmpeq_epi8(load(attribute), load(old_attribute)));
+        const auto changed = static_cast<uint64_t>(~_mm_movemask_epi8(same) & 0xFFFF);
+        mask[x / 64] |= changed << (x % 64);
+    }
+#else
+    // eight cells per word: a byte is set where the frames differ, its top bit is gathered into the mask
+    constexpr uint64_t low_bits = 0x7F7F7F7F7F7F7F7F;
+    for (int x = 0; x < stride; x += 8)
+    {
+        const auto load = [x](const uint8_t * row) {
+            uint64_t word;
+            std::memcpy(&word, row + x, sizeof(word));
+            return word;
+        };
+
+        const uint64_t difference = (load(glyph) ^ load(old_glyph)) | (load(attribute) ^ load(old_attribute));
+        const uint64_t nonzero = (((difference & low_bits) + low_bits) | difference) & ~low_bits;
+        const uint64_t changed = (nonzero >> 7) * 0x0102040810204080 >> 56;
+        mask[x / 64] |= changed << (x % 64);
+    }
+#endif
+
+    return mask;
+}
+
+void SysdarftTextFramebuffer::changed_spans(const SysdarftTextFramebuffer & previous, const int y,
+    std::vector < ui_span_t > & spans, const int merge_gap) const
+{
+    spans.clear();
+    const auto mask = changed_cells(previous, y);
+    for (std::size_t word = 0; word < mask.size(); word++)
+    {
+        for (uint64_t bits = mask[word]; bits != 0; bits &= bits - 1)
+        {
+            const int x = static_cast<int>(word * 64) + std::countr_zero(bits);
+            if (x >= width) {
+                return;
+            }
+
+            if (!spans.empty() && x - (spans.back().begin + spans.back().length) < merge_gap) {
+                spans.back().length = x - spans.back().begin + 1;
+            } else {
+                spans.push_back({ .begin = x, .length = 1 });
+            }
+        }
+    }
+}
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <SysdarftUIEventQueue.h>
+
+void ui_frame_t::clear()
+{
+    cells.clear();
+    cursor.reset();
+    cursor_visibility.reset();
+    full_redraw = false;
+}
+
+SysdarftUIEventQueue::SysdarftUIEventQueue()
+{
+    for (std::size_t i = 0; i < ring.size(); i++) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    for (auto & cell : shadow) {
+        cell.store(' ', std::memory_order_relaxed);
+    }
+
+    frame_index.fill(-1);
+
+    wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+SysdarftUIEventQueue::~SysdarftUIEventQueue()
+{
+    if (wakeup != -1) {
+        close(wakeup);
+    }
+}
+
+bool SysdarftUIEventQueue::push(const ui_event_t & event)
+{
+    uint64_t position = tail.load(std::memory_order_relaxed);
+    while (true)
+    {
+        auto & slot = ring[position & (capacity - 1)];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<int64_t>(sequence - position);
+
+        if (difference == 0)
+        {
+            if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                slot.event = event;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            // full, the consumer has not reached this slot yet
+            return false;
+        } else {
+            position = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void SysdarftUIEventQueue::post(const ui_event_t & event)
+{
+    if (!push(event))
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        overflowed.store(true, std::memory_order_release);
+    }
+
+    signal();
+}
+
+void SysdarftUIEventQueue::signal()
+{
+    // pairs with the fence in drain(): either the consumer sees this event, or this sees the flag cleared
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!signalled.load(std::memory_order_relaxed) && !signalled.exchange(true, std::memory_order_relaxed)) {
+        wake();
+    }
+}
+
+void SysdarftUIEventQueue::wake() const
+{
+    if (wakeup != -1) {
+        const uint64_t one = 1;
+        [[maybe_unused]] const auto written = write(wakeup, &one, sizeof(one));
+    }
+}
+
+void SysdarftUIEventQueue::display_char(const int x, const int y, const int ch)
+{
+    if (x < 0 || x >= V_WIDTH || y < 0 || y >= V_HEIGHT) {
+        return;
+    }
+
+    shadow[y * V_WIDTH + x].store(ch, std::memory_order_relaxed);
+    post({ .type = ui_event_t::DISPLAY_CHAR, .x = x, .y = y, .value = ch });
+}
+
+void SysdarftUIEventQueue::display_region(int x, int y, int w, int h, const uint8_t * cells, const int stride)
+{
+    // clip to the screen
+    if (x < 0) { cells -= x; w += x; x = 0; }
+    if (y < 0) { cells -= static_cast<std::ptrdiff_t>(y) * stride; h += y; y = 0; }
+    w = std::min(w, V_WIDTH - x);
+    h = std::min(h, V_HEIGHT - y);
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    for (int row = 0; row < h; row++, cells += stride) {
+        for (int column = 0; column < w; column++) {
+            shadow[(y + row) * V_WIDTH + x + column].store(cells[column], std::memory_order_relaxed);
+        }
+    }
+
+    post({ .type = ui_event_t::DISPLAY_REGION, .x = x, .y = y, .value = 0, .width = w, .height = h });
+}
+
+void SysdarftUIEventQueue::scroll(int lines)
+{
+    lines = std::clamp(lines, -V_HEIGHT, V_HEIGHT);
+    if (lines == 0) {
+        return;
+    }
+
+    // walk away from the lines being overwritten
+    for (int i = 0; i < V_HEIGHT; i++)
+    {
+        const int y = lines > 0 ? i : V_HEIGHT - 1 - i;
+        const int source = y + lines;
+        for (int x = 0; x < V_WIDTH; x++)
+        {
+            const int ch = source >= 0 && source < V_HEIGHT
+                ? shadow[source * V_WIDTH + x].load(std::memory_order_relaxed) : ' ';
+            shadow[y * V_WIDTH + x].store(ch, std::memory_order_relaxed);
+        }
+    }
+
+    post({ .type = ui_event_t::SCROLL, .x = 0, .y = 0, .value = lines });
+}
+
+void SysdarftUIEventQueue::set_cursor(const int x, const int y)
+{
+    shadow_cursor.store({ .x = x, .y = y }, std::memory_order_relaxed);
+    post({ .type = ui_event_t::SET_CURSOR, .x = x, .y = y, .value = 0 });
+}
+
+void SysdarftUIEventQueue::set_cursor_visibility(const bool visible)
+{
+    shadow_visibility.store(visible, std::memory_order_relaxed);
+    post({ .type = ui_event_t::SET_CURSOR_VISIBILITY, .x = 0, .y = 0, .value = visible });
+}
+
+void SysdarftUIEventQueue::coalesce(ui_frame_t & frame, const ui_event_t & event)
+{
+    switch (event.type)
+    {
+    case ui_event_t::DISPLAY_CHAR:
+    {
+        auto & index = frame_index[event.y * V_WIDTH + event.x];
+        if (index < 0)
+        {
+            index = static_cast<int32_t>(frame.cells.size());
+            frame.cells.push_back({ .x = event.x, .y = event.y, .ch = event.value });
+        } else {
+            frame.cells[index].ch = event.value;
+        }
+        break;
+    }
+    case ui_event_t::DISPLAY_REGION:
+        for (int y = event.y; y < event.y + event.height; y++) {
+            for (int x = event.x; x < event.x + event.width; x++) {
+                coalesce(frame, { .type = ui_event_t::DISPLAY_CHAR, .x = x, .y = y,
+                    .value = shadow[y * V_WIDTH + x].load(std::memory_order_relaxed) });
+            }
+        }
+        break;
+    case ui_event_t::SCROLL:
+        coalesce(frame, { .type = ui_event_t::DISPLAY_REGION, .x = 0, .y = 0, .value = 0,
+            .width = V_WIDTH, .height = V_HEIGHT });
+        frame.full_redraw = true;
+        break;
+    case ui_event_t::SET_CURSOR: frame.cursor = CursorPosition { .x = event.x, .y = event.y }; break;
+    case ui_event_t::SET_CURSOR_VISIBILITY: frame.cursor_visibility = event.value != 0; break;
+    }
+}
+
+bool SysdarftUIEventQueue::drain(ui_frame_t & frame)
+{
+    frame.clear();
+
+    if (wakeup != -1) {
+        uint64_t count;
+        [[maybe_unused]] const auto read_bytes = read(wakeup, &count, sizeof(count));
+    }
+    signalled.store(false, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // taken before the ring is drained, an overflow after this point is seen by the next drain
+    const bool redraw = overflowed.exchange(false, std::memory_order_acquire);
+
+    // at most one ring's worth, a producer that keeps up with the drain must not hold the frame back.
+    // What is left is signalled again and makes the next frame
+    for (std::size_t drained = 0; ; drained++)
+    {
+        auto & slot = ring[head & (capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+            break;
+        }
+
+        if (drained == capacity) {
+            signal();
+            break;
+        }
+
+        coalesce(frame, slot.event);
+        slot.sequence.store(head + capacity, std::memory_order_release);
+        head++;
+    }
+
+    if (redraw)
+    {
+        // events were dropped, the shadow holds the latest state of everything
+        coalesce(frame, { .type = ui_event_t::DISPLAY_REGION, .x = 0, .y = 0, .value = 0,
+            .width = V_WIDTH, .height = V_HEIGHT });
+
+        frame.cursor = shadow_cursor.load(std::memory_order_relaxed);
+        frame.cursor_visibility = shadow_visibility.load(std::memory_order_relaxed);
+        frame.full_redraw = true;
+    }
+
+    for (const auto & cell : frame.cells) {
+        frame_index[cell.y * V_WIDTH + cell.x] = -1;
+    }
+
+    return !frame.empty();
+}
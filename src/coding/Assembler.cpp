@@ -0,0 +1,618 @@
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <ranges>
+#include <set>
+#include <thread>
+#include <SysdarftExecutor.h>
+#include <SysdarftAssembler.h>
+
+struct assembler_statement_t
+{
+    std::size_t line_number { };                // 1-based
+    std::string_view text { };                  // line without labels and comment
+    std::vector < std::string_view > labels { };
+    enum { EMPTY, INSTRUCTION, EQU, SECTION, GLOBAL } StatementType { };
+    lexed_instruction_t instruction { };
+    std::string_view equ_name { };
+    std::string_view equ_expression { };
+    std::string_view section_name { };
+    std::vector < std::string_view > global_names { };
+    uint64_t section { };
+    uint64_t size { };
+    uint64_t offset { };                        // inside the section
+    uint64_t hash { };
+    assembler_cache_entry_t * cached { };       // cache hit from pass one
+    std::unique_ptr < assembler_cache_entry_t > encoded { };  // result of encoding the line in pass two
+};
+
+// value recorded for referenced symbols the source does not define
+constexpr int64_t undefined_section = -2;
+
+// base given to addresses when an expression is evaluated a second time, see evaluate_relocatable().
+// Odd, so that alignment arithmetic on an address cannot make it look constant
+constexpr __int128_t address_probe = 0x9E3779B1;
+
+uint64_t assembler_hash(const std::string_view text)
+{
+    uint64_t hash = 0xCBF29CE484222325;
+    for (const char ch : text) {
+        hash = (hash ^ static_cast<uint8_t>(ch)) * 0x100000001B3;
+    }
+
+    return hash;
+}
+
+bool is_symbol_character(const char ch, const bool first)
+{
+    return std::isalpha(static_cast<unsigned char>(ch)) || ch == '_'
+        || (!first && (std::isdigit(static_cast<unsigned char>(ch)) || ch == '.'));
+}
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+    }
+
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+
+    return text;
+}
+
+// length of the symbol at the beginning of text, 0 if there is none
+std::size_t symbol_length(const std::string_view text)
+{
+    std::size_t length = 0;
+    while (length < text.size() && is_symbol_character(text[length], length == 0)) {
+        length++;
+    }
+
+    return length;
+}
+
+bool same_value(const assembler_value_t & a, const assembler_value_t & b)
+{
+    return a.Section == b.Section
+        && a.Value.ValueType == b.Value.ValueType
+        && a.Value.IntegerValue == b.Value.IntegerValue
+        && std::bit_cast<uint64_t>(a.Value.FloatValue) == std::bit_cast<uint64_t>(b.Value.FloatValue);
+}
+
+bool directive_is(const std::string_view directive, const std::string_view name)
+{
+    return std::ranges::equal(directive, name, [](const char a, const char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+}
+
+void parse_directive(assembler_statement_t & statement, const std::string_view line)
+{
+    const auto directive_length = symbol_length(line.substr(1));
+    const auto directive = line.substr(1, directive_length);
+    auto arguments = trim(line.substr(directive_length + 1));
+
+    if (directive_is(directive, "equ"))
+    {
+        const auto name_length = symbol_length(arguments);
+        if (name_length == 0) {
+            throw SysdarftAssemblerError("Expected a symbol name after .equ");
+        }
+
+        statement.equ_name = arguments.substr(0, name_length);
+        arguments = trim(arguments.substr(name_length));
+        if (arguments.empty() || arguments.front() != ',') {
+            throw SysdarftAssemblerError("Expected ',' after .equ " + std::string(statement.equ_name));
+        }
+
+        statement.equ_expression = trim(arguments.substr(1));
+        statement.StatementType = assembler_statement_t::EQU;
+    }
+    else if (directive_is(directive, "section"))
+    {
+        // section names may start with a dot, like .text
+        const std::size_t dot = arguments.starts_with('.') ? 1 : 0;
+        const auto name_length = dot + symbol_length(arguments.substr(dot));
+        if (name_length == dot || name_length != arguments.size()) {
+            throw SysdarftAssemblerError("Expected a section name after .section");
+        }
+
+        statement.section_name = arguments;
+        statement.StatementType = assembler_statement_t::SECTION;
+    }
+    else if (directive_is(directive, "global"))
+    {
+        while (true)
+        {
+            const auto name_length = symbol_length(arguments);
+            if (name_length == 0) {
+                throw SysdarftAssemblerError("Expected a symbol name after .global");
+            }
+
+            statement.global_names.push_back(arguments.substr(0, name_length));
+            arguments = trim(arguments.substr(name_length));
+            if (arguments.empty()) {
+                break;
+            }
+
+            if (arguments.front() != ',') {
+                throw SysdarftAssemblerError("Expected ',' between .global symbols");
+            }
+
+            arguments = trim(arguments.substr(1));
+        }
+
+        statement.StatementType = assembler_statement_t::GLOBAL;
+    }
+    else {
+        throw SysdarftAssemblerError("Unknown directive ." + std::string(directive));
+    }
+}
+
+void parse_statement(assembler_statement_t & statement, std::string_view line)
+{
+    if (const auto comment = line.find(';'); comment != std::string_view::npos) {
+        line = line.substr(0, comment);
+    }
+
+    line = trim(line);
+
+    // leading labels
+    for (std::size_t length = symbol_length(line); length != 0; length = symbol_length(line))
+    {
+        const auto rest = trim(line.substr(length));
+        if (rest.empty() || rest.front() != ':') {
+            break;
+        }
+
+        statement.labels.push_back(line.substr(0, length));
+        line = trim(rest.substr(1));
+    }
+
+    statement.text = line;
+    if (line.empty()) {
+        statement.StatementType = assembler_statement_t::EMPTY;
+    } else if (line.front() == '.') {
+        parse_directive(statement, line);
+    } else {
+        statement.StatementType = assembler_statement_t::INSTRUCTION;
+    }
+}
+
+// Calls function(target, position) for every constant of the instruction, with the position of
+// its value in the encoding (see encode_constant() and encode_memory()). Constants using symbols,
+// the only ones that can need a relocation, always have 64bit values
+template < typename Function >
+void for_each_constant(const lexed_instruction_t & instruction, const encoding_mode_t mode, Function && function)
+{
+    uint64_t position = instruction.Width == 0 ? 1 : 2;
+    for (const auto & operand : instruction.Operands)
+    {
+        if (operand.TargetType == lexed_target_t::CONSTANT) {
+            function(static_cast<const lexed_target_t &>(operand), position + 2);
+        } else if (operand.TargetType == lexed_target_t::MEMORY) {
+            uint64_t parameter_position = position + 2;   // prefix, width
+            for (const auto & parameter : operand.MemoryParameters)
+            {
+                if (parameter.TargetType == lexed_target_t::CONSTANT) {
+                    function(parameter, parameter_position + 2);
+                }
+
+                parameter_position += encoded_target_size(parameter, mode);
+            }
+        }
+
+        position += encoded_operand_size(operand, mode);
+    }
+}
+
+using symbol_lookup_t = std::function<const assembler_value_t * (std::string_view)>;
+
+struct relocatable_value_t
+{
+    constant_value_t Value { };                 // the value for absolute expressions, the addend otherwise
+    bool Relocatable = false;
+    int64_t Section = -1;                       // address the value is relative to, or
+    std::string_view Symbol { };                // the external symbol, when Section is -1
+};
+
+// Addresses are unknown until link time, so expressions using them have to stay linear in a
+// single address. The expression is evaluated with addresses taken relative to their section
+// or external symbol, then again with all of them moved by address_probe: if the result moved
+// as much, it is address + constant, if it did not move, the addresses cancelled out
+relocatable_value_t evaluate_relocatable(const std::string_view expression, const symbol_lookup_t & lookup)
+{
+    relocatable_value_t result;
+    bool several_bases = false;
+    auto evaluate = [&](const __int128_t base)
+    {
+        return evaluate_constant_expression(expression, [&](const std::string_view name, constant_value_t & value) -> bool
+        {
+            const auto * symbol = lookup(name);
+            if (symbol != nullptr && symbol->Section < 0) {
+                value = symbol->Value;
+                return true;
+            }
+
+            const int64_t section = symbol != nullptr ? symbol->Section : -1;
+            const auto external = symbol != nullptr ? std::string_view { } : name;
+            if (!result.Relocatable) {
+                result.Relocatable = true;
+                result.Section = section;
+                result.Symbol = external;
+            } else if (result.Section != section || result.Symbol != external) {
+                several_bases = true;
+            }
+
+            value = {
+                .ValueType = constant_value_t::INTEGER,
+                .IntegerValue = (symbol != nullptr ? symbol->Value.IntegerValue : 0) + base,
+                .FloatValue = 0
+            };
+            return true;
+        });
+    };
+
+    result.Value = evaluate(0);
+    if (!result.Relocatable) {
+        return result;
+    }
+
+    if (several_bases) {
+        throw SysdarftRelocationError("Expression " + std::string(expression)
+            + " combines addresses of different sections or external symbols");
+    }
+
+    const auto moved = evaluate(address_probe);
+    if (result.Value.ValueType != constant_value_t::INTEGER || moved.ValueType != constant_value_t::INTEGER) {
+        throw SysdarftRelocationError("Address used in floating point expression " + std::string(expression));
+    }
+
+    const auto difference = moved.IntegerValue - result.Value.IntegerValue;
+    if (difference == 0) {
+        result.Relocatable = false;
+    } else if (difference != address_probe) {
+        throw SysdarftRelocationError("Expression " + std::string(expression) + " is not an address plus a constant");
+    }
+
+    return result;
+}
+
+SysdarftAssembler::SysdarftAssembler(const uint64_t _origin, const unsigned int _threads, const encoding_mode_t _mode)
+    : origin(_origin), threads(_threads), mode(_mode)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+sysdarft_object_t SysdarftAssembler::assemble_object(const std::string_view source, const std::string & file_name)
+{
+    externals.clear();
+    generation++;
+
+    auto located = [&file_name](const assembler_statement_t & statement, const std::string & message) {
+        return SysdarftAssemblerError(file_name + ":" + std::to_string(statement.line_number) + ": " + message);
+    };
+
+    // split lines, statements keep views into source
+    std::vector < assembler_statement_t > statements;
+    std::vector < std::string_view > lines;
+    for (std::size_t begin = 0; begin < source.size(); )
+    {
+        auto end = source.find('\n', begin);
+        if (end == std::string_view::npos) {
+            end = source.size();
+        }
+
+        auto line = source.substr(begin, end - begin);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        lines.push_back(line);
+        begin = end + 1;
+    }
+
+    statements.resize(lines.size());
+    const std::size_t lines_per_chunk = std::max<std::size_t>(256, lines.size() / (threads * 4) + 1);
+    const std::size_t chunks = (lines.size() + lines_per_chunk - 1) / lines_per_chunk;
+
+    // pass one: lex every line not found in the cache and compute instruction sizes
+    run_in_parallel(chunks, threads, [&](const std::size_t chunk)
+    {
+        const std::size_t end = std::min(lines.size(), (chunk + 1) * lines_per_chunk);
+        for (std::size_t i = chunk * lines_per_chunk; i < end; i++)
+        {
+            auto & statement = statements[i];
+            statement.line_number = i + 1;
+            try
+            {
+                parse_statement(statement, lines[i]);
+                if (statement.StatementType != assembler_statement_t::INSTRUCTION) {
+                    continue;
+                }
+
+                statement.hash = assembler_hash(statement.text);
+                if (const auto it = cache.find(statement.hash); it != cache.end() && it->second.text == statement.text)
+                {
+                    statement.cached = &it->second;
+                    statement.size = it->second.size;
+                    continue;
+                }
+
+                lex_instruction(statement.text, statement.instruction);
+                statement.size = encoded_instruction_size(statement.instruction, mode);
+            } catch (const SysdarftBaseError & Err) {
+                throw located(statement, Err.message());
+            }
+        }
+    });
+
+    // lay out labels, each section starting at offset 0
+    sysdarft_object_t object;
+    object.Name = file_name;
+    object.SourceHash = source_hash(source);
+    object.Sections.push_back({ .Name = ".text", .Code = { } });
+
+    std::vector < uint64_t > section_sizes { 0 };
+    uint64_t current_section = 0;
+    std::map < std::string_view, assembler_value_t, std::less<> > object_symbols;
+    std::map < std::string_view, const assembler_statement_t *, std::less<> > constants;
+    std::map < std::string_view, const assembler_statement_t *, std::less<> > globals;
+    for (auto & statement : statements)
+    {
+        for (const auto & label : statement.labels)
+        {
+            const auto [it, inserted] = object_symbols.emplace(label, assembler_value_t {
+                .Value = {
+                    .ValueType = constant_value_t::INTEGER,
+                    .IntegerValue = section_sizes[current_section],
+                    .FloatValue = 0 },
+                .Section = static_cast<int64_t>(current_section) });
+            if (!inserted || constants.contains(label)) {
+                throw located(statement, "Redefinition of symbol " + std::string(label));
+            }
+        }
+
+        switch (statement.StatementType)
+        {
+        case assembler_statement_t::EQU:
+            if (object_symbols.contains(statement.equ_name) || !constants.emplace(statement.equ_name, &statement).second) {
+                throw located(statement, "Redefinition of symbol " + std::string(statement.equ_name));
+            }
+            break;
+
+        case assembler_statement_t::SECTION: {
+            const auto it = std::ranges::find(object.Sections, statement.section_name, &object_section_t::Name);
+            current_section = static_cast<uint64_t>(it - object.Sections.begin());
+            if (it == object.Sections.end()) {
+                object.Sections.push_back({ .Name = std::string(statement.section_name), .Code = { } });
+                section_sizes.push_back(0);
+            }
+            break;
+        }
+
+        case assembler_statement_t::GLOBAL:
+            for (const auto & name : statement.global_names) {
+                globals.emplace(name, &statement);
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        statement.section = current_section;
+        statement.offset = section_sizes[current_section];
+        section_sizes[current_section] += statement.size;
+    }
+
+    // resolve constants, which may reference labels and each other in any order
+    std::set < std::string_view > resolving;
+    symbol_lookup_t resolve_constant = [&](const std::string_view name) -> const assembler_value_t *
+    {
+        if (const auto it = object_symbols.find(name); it != object_symbols.end()) {
+            return &it->second;
+        }
+
+        const auto it = constants.find(name);
+        if (it == constants.end()) {
+            return nullptr;
+        }
+
+        if (!resolving.insert(name).second) {
+            throw located(*it->second, "Circular definition of symbol " + std::string(name));
+        }
+
+        relocatable_value_t value;
+        try {
+            value = evaluate_relocatable(it->second->equ_expression, resolve_constant);
+        } catch (const SysdarftAssemblerError &) {
+            throw;      // from a constant referenced by this one, already located
+        } catch (const SysdarftBaseError & Err) {
+            throw located(*it->second, Err.message());
+        }
+
+        if (value.Relocatable && value.Section < 0) {
+            throw located(*it->second, "Constant " + std::string(name) + " depends on undefined symbol "
+                + std::string(value.Symbol));
+        }
+
+        resolving.erase(name);
+        return &object_symbols.emplace(name, assembler_value_t {
+            .Value = value.Value, .Section = value.Relocatable ? value.Section : -1 }).first->second;
+    };
+
+    for (const auto & name : constants | std::views::keys) {
+        resolve_constant(name);
+    }
+
+    for (const auto & [name, statement] : globals)
+    {
+        if (!object_symbols.contains(name)) {
+            throw located(*statement, "Global symbol " + std::string(name) + " is not defined");
+        }
+    }
+
+    for (std::size_t i = 0; i < object.Sections.size(); i++) {
+        object.Sections[i].Code.resize(section_sizes[i]);
+    }
+
+    // pass two: copy cached lines whose symbols kept their values, encode the rest
+    auto up_to_date = [&object_symbols](const assembler_cache_entry_t & entry) -> bool
+    {
+        return std::ranges::all_of(entry.references, [&object_symbols](const auto & reference)
+        {
+            const auto it = object_symbols.find(reference.first);
+            return it == object_symbols.end() ? reference.second.Section == undefined_section
+                : same_value(it->second, reference.second);
+        });
+    };
+
+    run_in_parallel(chunks, threads, [&](const std::size_t chunk)
+    {
+        const std::size_t end = std::min(statements.size(), (chunk + 1) * lines_per_chunk);
+        for (std::size_t i = chunk * lines_per_chunk; i < end; i++)
+        {
+            auto & statement = statements[i];
+            if (statement.StatementType != assembler_statement_t::INSTRUCTION) {
+                continue;
+            }
+
+            auto * destination = object.Sections[statement.section].Code.data() + statement.offset;
+            if (statement.cached != nullptr && up_to_date(*statement.cached))
+            {
+                std::memcpy(destination, statement.cached->code.data(), statement.size);
+                continue;
+            }
+
+            auto entry = std::make_unique<assembler_cache_entry_t>();
+            const symbol_lookup_t lookup = [&object_symbols, &entry](const std::string_view name) -> const assembler_value_t *
+            {
+                const auto it = object_symbols.find(name);
+                const auto * symbol = it == object_symbols.end() ? nullptr : &it->second;
+                if (std::ranges::find(entry->references, name, &std::pair<std::string, assembler_value_t>::first)
+                    == entry->references.end())
+                {
+                    entry->references.emplace_back(name,
+                        symbol != nullptr ? *symbol : assembler_value_t { .Value = { }, .Section = undefined_section });
+                }
+
+                return symbol;
+            };
+
+            // addresses are encoded relative to their base, the linker adds the base
+            const symbol_resolver_t resolve_symbol = [&lookup](const std::string_view name, constant_value_t & value) -> bool
+            {
+                const auto * symbol = lookup(name);
+                value = symbol != nullptr ? symbol->Value : constant_value_t { };
+                return true;
+            };
+
+            try
+            {
+                if (statement.cached != nullptr) {
+                    lex_instruction(statement.text, statement.instruction);
+                }
+
+                for_each_constant(statement.instruction, mode, [&](const lexed_target_t & target, const uint64_t position)
+                {
+                    const auto value = evaluate_relocatable(target.ConstantExpression, lookup);
+                    if (value.Relocatable)
+                    {
+                        entry->relocations.push_back({
+                            .Section = 0,
+                            .Offset = position,
+                            .TargetSection = value.Section,
+                            .Symbol = std::string(value.Symbol),
+                            .Addend = constant_value_to_operand(value.Value) });
+                    }
+                });
+
+                encode_lexed_instruction(entry->code, statement.instruction, statement.text, resolve_symbol, mode);
+            } catch (const SysdarftBaseError & Err) {
+                throw located(statement, Err.message());
+            }
+
+            if (entry->code.size() != statement.size) {
+                throw located(statement, "Encoded size " + std::to_string(entry->code.size())
+                    + " differs from the size used for label layout " + std::to_string(statement.size));
+            }
+
+            std::memcpy(destination, entry->code.data(), statement.size);
+            entry->text = statement.text;
+            entry->size = statement.size;
+            statement.encoded = std::move(entry);
+        }
+    });
+
+    // collect relocations, update the cache and drop entries no longer used by the source
+    statistics = { };
+    for (auto & statement : statements)
+    {
+        if (statement.StatementType != assembler_statement_t::INSTRUCTION) {
+            continue;
+        }
+
+        const auto & entry = statement.encoded ? *statement.encoded : *statement.cached;
+        for (const auto & relocation : entry.relocations)
+        {
+            object.Relocations.push_back({
+                .Section = statement.section,
+                .Offset = statement.offset + relocation.Offset,
+                .TargetSection = relocation.TargetSection,
+                .Symbol = relocation.Symbol,
+                .Addend = relocation.Addend });
+
+            if (relocation.TargetSection < 0) {
+                externals.emplace(relocation.Symbol, statement.line_number);
+            }
+        }
+
+        statistics.instructions++;
+        if (statement.encoded)
+        {
+            statistics.encoded++;
+            statement.encoded->generation = generation;
+            cache.insert_or_assign(statement.hash, std::move(*statement.encoded));
+        } else {
+            statement.cached->generation = generation;
+        }
+    }
+
+    std::erase_if(cache, [this](const auto & entry) { return entry.second.generation != generation; });
+
+    for (const auto & [name, value] : object_symbols) {
+        object.Symbols.push_back({ .Name = std::string(name), .Global = globals.contains(name), .Value = value });
+    }
+
+    return object;
+}
+
+uint64_t SysdarftAssembler::source_hash(const std::string_view source) const
+{
+    // the encoding mode changes the code, unlike the origin which only matters when linking
+    return assembler_hash(source) ^ mode;
+}
+
+std::vector < uint8_t > SysdarftAssembler::assemble(const std::string_view source, const std::string & file_name)
+{
+    symbols.clear();
+    const auto object = assemble_object(source, file_name);
+
+    // a whole program has nothing to link against
+    if (!externals.empty())
+    {
+        const auto first = std::ranges::min_element(externals, { },
+            [](const auto & external) { return external.second; });
+        throw SysdarftAssemblerError(file_name + ":" + std::to_string(first->second)
+            + ": Undefined symbol " + first->first);
+    }
+
+    return link_objects({ &object, 1 }, origin, symbols);
+}
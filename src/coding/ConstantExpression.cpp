@@ -0,0 +1,325 @@
+#include <bit>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <EncodingDecoding.h>
+
+// Native replacement for the `echo ... | bc` pipeline that used to evaluate every $(...) operand.
+// Grammar and precedence follow bc (scale = 0):
+//   expression := term     (('+' | '-') term)*
+//   term       := power    (('*' | '/' | '%') power)*
+//   power      := unary    ('^' power)?           ; right associative
+//   unary      := '-' unary | primary             ; binds tighter than '^', so -2^2 == 4
+//   primary    := number | symbol | '(' expression ')'
+// Integers are evaluated in 128bit with truncating division, and an expression turns into a
+// floating point one (IEEE double) as soon as one of its literals carries a decimal point.
+// Symbols ([A-Za-z_][A-Za-z0-9_.]*) are looked up through the resolver, if one was given.
+class ConstantExpressionParser
+{
+private:
+    std::string_view expression;
+    const symbol_resolver_t & resolver;
+    std::size_t position = 0;
+
+    [[noreturn]] void error(const std::string & reason) const
+    {
+        throw SysdarftCodeExpressionError(reason + " at column " + std::to_string(position + 1)
+            + " in " + std::string(expression));
+    }
+
+    char peek()
+    {
+        while (position < expression.size() && std::isspace(static_cast<unsigned char>(expression[position]))) {
+            position++;
+        }
+
+        return position < expression.size() ? expression[position] : '\0';
+    }
+
+    static constant_value_t promote(const constant_value_t & value)
+    {
+        if (value.ValueType == constant_value_t::FLOAT) {
+            return value;
+        }
+
+        return { .ValueType = constant_value_t::FLOAT,
+                 .IntegerValue = 0,
+                 .FloatValue = static_cast<double>(value.IntegerValue) };
+    }
+
+    constant_value_t apply(const char operation, const constant_value_t & lhs, const constant_value_t & rhs)
+    {
+        if (lhs.ValueType == constant_value_t::FLOAT || rhs.ValueType == constant_value_t::FLOAT)
+        {
+            const double a = promote(lhs).FloatValue;
+            const double b = promote(rhs).FloatValue;
+            double result = 0;
+
+            switch (operation)
+            {
+            case '+': result = a + b; break;
+            case '-': result = a - b; break;
+            case '*': result = a * b; break;
+            case '/':
+                if (b == 0) { error("Divide by zero"); }
+                result = a / b;
+                break;
+            case '%':
+                if (b == 0) { error("Divide by zero"); }
+                result = std::fmod(a, b);
+                break;
+            case '^': result = std::pow(a, std::trunc(b)); break;
+            default: error(std::string("Unknown operator '") + operation + "'");
+            }
+
+            return { .ValueType = constant_value_t::FLOAT, .IntegerValue = 0, .FloatValue = result };
+        }
+
+        const __int128_t a = lhs.IntegerValue;
+        const __int128_t b = rhs.IntegerValue;
+        __int128_t result = 0;
+        bool overflow = false;
+
+        switch (operation)
+        {
+        case '+': overflow = __builtin_add_overflow(a, b, &result); break;
+        case '-': overflow = __builtin_sub_overflow(a, b, &result); break;
+        case '*': overflow = __builtin_mul_overflow(a, b, &result); break;
+        case '/':
+            if (b == 0) { error("Divide by zero"); }
+            result = a / b;
+            break;
+        case '%':
+            if (b == 0) { error("Divide by zero"); }
+            result = a % b;
+            break;
+        case '^':
+            if (b < 0)
+            {
+                // bc truncates 1 / a^n to scale 0
+                if (a == 0) { error("Divide by zero"); }
+                if (a == 1) { result = 1; }
+                else if (a == -1) { result = (b % 2 == 0) ? 1 : -1; }
+                else { result = 0; }
+                break;
+            }
+
+            result = 1;
+            for (__int128_t base = a, exponent = b; exponent != 0 && !overflow; exponent >>= 1)
+            {
+                if (exponent & 1) {
+                    overflow = __builtin_mul_overflow(result, base, &result);
+                }
+
+                if (exponent > 1) {
+                    overflow = overflow || __builtin_mul_overflow(base, base, &base);
+                }
+            }
+            break;
+        default: error(std::string("Unknown operator '") + operation + "'");
+        }
+
+        if (overflow) {
+            error("Integer overflow");
+        }
+
+        return { .ValueType = constant_value_t::INTEGER, .IntegerValue = result, .FloatValue = 0 };
+    }
+
+    constant_value_t number()
+    {
+        const std::size_t begin = position;
+
+        // base 16
+        if (expression.size() - position > 2 && expression[position] == '0'
+            && (expression[position + 1] == 'x' || expression[position + 1] == 'X'))
+        {
+            position += 2;
+            __int128_t value = 0;
+            const std::size_t digits_begin = position;
+            while (position < expression.size() && std::isxdigit(static_cast<unsigned char>(expression[position])))
+            {
+                const char digit = static_cast<char>(std::toupper(static_cast<unsigned char>(expression[position])));
+                value = value * 16 + (std::isdigit(static_cast<unsigned char>(digit)) ? digit - '0' : digit - 'A' + 10);
+                if (value > UINT64_MAX) {
+                    error("Base 16 number exceeds 64bit");
+                }
+                position++;
+            }
+
+            if (position == digits_begin) {
+                error("Expected base 16 digits");
+            }
+
+            return { .ValueType = constant_value_t::INTEGER, .IntegerValue = value, .FloatValue = 0 };
+        }
+
+        bool is_float = false;
+        __int128_t value = 0;
+        while (position < expression.size())
+        {
+            const char digit = expression[position];
+            if (digit == '.') {
+                if (is_float) { break; }
+                is_float = true;
+            } else if (std::isdigit(static_cast<unsigned char>(digit))) {
+                if (!is_float && __builtin_mul_overflow(value, 10, &value)) { error("Integer overflow"); }
+                if (!is_float && __builtin_add_overflow(value, digit - '0', &value)) { error("Integer overflow"); }
+            } else {
+                break;
+            }
+
+            position++;
+        }
+
+        if (is_float)
+        {
+            const std::string literal(expression.substr(begin, position - begin));
+            if (literal == ".") {
+                error("Expected a number");
+            }
+
+            return { .ValueType = constant_value_t::FLOAT, .IntegerValue = 0, .FloatValue = std::strtod(literal.c_str(), nullptr) };
+        }
+
+        return { .ValueType = constant_value_t::INTEGER, .IntegerValue = value, .FloatValue = 0 };
+    }
+
+    static bool is_symbol_character(const char ch, const bool first) {
+        return std::isalpha(static_cast<unsigned char>(ch)) || ch == '_'
+            || (!first && (std::isdigit(static_cast<unsigned char>(ch)) || ch == '.'));
+    }
+
+    constant_value_t symbol()
+    {
+        const std::size_t begin = position;
+        while (position < expression.size() && is_symbol_character(expression[position], position == begin)) {
+            position++;
+        }
+
+        const auto name = expression.substr(begin, position - begin);
+        constant_value_t value { };
+        if (!resolver || !resolver(name, value))
+        {
+            position = begin;
+            error("Undefined symbol '" + std::string(name) + "'");
+        }
+
+        return value;
+    }
+
+    constant_value_t primary()
+    {
+        const char ch = peek();
+
+        if (ch == '(')
+        {
+            position++;
+            auto value = parse_expression();
+            if (peek() != ')') {
+                error("Expected ')'");
+            }
+            position++;
+            return value;
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(ch)) || ch == '.') {
+            return number();
+        }
+
+        if (is_symbol_character(ch, true)) {
+            return symbol();
+        }
+
+        if (ch == '\0') {
+            error("Unexpected end of expression");
+        }
+
+        error(std::string("Unexpected character '") + ch + "'");
+    }
+
+    constant_value_t unary()
+    {
+        if (peek() == '-')
+        {
+            position++;
+            const auto value = unary();
+            return apply('-', { .ValueType = constant_value_t::INTEGER, .IntegerValue = 0, .FloatValue = 0 }, value);
+        }
+
+        return primary();
+    }
+
+    constant_value_t power()
+    {
+        const auto base = unary();
+        if (peek() == '^')
+        {
+            position++;
+            const auto exponent = power();
+            return apply('^', base, exponent);
+        }
+
+        return base;
+    }
+
+    constant_value_t term()
+    {
+        auto value = power();
+        for (char ch = peek(); ch == '*' || ch == '/' || ch == '%'; ch = peek())
+        {
+            position++;
+            value = apply(ch, value, power());
+        }
+
+        return value;
+    }
+
+    constant_value_t parse_expression()
+    {
+        auto value = term();
+        for (char ch = peek(); ch == '+' || ch == '-'; ch = peek())
+        {
+            position++;
+            value = apply(ch, value, term());
+        }
+
+        return value;
+    }
+
+public:
+    ConstantExpressionParser(const std::string_view _expression, const symbol_resolver_t & _resolver)
+        : expression(_expression), resolver(_resolver) { }
+
+    constant_value_t parse()
+    {
+        auto value = parse_expression();
+        if (peek() != '\0') {
+            error(std::string("Unexpected character '") + expression[position] + "'");
+        }
+
+        return value;
+    }
+};
+
+constant_value_t SYSDARFT_EXPORT_SYMBOL evaluate_constant_expression(const std::string_view expression,
+    const symbol_resolver_t & resolver)
+{
+    return ConstantExpressionParser(expression, resolver).parse();
+}
+
+uint64_t SYSDARFT_EXPORT_SYMBOL constant_value_to_operand(const constant_value_t & value)
+{
+    if (value.ValueType == constant_value_t::FLOAT) {
+        return std::bit_cast<uint64_t>(value.FloatValue);
+    }
+
+    // same saturation strtoull() applied to bc's output
+    if (value.IntegerValue > static_cast<__int128_t>(UINT64_MAX)
+        || value.IntegerValue < -static_cast<__int128_t>(UINT64_MAX))
+    {
+        return UINT64_MAX;
+    }
+
+    return static_cast<uint64_t>(value.IntegerValue);
+}
@@ -1,61 +1,107 @@
-#include <iomanip>
+#include <array>
 #include <EncodingDecoding.h>
 #include <InstructionSet.h>
 
-void decode_instruction(std::vector < std::string > & output, std::vector<uint8_t> & input)
+struct opcode_entry_t
+{
+    std::string_view name;
+    uint64_t argument_count;
+    bool requires_width_specification;
+};
+
+// instruction_map indexed by opcode, built once instead of searched per instruction
+const opcode_entry_t * find_opcode(const uint8_t opcode)
 {
-    try
+    static const auto table = []
     {
-        std::stringstream buffer;
-        uint64_t instruction = 0;
-        instruction = code_buffer_pop8(input);
+        std::array < opcode_entry_t, 256 > ret { };
+        for (const auto & [name, entry] : instruction_map)
+        {
+            ret[entry.at(ENTRY_OPCODE) & 0xFF] = {
+                .name = name,
+                .argument_count = entry.at(ENTRY_ARGUMENT_COUNT),
+                .requires_width_specification = entry.at(ENTRY_REQUIRE_OPERATION_WIDTH_SPECIFICATION) != 0,
+            };
+        }
+        return ret;
+    }();
+
+    return table[opcode].name.empty() ? nullptr : &table[opcode];
+}
+
+// false if the width specification is invalid, bad operands are only marked in the text
+bool decode_instruction(decode_output_t & output, const std::span < const uint8_t > input, uint64_t & offset)
+{
+    const auto * instruction = find_opcode(code_buffer_pop8(input, offset));
+    if (instruction == nullptr) {
+        return false;
+    }
+
+    output.append(instruction->name);
 
-        for (const auto &[fst, snd] : instruction_map)
+    if (instruction->requires_width_specification)
+    {
+        switch (code_buffer_pop8(input, offset))
         {
-            if (snd.at(ENTRY_OPCODE) == instruction)
-            {
-                buffer << fst;
-
-                if (snd.at(ENTRY_REQUIRE_OPERATION_WIDTH_SPECIFICATION) != 0)
-                {
-                    switch (code_buffer_pop8(input))
-                    {
-                    case _8bit_prefix:  buffer << " .8bit "; break;
-                    case _16bit_prefix: buffer << " .16bit";  break;
-                    case _32bit_prefix: buffer << " .32bit";  break;
-                    case _64bit_prefix: buffer << " .64bit";  break;
-                    default:
-                        output.emplace_back("(bad)");
-                        return;
-                    }
-                }
-
-                for (uint64_t i = 0 ; i < snd.at(ENTRY_ARGUMENT_COUNT); i++)
-                {
-                    std::vector < std::string > operands;
-                    try {
-                        decode_target(operands, input);
-                    } catch (SysdarftBaseError &) {
-                        output.emplace_back("(bad)");
-                        return;
-                    }
-
-                    buffer << " <";
-                    for (const auto & code : operands) {
-                        buffer << code;
-                    }
-                    buffer << ">";
-
-                    if (i == 0 && snd.at(ENTRY_ARGUMENT_COUNT) > 1) {
-                        buffer << ",";
-                    }
-                }
-
-                output.emplace_back(buffer.str());
-            }
+        case _8bit_prefix:  output.append(" .8bit "); break;
+        case _16bit_prefix: output.append(" .16bit");  break;
+        case _32bit_prefix: output.append(" .32bit");  break;
+        case _64bit_prefix: output.append(" .64bit");  break;
+        default: return false;
         }
-    } catch (...) {
-        output.emplace_back("(bad)");
-        return;
     }
+
+    for (uint64_t i = 0 ; i < instruction->argument_count; i++)
+    {
+        output.append(" <");
+        decode_target(output, input, offset);
+        output.append(">");
+
+        if (i == 0 && instruction->argument_count > 1) {
+            output.append(",");
+        }
+    }
+
+    return true;
+}
+
+void decode_instruction(std::string & output, const std::span < const uint8_t > input, uint64_t & offset)
+{
+    const auto begin = output.size();
+    bool decoded = false;
+    try {
+        decode_output_t text(&output);
+        decoded = decode_instruction(text, input, offset);
+    } catch (const CodeBufferEmptiedWhenPop &) {
+        // truncated instruction at the end of the buffer
+    }
+
+    if (!decoded) {
+        output.resize(begin);
+        output.append("(bad)");
+    }
+}
+
+void skip_instruction(const std::span < const uint8_t > input, uint64_t & offset)
+{
+    try {
+        decode_output_t nowhere;
+        decode_instruction(nowhere, input, offset);
+    } catch (const CodeBufferEmptiedWhenPop &) {
+        // offset already points to the end of the buffer, as it does for decode_instruction()
+    }
+}
+
+void decode_instruction(std::vector < std::string > & output, const std::span < const uint8_t > input, uint64_t & offset)
+{
+    std::string text;
+    decode_instruction(text, input, offset);
+    output.emplace_back(std::move(text));
+}
+
+void decode_instruction(std::vector < std::string > & output, std::vector<uint8_t> & input)
+{
+    uint64_t offset = 0;
+    decode_instruction(output, input, offset);
+    input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
 }
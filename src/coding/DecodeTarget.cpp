@@ -1,124 +1,155 @@
-#include <iomanip>
+#include <bit>
 #include <EncodingDecoding.h>
 #include <InstructionSet.h>
 
-void decode_constant(std::vector<std::string> & output, std::vector < uint8_t > & input)
+void decode_constant(decode_output_t & output, const std::span < const uint8_t > input, uint64_t & offset)
 {
-    std::stringstream ret;
-    const auto & prefix = code_buffer_pop<uint8_t>(input);
-
-    if (prefix == _64bit_prefix) {
-        const auto num = code_buffer_pop<uint64_t>(input);
-        ret << "$(0x" << std::hex << std::uppercase << num << ")";
-    } else if (prefix == _float_ptr_prefix) {
-        const auto num = code_buffer_pop<uint64_t>(input);
-        const double fltptr = *(double*)&num;
-        ret << "$(" << std::fixed << std::setprecision(16) << fltptr << ")";
-    } else {
-        ret << "(bad)";
+    uint64_t num;
+    switch (code_buffer_pop<uint8_t>(input, offset))
+    {
+    case _8bit_prefix:  num = code_buffer_pop<uint8_t>(input, offset); break;
+    case _16bit_prefix: num = code_buffer_pop<uint16_t>(input, offset); break;
+    case _32bit_prefix: num = code_buffer_pop<uint32_t>(input, offset); break;
+    case _64bit_prefix: num = code_buffer_pop<uint64_t>(input, offset); break;
+    case _float_ptr_prefix:
+        num = code_buffer_pop<uint64_t>(input, offset);
+        output.append("$(");
+        output.append_float(std::bit_cast<double>(num));
+        output.append(")");
+        return;
+    default:
+        output.append("(bad)");
+        return;
     }
 
-    output.emplace_back(ret.str());
+    output.append("$(0x");
+    output.append_hex(num);
+    output.append(")");
 }
 
-void decode_register(std::vector<std::string> & output, std::vector < uint8_t > & input)
+void append_register(decode_output_t & output, const uint8_t register_size, const uint8_t register_index)
 {
-    std::stringstream ret;
-    const auto register_size = code_buffer_pop<uint8_t>(input);
-    const auto register_index = code_buffer_pop<uint8_t>(input);
-
-    std::string prefix = "%";
-
     switch (register_size)
     {
-    case _8bit_prefix:  prefix += "R"; break;
-    case _16bit_prefix: prefix += "EXR"; break;
-    case _32bit_prefix: prefix += "HER"; break;
+    case _8bit_prefix:  output.append("%R"); break;
+    case _16bit_prefix: output.append("%EXR"); break;
+    case _32bit_prefix: output.append("%HER"); break;
     case _64bit_prefix:
         if (register_index <= 15) {
-            prefix += "FER";
+            output.append("%FER");
             break;
         }
 
         switch (register_index)
         {
-        case R_StackBase:       output.emplace_back("%SB"); return;
-        case R_StackPointer:    output.emplace_back("%SP"); return;
-        case R_CodeBase:        output.emplace_back("%CB"); return;
-        case R_DataBase:        output.emplace_back("%DB"); return;
-        case R_DataPointer:     output.emplace_back("%DP"); return;
-        case R_ExtendedBase:    output.emplace_back("%EB"); return;
-        case R_ExtendedPointer: output.emplace_back("%EP"); return;
-        default: output.emplace_back("(bad)"); return;
+        case R_StackBase:       output.append("%SB"); return;
+        case R_StackPointer:    output.append("%SP"); return;
+        case R_CodeBase:        output.append("%CB"); return;
+        case R_DataBase:        output.append("%DB"); return;
+        case R_DataPointer:     output.append("%DP"); return;
+        case R_ExtendedBase:    output.append("%EB"); return;
+        case R_ExtendedPointer: output.append("%EP"); return;
+        default: output.append("(bad)"); return;
         }
 
-    case _float_ptr_prefix: prefix += "XMM"; break;
-    default: output.emplace_back("(bad)"); return;
+    case _float_ptr_prefix: output.append("%XMM"); break;
+    default: output.append("(bad)"); return;
     }
 
-    ret << prefix << static_cast<int>(register_index);
-
-    output.push_back(ret.str());
+    output.append_decimal(register_index);
 }
 
-void decode_memory(std::vector<std::string> & output, std::vector < uint8_t > & input)
+void decode_register(decode_output_t & output, const std::span < const uint8_t > input, uint64_t & offset)
 {
-    std::string width, ratio;
-    std::vector<std::string> operands;
-    std::stringstream ret;
+    const auto register_size = code_buffer_pop<uint8_t>(input, offset);
+    const auto register_index = code_buffer_pop<uint8_t>(input, offset);
+    append_register(output, register_size, register_index);
+}
 
-    switch (code_buffer_pop<uint8_t>(input)) {
+void decode_memory(decode_output_t & output, const std::span < const uint8_t > input, uint64_t & offset,
+    const bool register_only)
+{
+    std::string_view width;
+    switch (code_buffer_pop<uint8_t>(input, offset)) {
     case 0x08: width = "&8"; break;
     case 0x16: width = "&16"; break;
     case 0x32: width = "&32"; break;
     case 0x64: width = "&64"; break;
-    default: output.emplace_back("(bad)"); return;
+    default: output.append("(bad)"); return;
     }
 
-    auto decode_each_parameter = [&operands, &input]()->bool
+    // the ratio comes last in the encoding but first in the text, decode the parameters aside
+    std::string parameters_text;
+    decode_output_t parameters(output.formatting() ? &parameters_text : nullptr);
+    for (int i = 0; i < 3; i++)
     {
-        switch(code_buffer_pop<uint8_t>(input))
-        {
-        case REGISTER_PREFIX: decode_register(operands, input); break;
-        case CONSTANT_PREFIX: decode_constant(operands, input); break;
-        default: operands.emplace_back("(bad)"); return false;
+        if (i != 0) {
+            parameters.append(", ");
         }
 
-        return true;
-    };
+        if (register_only)
+        {
+            if (const auto index = code_buffer_pop<uint8_t>(input, offset); index == MEMORY_ZERO_PARAMETER) {
+                parameters.append("$(0x0)");
+            } else {
+                append_register(parameters, _64bit_prefix, index);
+            }
+            continue;
+        }
 
-    if (!decode_each_parameter()) { return; }
-    operands.emplace_back(", ");
-    if (!decode_each_parameter()) { return; }
-    operands.emplace_back(", ");
-    if (!decode_each_parameter()) { return; }
-    operands.emplace_back(")");
+        switch (code_buffer_pop<uint8_t>(input, offset))
+        {
+        case REGISTER_PREFIX: decode_register(parameters, input, offset); break;
+        case CONSTANT_PREFIX: decode_constant(parameters, input, offset); break;
+        default: output.append("(bad)"); return;
+        }
+    }
 
-    switch (code_buffer_pop<uint8_t>(input))
+    switch (code_buffer_pop<uint8_t>(input, offset))
     {
-    case 0x01: ratio = "*1";  break;
-    case 0x02: ratio = "*2";  break;
-    case 0x04: ratio = "*4";  break;
-    case 0x08: ratio = "*8";  break;
-    case 0x16: ratio = "*16"; break;
-    default: output.emplace_back("(bad)"); return;
+    case 0x01: output.append("*1");  break;
+    case 0x02: output.append("*2");  break;
+    case 0x04: output.append("*4");  break;
+    case 0x08: output.append("*8");  break;
+    case 0x16: output.append("*16"); break;
+    default: output.append("(bad)"); return;
     }
 
-    ret << ratio <<  width;
-    for (const auto & operand : operands) {
-        ret << operand;
+    output.append(width);
+    output.append("(");
+    output.append(parameters_text);
+    output.append(")");
+}
+
+void decode_target(decode_output_t & output, const std::span < const uint8_t > input, uint64_t & offset)
+{
+    switch (code_buffer_pop<uint8_t>(input, offset))
+    {
+    case REGISTER_PREFIX: decode_register(output, input, offset); break;
+    case CONSTANT_PREFIX: decode_constant(output, input, offset); break;
+    case MEMORY_PREFIX: decode_memory(output, input, offset, false); break;
+    case MEMORY_REGISTER_PREFIX: decode_memory(output, input, offset, true); break;
+    default: output.append("(bad)");
     }
+}
 
-    output.push_back(ret.str());
+void decode_target(std::vector<std::string> & output, const std::span < const uint8_t > input, uint64_t & offset)
+{
+    std::string text;
+    decode_output_t target(&text);
+    decode_target(target, input, offset);
+    output.emplace_back(std::move(text));
 }
 
 void decode_target(std::vector<std::string> & output, std::vector < uint8_t > & input)
 {
-    switch (code_buffer_pop<uint8_t>(input))
-    {
-    case REGISTER_PREFIX: decode_register(output, input); break;
-    case CONSTANT_PREFIX: decode_constant(output, input); break;
-    case MEMORY_PREFIX: decode_memory(output, input); break;
-    default: output.emplace_back("(bad)");
+    uint64_t offset = 0;
+    try {
+        decode_target(output, input, offset);
+    } catch (...) {
+        input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
+        throw;
     }
+
+    input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
 }
@@ -1,151 +1,168 @@
+#include <algorithm>
 #include <vector>
-#include <regex>
-#include <iomanip>
+#include <cctype>
+#include <unordered_map>
 #include <EncodingDecoding.h>
 #include <SysdarftDebug.h>
 #include <InstructionSet.h>
 
-std::regex target_pattern(R"(<\s*(?:\*\s*(?:1|2|4|8|16)\&(8|16|32|64)\s*\([^,]+,[^,]+,[^,]+\)|%(?:R|EXR|HER)[0-7]|%(FER)([\d]+)|%(SB|SP|CB|DB|DP|EB|EP)|%XMM[0-5]|\$\s*\(\s*(?:0[xX][A-Fa-f0-9]+|\s|[+\-.',*\/^%()xX0-9-])+\s*\))\s*>)");
-std::regex instruction_pattern(R"(([A-Z]+))");
-std::regex operation_width(R"(.8BIT|.16BIT|.32BIT|.64BIT)");
-
-class InstructionExpressionError final : public SysdarftBaseError {
-public:
-    explicit InstructionExpressionError(const std::string& message) :
-        SysdarftBaseError("Instruction Expression Error: " + message) { }
+struct instruction_entry_t
+{
+    uint8_t opcode;
+    uint64_t argument_count;
+    bool requires_width_specification;
 };
 
-std::vector<std::string> clean_line(const std::string & _input)
+// instruction_map flattened once, keyed by views of its (uppercase) names
+const instruction_entry_t * find_instruction(const std::string_view mnemonic)
 {
-    std::vector<std::string> ret;
-    std::string input = _input;
-
-    // capitalize the whole string
-    capitalization(input);
-
-    if (std::smatch matches; std::regex_search(input, matches, instruction_pattern)) {
-        auto match = matches[0].str();
-        ret.emplace_back(remove_space(match));
-    } else {
-        throw InstructionExpressionError("No match for instruction in " + input);
-    }
+    static const auto table = []
+    {
+        std::unordered_map < std::string_view, instruction_entry_t > ret;
+        for (const auto & [name, entry] : instruction_map)
+        {
+            ret.emplace(name, instruction_entry_t {
+                .opcode = static_cast<uint8_t>(entry.at(ENTRY_OPCODE)),
+                .argument_count = entry.at(ENTRY_ARGUMENT_COUNT),
+                .requires_width_specification = entry.at(ENTRY_REQUIRE_OPERATION_WIDTH_SPECIFICATION) != 0,
+            });
+        }
+        return ret;
+    }();
 
-    if (std::smatch matches; std::regex_search(input, matches, operation_width)) {
-        auto match = matches[0].str();
-        ret.emplace_back(remove_space(match));
+    char upper[16];
+    if (mnemonic.size() > sizeof(upper)) {
+        return nullptr;
     }
 
-    // Create iterators to traverse all matches
-    const auto matches_begin = std::sregex_iterator(input.begin(), input.end(), target_pattern);
-    const auto matches_end = std::sregex_iterator();
-
-    // Iterate over all matches and process them
-    for (std::sregex_iterator i = matches_begin; i != matches_end; ++i)
-    {
-        auto match = i->str();
-        ret.emplace_back(remove_space(match));
+    for (std::size_t i = 0; i < mnemonic.size(); i++) {
+        upper[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(mnemonic[i])));
     }
 
-    return ret;
+    const auto it = table.find(std::string_view(upper, mnemonic.size()));
+    return it == table.end() ? nullptr : &it->second;
 }
 
-uint8_t encode_width_specifier(std::vector<uint8_t> &buffer, const std::string & specifier)
+void encode_lexed_instruction(uint8_t *& output, const lexed_instruction_t & lexed,
+    const std::string_view instruction, const symbol_resolver_t & resolver, const encoding_mode_t mode)
 {
-    if (specifier == ".8BIT")  { code_buffer_push8(buffer, _8bit_prefix);  return _8bit_prefix;  }
-    if (specifier == ".16BIT") { code_buffer_push8(buffer, _16bit_prefix); return _16bit_prefix; }
-    if (specifier == ".32BIT") { code_buffer_push8(buffer, _32bit_prefix); return _32bit_prefix; }
-    if (specifier == ".64BIT") { code_buffer_push8(buffer, _64bit_prefix); return _64bit_prefix; }
-
-    throw InstructionExpressionError("Unknown specifier " + specifier);
-}
+    auto error = [&instruction](const std::string & reason, const std::size_t column)
+    {
+        throw InstructionExpressionError(reason + " at column " + std::to_string(column)
+            + ": " + std::string(instruction));
+    };
 
-void SYSDARFT_EXPORT_SYMBOL encode_instruction(std::vector<uint8_t> & buffer, const std::string & instruction)
-{
-    const auto cleaned_line = clean_line(instruction);
-    if (!instruction_map.contains(cleaned_line[0])) {
-        throw InstructionExpressionError("Illegal instruction " + instruction);
+    const auto * entry = find_instruction(lexed.Mnemonic);
+    if (entry == nullptr) {
+        error("Illegal instruction " + std::string(lexed.Mnemonic), lexed.MnemonicColumn);
     }
 
-    const auto & instruction_name = cleaned_line[0];
-    const auto & argument_count = instruction_map.at(cleaned_line[0]).at(ENTRY_ARGUMENT_COUNT);
-    const auto & requires_width_specification =
-        instruction_map.at(cleaned_line[0]).at(ENTRY_REQUIRE_OPERATION_WIDTH_SPECIFICATION);
-
-    int operand_index_begin = 1;
-    uint8_t current_ops_width = 0;
-
-    code_buffer_push8(buffer, instruction_map.at(instruction_name).at(ENTRY_OPCODE));
-    if (requires_width_specification != 0)
+    code_buffer_store<uint8_t>(output, entry->opcode);
+    if (entry->requires_width_specification)
     {
-        if (cleaned_line.size() < 2) {
-            throw InstructionExpressionError("Width specification required but not found for " + instruction);
+        if (lexed.Width == 0) {
+            error("Width specification required but not found", lexed.MnemonicColumn + lexed.Mnemonic.size());
         }
 
-        try {
-            current_ops_width = encode_width_specifier(buffer, cleaned_line[1]);
-        } catch (const InstructionExpressionError & /* Err */) {
-            throw InstructionExpressionError("Illegal width specification for " + instruction);
-        }
+        code_buffer_store<uint8_t>(output, lexed.Width);
+    } else if (lexed.Width != 0) {
+        error("Illegal width specification", lexed.WidthColumn);
+    }
 
-        operand_index_begin++;
+    if (lexed.Operands.size() != entry->argument_count) {
+        error("Expected " + std::to_string(entry->argument_count) + ", but found "
+            + std::to_string(lexed.Operands.size()) + " operands", lexed.MnemonicColumn);
     }
 
-    for (uint64_t i = 0; i  < argument_count; i++)
+    for (const auto & operand : lexed.Operands)
     {
-        if (cleaned_line.size() - operand_index_begin < argument_count) {
-            throw InstructionExpressionError(
-                "Expected " + std::to_string(argument_count) +
-                        ", but found " + std::to_string(cleaned_line.size() - operand_index_begin) +
-                        ": " + instruction);
+        try {
+            encode_operand(output, operand, resolver, mode);
+        } catch (const SysdarftCodeExpressionError & Err) {
+            throw InstructionExpressionError("Illegal Target operand expression at column "
+                + std::to_string(operand.Column) + " for " + std::string(instruction) +
+                "\n>>>\n" + Err.what() + "<<<\n");
         }
 
-        auto tmp = cleaned_line[i + operand_index_begin];
+        // width consistency check
+        if (lexed.Width != 0 && operand.TargetType == lexed_target_t::REGISTER
+            && operand.RegisterWidth != lexed.Width)
+        {
+            error("Operation width mismatch", operand.Column);
+        }
+    }
+}
 
-        // remove < >
-        tmp.erase(tmp.begin());
-        tmp.pop_back();
+void encode_lexed_instruction(std::vector<uint8_t> & buffer, const lexed_instruction_t & lexed,
+    const std::string_view instruction, const symbol_resolver_t & resolver, const encoding_mode_t mode)
+{
+    const auto begin = buffer.size();
+    buffer.resize(begin + encoded_instruction_size(lexed, mode));
+    try {
+        auto * output = buffer.data() + begin;
+        encode_lexed_instruction(output, lexed, instruction, resolver, mode);
+    } catch (...) {
+        buffer.resize(begin);
+        throw;
+    }
+}
 
-        // encode
-        parsed_target_t parsed_target;
+uint64_t encoded_instruction_size(const lexed_instruction_t & lexed, const encoding_mode_t mode)
+{
+    uint64_t size = lexed.Width == 0 ? 1 : 2;
+    for (const auto & operand : lexed.Operands) {
+        size += encoded_operand_size(operand, mode);
+    }
 
-        try {
-            parsed_target = encode_target(buffer, tmp);
-        } catch (const SysdarftCodeExpressionError & Err) {
-            throw InstructionExpressionError("Illegal Target operand expression for " + instruction +
-                "\n>>>\n" + Err.what() + "<<<\n");
-        }
+    return size;
+}
 
-        auto assertion = [&instruction](const bool & condition) {
-            if (!condition) {
-                throw InstructionExpressionError("Operation width mismatch for " + instruction);
-            }
-        };
+void SYSDARFT_EXPORT_SYMBOL encode_instruction(std::vector<uint8_t> & buffer, const std::string & instruction,
+    const encoding_mode_t mode)
+{
+    lexed_instruction_t lexed;
+    lex_instruction(instruction, lexed);
+    encode_lexed_instruction(buffer, lexed, instruction, nullptr, mode);
+}
 
-        // width consistency check
-        if (current_ops_width != 0)
+void encode_instructions(std::vector<uint8_t> & buffer, const std::span < const std::string_view > lines,
+    encoding_arena_t & arena, std::vector < uint64_t > & offsets, const symbol_resolver_t & resolver,
+    const encoding_mode_t mode)
+{
+    const auto buffer_size = buffer.size();
+    const auto offsets_size = offsets.size();
+    offsets.reserve(offsets_size + lines.size() + 1);
+    if (const auto needed = std::min(lines.size(), encoding_arena_t::block_lines); arena.instructions.size() < needed) {
+        arena.instructions.resize(needed);
+    }
+
+    try
+    {
+        for (std::size_t first = 0; first < lines.size(); first += encoding_arena_t::block_lines)
         {
-            if (parsed_target.TargetType == parsed_target_t::REGISTER)
+            const auto block = lines.subspan(first, std::min(encoding_arena_t::block_lines, lines.size() - first));
+
+            // lex the block and size it, so the buffer grows once per block
+            uint64_t end = buffer.size();
+            for (std::size_t i = 0; i < block.size(); i++)
             {
-                switch (current_ops_width)
-                {
-                    case _8bit_prefix:  assertion(parsed_target.RegisterName[1] == 'R'); break;
-                    case _16bit_prefix: assertion(parsed_target.RegisterName[1] == 'E'); break;
-                    case _32bit_prefix: assertion(parsed_target.RegisterName[1] == 'H'); break;
-                    case _64bit_prefix: assertion(
-                        parsed_target.RegisterName[1] == 'F'
-                        || parsed_target.RegisterName == "%SB"
-                        || parsed_target.RegisterName == "%SP"
-                        || parsed_target.RegisterName == "%CB"
-                        || parsed_target.RegisterName == "%DB"
-                        || parsed_target.RegisterName == "%DP"
-                        || parsed_target.RegisterName == "%EB"
-                        || parsed_target.RegisterName == "%EP");
-                    break;
-
-                    // it should never reach this:
-                    default: throw InstructionExpressionError("Unknown error for " + instruction);
-                }
+                lex_instruction(block[i], arena.instructions[i]);
+                offsets.push_back(end);
+                end += encoded_instruction_size(arena.instructions[i], mode);
+            }
+
+            const auto begin = buffer.size();
+            buffer.resize(end);
+            auto * output = buffer.data() + begin;
+            for (std::size_t i = 0; i < block.size(); i++) {
+                encode_lexed_instruction(output, arena.instructions[i], block[i], resolver, mode);
             }
         }
+    } catch (...) {
+        buffer.resize(buffer_size);
+        offsets.resize(offsets_size);
+        throw;
     }
+
+    offsets.push_back(buffer.size());
 }
@@ -1,332 +1,257 @@
-#include <iostream>
+#include <algorithm>
 #include <string>
 #include <vector>
-#include <regex>
-#include <thread>
 #include <cstdint>
-#include <cctype>
-#include <iomanip>
-#include <charconv>
-#include <optional>
-#include <system_error>
 #include <EncodingDecoding.h>
 #include <SysdarftDebug.h>
 
-// Define regex patterns
-const std::regex register_pattern(R"(^%(R|EXR|HER)[0-7]|%(FER)([\d]+)|^%(SB|SP|CB|DB|DP|EB|EP)|^%XMM[0-5]$)");
-const std::regex constant_pattern(R"(^\$\((.*)\)$)");
-const std::regex memory_pattern(R"(^\*(1|2|4|8|16)\&(8|16|32|64)\(([^,]+),([^,]+),([^,]+)\)$)");
-const std::regex base16_pattern(R"(0x[0-9A-Fa-f]+)");
-
-bool is_valid_register(const std::string& input) {
-    return std::regex_match(input, register_pattern);
-}
-
-bool is_valid_constant(const std::string& input) {
-    return std::regex_match(input, constant_pattern);
-}
-
-bool is_valid_memory(const std::string& input) {
-    return std::regex_match(input, memory_pattern);
-}
-
-parsed_target_t parse(std::string input)
+std::string register_name(const uint8_t width, const uint8_t index)
 {
-    // remove all spaces in input source
-    remove_space(input);
-    // capitalize all character
-    capitalization(input);
-
-    parsed_target_t result { };
-
-    // if it is a register
-    if (is_valid_register(input))
-    {
-        result.RegisterName = input;
-        result.TargetType = parsed_target_t::REGISTER;
-        return result;
-    }
-    else if (is_valid_constant(input))
+    if (width == _64bit_prefix && index > 15)
     {
-        result.ConstantExpression = input;
-        result.TargetType = parsed_target_t::CONSTANT;
-        return result;
-    }
-    else if (is_valid_memory(input))
-    {
-        if (std::smatch matches; std::regex_search(input, matches, memory_pattern))
+        switch (index)
         {
-            if (matches.size() != 6) {
-                throw SysdarftCodeExpressionError(input);
-            }
-
-            result.TargetType = parsed_target_t::MEMORY;
-            result.memory.MemoryAccessRatio = matches[1].str();
-            result.memory.MemoryWidth       = matches[2].str();
-            result.memory.MemoryBaseAddress = matches[3].str();
-            result.memory.MemoryOffset1 = matches[4].str();
-            result.memory.MemoryOffset2 = matches[5].str();
-            return result;
+        case R_StackBase:       return "%SB";
+        case R_StackPointer:    return "%SP";
+        case R_CodeBase:        return "%CB";
+        case R_DataBase:        return "%DB";
+        case R_DataPointer:     return "%DP";
+        case R_ExtendedBase:    return "%EB";
+        case R_ExtendedPointer: return "%EP";
+        default: throw SysdarftCodeExpressionError("Unknown register index " + std::to_string(index));
         }
-    } else {
-        throw SysdarftCodeExpressionError(input);
     }
 
-    return result;
+    switch (width)
+    {
+    case _8bit_prefix:      return "%R"   + std::to_string(index);
+    case _16bit_prefix:     return "%EXR" + std::to_string(index);
+    case _32bit_prefix:     return "%HER" + std::to_string(index);
+    case _64bit_prefix:     return "%FER" + std::to_string(index);
+    case _float_ptr_prefix: return "%XMM" + std::to_string(index);
+    default: throw SysdarftCodeExpressionError("Unknown register width " + std::to_string(width));
+    }
 }
 
-void process_base16(std::string & input)
+void encode_register(uint8_t *& output, const lexed_target_t & input)
 {
-    std::vector < std::pair < std::string, uint64_t > > data;
-    auto replace_all = [&input](const std::string & target, const std::string & replacement)
-    {
-        if (target.empty()) return; // Avoid infinite loop if target is empty
-
-        size_t pos = 0;
-        while ((pos = input.find(target, pos)) != std::string::npos) {
-            input.replace(pos, target.length(), replacement);
-            pos += replacement.length(); // Move past the replacement to avoid infinite loop
-        }
-    };
-
-    // fix the uppercase conversion
-    replace_all("0X", "0x");
-
-    // Create iterators to traverse all matches
-    const auto matches_begin = std::sregex_iterator(input.begin(), input.end(), base16_pattern);
-    const auto matches_end = std::sregex_iterator();
+    code_buffer_store<uint8_t>(output, REGISTER_PREFIX);
+    code_buffer_store<uint8_t>(output, input.RegisterWidth);
+    code_buffer_store<uint8_t>(output, input.RegisterIndex);
+}
 
-    // Iterate over all matches and process them
-    for (std::sregex_iterator i = matches_begin; i != matches_end; ++i)
+// Value of a constant made of literals only, false if it uses symbols or is not an integer
+bool literal_integer(const std::string_view expression, uint64_t & value)
+{
+    bool symbolic = false;
+    try
     {
-        const std::smatch& match = *i;
-        std::string base16_number_str = match.str();
-
-        // Convert the hexadecimal string to an unsigned 64-bit integer
-        uint64_t number = strtoull(base16_number_str.c_str(), nullptr, 16);
-
-        // Store the pair in the data vector
-        data.emplace_back(base16_number_str, number);
+        const auto result = evaluate_constant_expression(expression,
+            [&symbolic](std::string_view, constant_value_t & symbol) -> bool {
+                symbolic = true;
+                symbol = { };
+                return true;
+            });
+
+        value = constant_value_to_operand(result);
+        return !symbolic && result.ValueType == constant_value_t::INTEGER;
+    } catch (const SysdarftBaseError &) {
+        // malformed, reported when the constant is encoded
+        return false;
     }
+}
 
-    for (const auto & [tag, rep] : data) {
-        replace_all(tag, std::to_string(rep));
-    }
+// width prefix of the smallest compact immediate holding value
+uint8_t compact_constant_width(const uint64_t value)
+{
+    if (value <= UINT8_MAX) return _8bit_prefix;
+    if (value <= UINT16_MAX) return _16bit_prefix;
+    if (value <= UINT32_MAX) return _32bit_prefix;
+    return _64bit_prefix;
 }
 
-std::string execute_bc(const std::string& input)
+uint64_t compact_constant_size(const uint8_t width)
 {
-    std::stringstream cmd;
-    cmd << "echo \"" << input << "\" | bc";
-    const auto result = debug::exec_command("bash", "-c", cmd.str().c_str());
-    auto cmd_str = cmd.str();
-    if (result.exit_status != 0) {
-        throw SysdarftCodeExpressionError(input + " failed, exit: " + std::to_string(result.exit_status) + ": " + result.fd_stderr);
+    switch (width)
+    {
+    case _8bit_prefix:  return 1;
+    case _16bit_prefix: return 2;
+    case _32bit_prefix: return 4;
+    default:            return 8;
     }
-
-    return result.fd_stdout;
 }
 
-// Function to extract trailing digits and convert to uint32_t
-std::optional<uint32_t> extractTrailingNumber(const std::string& input)
+// memory operands with only 64bit registers and literal zeros have a compact form
+bool register_only_memory(const lexed_operand_t & input)
 {
-    // Step 1: Find the position where trailing digits start
-    size_t pos = input.size();
-    while (pos > 0 && std::isdigit(static_cast<unsigned char>(input[pos - 1]))) {
-        --pos;
-    }
+    return std::ranges::all_of(input.MemoryParameters, [](const lexed_target_t & parameter)
+    {
+        uint64_t value;
+        return parameter.TargetType == lexed_target_t::REGISTER
+            || (literal_integer(parameter.ConstantExpression, value) && value == 0);
+    });
+}
 
-    // If no digits are found at the end, return std::nullopt
-    if (pos == input.size()) {
-        return std::nullopt;
+void encode_constant(uint8_t *& output, const lexed_target_t & input, const symbol_resolver_t & resolver,
+    const encoding_mode_t mode)
+{
+    bool symbolic = false;
+    const auto result = evaluate_constant_expression(input.ConstantExpression,
+        [&symbolic, &resolver](const std::string_view name, constant_value_t & value) -> bool {
+            symbolic = true;
+            return resolver && resolver(name, value);
+        });
+    const uint64_t operand = constant_value_to_operand(result);
+
+    code_buffer_store<uint8_t>(output, CONSTANT_PREFIX);
+    if (result.ValueType == constant_value_t::FLOAT) {
+        code_buffer_store<uint8_t>(output, _float_ptr_prefix);
+        code_buffer_store<uint64_t>(output, operand);
+        return;
     }
 
-    // Step 2: Extract the trailing number substring
-    const std::string numberStr = input.substr(pos);
-
-    // Step 3: Convert the substring to uint32_t using std::from_chars
-    uint32_t number = 0;
-
-    // Step 4: Handle potential errors
-    if (auto [ptr, ec] = std::from_chars(
-        numberStr.data(),
-        numberStr.data() + numberStr.size(),
-        number);
-        ec == std::errc())
+    const uint8_t width = mode == COMPACT_ENCODING && !symbolic ? compact_constant_width(operand) : _64bit_prefix;
+    code_buffer_store<uint8_t>(output, width);
+    switch (width)
     {
-        return number;
-    } else {
-        // Conversion failed (e.g., overflow or invalid input)
-        return std::nullopt;
+    case _8bit_prefix:  code_buffer_store<uint8_t>(output, static_cast<uint8_t>(operand)); break;
+    case _16bit_prefix: code_buffer_store<uint16_t>(output, static_cast<uint16_t>(operand)); break;
+    case _32bit_prefix: code_buffer_store<uint32_t>(output, static_cast<uint32_t>(operand)); break;
+    default:            code_buffer_store<uint64_t>(output, operand); break;
     }
 }
 
-void encode_register(std::vector<uint8_t> & buffer, const parsed_target_t & input)
+void encode_memory(uint8_t *& output, const lexed_operand_t & input, const symbol_resolver_t & resolver,
+    const encoding_mode_t mode)
 {
-    const auto register_index =  extractTrailingNumber(input.RegisterName).has_value() ?
-        extractTrailingNumber(input.RegisterName).value() : 0;
-    code_buffer_push8(buffer, REGISTER_PREFIX);
+    if (mode == COMPACT_ENCODING && register_only_memory(input))
+    {
+        code_buffer_store<uint8_t>(output, MEMORY_REGISTER_PREFIX);
+        code_buffer_store<uint8_t>(output, input.MemoryWidth);
+        for (const auto & parameter : input.MemoryParameters) {
+            code_buffer_store<uint8_t>(output, parameter.TargetType == lexed_target_t::REGISTER
+                ? parameter.RegisterIndex : MEMORY_ZERO_PARAMETER);
+        }
 
-    if (input.RegisterName == "%SB") {
-        code_buffer_push8(buffer, _64bit_prefix);
-        code_buffer_push8(buffer, R_StackBase);
+        code_buffer_store<uint8_t>(output, input.MemoryAccessRatio);
         return;
     }
 
-    if (input.RegisterName == "%SP") {
-        code_buffer_push8(buffer, _64bit_prefix);
-        code_buffer_push8(buffer, R_StackPointer);
-        return;
-    }
+    code_buffer_store<uint8_t>(output, MEMORY_PREFIX);
+    code_buffer_store<uint8_t>(output, input.MemoryWidth);
 
-    if (input.RegisterName == "%CB") {
-        code_buffer_push8(buffer, _64bit_prefix);
-        code_buffer_push8(buffer, R_CodeBase);
-        return;
+    for (const auto & parameter : input.MemoryParameters)
+    {
+        if (parameter.TargetType == lexed_target_t::REGISTER) {
+            encode_register(output, parameter);
+        } else {
+            encode_constant(output, parameter, resolver, mode);
+        }
     }
 
-    if (input.RegisterName == "%DB") {
-        code_buffer_push8(buffer, _64bit_prefix);
-        code_buffer_push8(buffer, R_DataBase);
-        return;
-    }
+    // Ratio. Ratio is a 8bit packed BCD code
+    code_buffer_store<uint8_t>(output, input.MemoryAccessRatio);
+}
 
-    if (input.RegisterName == "%DP") {
-        code_buffer_push8(buffer, _64bit_prefix);
-        code_buffer_push8(buffer, R_DataPointer);
-        return;
+void encode_operand(uint8_t *& output, const lexed_operand_t & input, const symbol_resolver_t & resolver,
+    const encoding_mode_t mode)
+{
+    switch (input.TargetType)
+    {
+    case lexed_target_t::REGISTER: encode_register(output, input); break;
+    case lexed_target_t::CONSTANT: encode_constant(output, input, resolver, mode); break;
+    case lexed_target_t::MEMORY:   encode_memory(output, input, resolver, mode); break;
+    default: throw SysdarftCodeExpressionError("Invalid operand at column " + std::to_string(input.Column));
     }
+}
 
-    if (input.RegisterName == "%EB") {
-        code_buffer_push8(buffer, _64bit_prefix);
-        code_buffer_push8(buffer, R_ExtendedBase);
-        return;
+void encode_operand(std::vector<uint8_t> & buffer, const lexed_operand_t & input, const symbol_resolver_t & resolver,
+    const encoding_mode_t mode)
+{
+    const auto begin = buffer.size();
+    buffer.resize(begin + encoded_operand_size(input, mode));
+    try {
+        auto * output = buffer.data() + begin;
+        encode_operand(output, input, resolver, mode);
+    } catch (...) {
+        buffer.resize(begin);
+        throw;
     }
+}
 
-    if (input.RegisterName == "%EP") {
-        code_buffer_push8(buffer, _64bit_prefix);
-        code_buffer_push8(buffer, R_ExtendedPointer);
-        return;
-    }
+uint64_t encoded_target_size(const lexed_target_t & input, const encoding_mode_t mode)
+{
+    constexpr uint64_t register_size = 3;   // prefix, width, index
 
-    switch (input.RegisterName[1])
+    switch (input.TargetType)
     {
-    case 'R' : /* 8bit Register */  code_buffer_push8(buffer,  _8bit_prefix); code_buffer_push8(buffer, register_index); return;
-    case 'E' : /* 16bit Register */ code_buffer_push8(buffer, _16bit_prefix); code_buffer_push8(buffer, register_index); return;
-    case 'H' : /* 32bit Register */ code_buffer_push8(buffer, _32bit_prefix); code_buffer_push8(buffer, register_index); return;
-    case 'F' : /* 64bit Register */ code_buffer_push8(buffer, _64bit_prefix); code_buffer_push8(buffer, register_index); return;
-    case 'X' : /* floating-point Register */ code_buffer_push8(buffer, _float_ptr_prefix); code_buffer_push8(buffer, register_index); return;
-    default: throw SysdarftCodeExpressionError("Unknown register " + input.RegisterName);
+    case lexed_target_t::REGISTER: return register_size;
+    case lexed_target_t::CONSTANT:
+    {
+        // prefix, width, value
+        uint64_t value;
+        if (mode == COMPACT_ENCODING && literal_integer(input.ConstantExpression, value)) {
+            return 2 + compact_constant_size(compact_constant_width(value));
+        }
+        return 2 + sizeof(uint64_t);
+    }
+    default: throw SysdarftCodeExpressionError("Invalid operand at column " + std::to_string(input.Column));
     }
 }
 
-void encode_constant(std::vector<uint8_t> & buffer, const parsed_target_t & input)
+uint64_t encoded_operand_size(const lexed_operand_t & input, const encoding_mode_t mode)
 {
-    auto tmp = input.ConstantExpression;
-
-    if (tmp.size() <= 2) {
-        throw SysdarftCodeExpressionError(input.ConstantExpression);
+    if (input.TargetType != lexed_target_t::MEMORY) {
+        return encoded_target_size(input, mode);
     }
 
-    // remove last '('
-    tmp.pop_back();
-    // remove '$('
-    tmp.erase(tmp.begin());
-    tmp.erase(tmp.begin());
-
-    // replace base 16 value to base 10 value
-    process_base16(tmp);
-
-    code_buffer_push8(buffer, CONSTANT_PREFIX);
-    const auto result_from_bc = execute_bc(tmp);
-
-    if (result_from_bc.contains('.')) {
-        code_buffer_push8(buffer, _float_ptr_prefix);
-        const double result = strtod(result_from_bc.c_str(), nullptr);
-        code_buffer_push<64>(buffer, &result);
-    } else {
-        code_buffer_push8(buffer, _64bit_prefix);
-        const __int128_t result = strtoull(result_from_bc.c_str(), nullptr, 10);
-        code_buffer_push<64>(buffer, &result);
+    if (mode == COMPACT_ENCODING && register_only_memory(input)) {
+        return 6; // prefix, width, three indexes, ratio
     }
-}
 
-void encode_memory_width_prefix(std::vector<uint8_t> & buffer, const std::string & input)
-{
-    if (input == "8") { code_buffer_push8(buffer, _8bit_prefix); return;}
-    else if (input == "16") { code_buffer_push8(buffer, _16bit_prefix); return;}
-    else if (input == "32") { code_buffer_push8(buffer, _32bit_prefix); return;}
-    else if (input == "64") { code_buffer_push8(buffer, _64bit_prefix); return;}
-    else { throw SysdarftCodeExpressionError(input); }
+    uint64_t size = 3; // prefix, width, ratio
+    for (const auto & parameter : input.MemoryParameters) {
+        size += encoded_target_size(parameter, mode);
+    }
+    return size;
 }
 
-void encode_memory(std::vector<uint8_t> & buffer, const parsed_target_t & input)
+parsed_target_t encode_target(std::vector<uint8_t> & buffer, const std::string& input)
 {
-    code_buffer_push8(buffer, MEMORY_PREFIX);
+    const auto lexed = lex_operand(input);
+    encode_operand(buffer, lexed);
 
-    auto encode_each_parameter = [&buffer](const std::string & param)
+    auto literal = [](const lexed_target_t & target) -> std::string
     {
-        if (is_valid_register(param))
-        {
-            auto tmp = param;
-            while (std::isdigit(tmp.back())) {
-                tmp.pop_back();
-            }
-
-            // Not a 64bit register
-            if (tmp != "%FER" && param != "%SP" && param != "%DP" && param != "%ESP") {
-                throw SysdarftCodeExpressionError("Not a 64bit Register: " + param);
-            }
-
-            encode_register(buffer,
-                parsed_target_t {
-                    .TargetType = parsed_target_t::REGISTER,
-                    .RegisterName = param }
-            );
+        if (target.TargetType == lexed_target_t::REGISTER) {
+            return register_name(target.RegisterWidth, target.RegisterIndex);
         }
-        else if (is_valid_constant(param))
-        {
-            encode_constant(buffer, parsed_target_t {
-                    .TargetType = parsed_target_t::CONSTANT,
-                    .ConstantExpression = param }
-            );
-        } else {
-            throw SysdarftCodeExpressionError(param);
-        }
-    };
-
-    encode_memory_width_prefix(buffer, input.memory.MemoryWidth);
-    encode_each_parameter(input.memory.MemoryBaseAddress);
-    encode_each_parameter(input.memory.MemoryOffset1);
-    encode_each_parameter(input.memory.MemoryOffset2);
-
-    // Ratio. Ratio is a 8bit packed BCD code
-    if (input.memory.MemoryAccessRatio == "1") {
-        code_buffer_push8(buffer, 0x01);
-    } else if (input.memory.MemoryAccessRatio == "2") {
-        code_buffer_push8(buffer, 0x02);
-    } else if (input.memory.MemoryAccessRatio == "4") {
-        code_buffer_push8(buffer, 0x04);
-    } else if (input.memory.MemoryAccessRatio == "8") {
-        code_buffer_push8(buffer, 0x08);
-    } else if (input.memory.MemoryAccessRatio == "16") {
-        code_buffer_push8(buffer, 0x16);
-    }
-}
 
-parsed_target_t encode_target(std::vector<uint8_t> & buffer, const std::string& input)
-{
-    const auto parsed = parse(input);
+        return "$(" + std::string(target.ConstantExpression) + ")";
+    };
 
-    if (parsed.TargetType == parsed_target_t::REGISTER)
+    parsed_target_t parsed { };
+    switch (lexed.TargetType)
     {
-        encode_register(buffer, parsed);
-    } else if (parsed.TargetType == parsed_target_t::CONSTANT) {
-        encode_constant(buffer, parsed);
-    } else if (parsed.TargetType == parsed_target_t::MEMORY) {
-        encode_memory(buffer, parsed);
-    } else {
-        throw SysdarftCodeExpressionError(input);
+    case lexed_target_t::REGISTER:
+        parsed.TargetType = parsed_target_t::REGISTER;
+        parsed.RegisterName = literal(lexed);
+        break;
+    case lexed_target_t::CONSTANT:
+        parsed.TargetType = parsed_target_t::CONSTANT;
+        parsed.ConstantExpression = literal(lexed);
+        break;
+    case lexed_target_t::MEMORY:
+        parsed.TargetType = parsed_target_t::MEMORY;
+        parsed.memory.MemoryAccessRatio = lexed.MemoryAccessRatio == 0x16 ? "16" : std::to_string(lexed.MemoryAccessRatio);
+        parsed.memory.MemoryWidth       = std::to_string(lexed.MemoryWidth == _8bit_prefix ? 8
+                                        : lexed.MemoryWidth == _16bit_prefix ? 16
+                                        : lexed.MemoryWidth == _32bit_prefix ? 32 : 64);
+        parsed.memory.MemoryBaseAddress = literal(lexed.MemoryParameters[0]);
+        parsed.memory.MemoryOffset1     = literal(lexed.MemoryParameters[1]);
+        parsed.memory.MemoryOffset2     = literal(lexed.MemoryParameters[2]);
+        break;
+    default: throw SysdarftCodeExpressionError(input);
     }
 
     return parsed;
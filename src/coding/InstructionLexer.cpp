@@ -0,0 +1,354 @@
+#include <string>
+#include <string_view>
+#include <cctype>
+#include <EncodingDecoding.h>
+
+// Single pass lexer for one line of assembly:
+//
+//   MNEMONIC [.8bit|.16bit|.32bit|.64bit] [<operand> [, <operand>]...]
+//
+//   operand   := register | constant | memory
+//   register  := %R0-7 | %EXR0-7 | %HER0-7 | %FER0-15 | %XMM0-5 | %SB | %SP | %CB | %DB | %DP | %EB | %EP
+//   constant  := $( expression )
+//   memory    := *ratio&width( parameter, parameter, parameter )
+//   parameter := 64bit register | constant
+//
+// Everything is case-insensitive and blanks are allowed between tokens. Tokens are returned as
+// views into the source line, no intermediate strings are built.
+
+class InstructionLexer
+{
+private:
+    const std::string_view line;
+    std::size_t position = 0;
+
+    [[noreturn]] void expression_error(const std::string & reason, const std::size_t at) const
+    {
+        throw SysdarftCodeExpressionError(reason + " at column " + std::to_string(at + 1)
+            + ": " + std::string(line));
+    }
+
+    [[noreturn]] void instruction_error(const std::string & reason, const std::size_t at) const
+    {
+        throw InstructionExpressionError(reason + " at column " + std::to_string(at + 1)
+            + ": " + std::string(line));
+    }
+
+    static char upper(const char ch) {
+        return static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    }
+
+    static bool is_digit(const char ch) {
+        return std::isdigit(static_cast<unsigned char>(ch));
+    }
+
+    static bool is_alpha(const char ch) {
+        return std::isalpha(static_cast<unsigned char>(ch));
+    }
+
+    static bool iequals(const std::string_view a, const std::string_view b)
+    {
+        if (a.size() != b.size()) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < a.size(); i++) {
+            if (upper(a[i]) != b[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    char peek()
+    {
+        while (position < line.size() && std::isspace(static_cast<unsigned char>(line[position]))) {
+            position++;
+        }
+
+        return position < line.size() ? line[position] : '\0';
+    }
+
+    bool end() {
+        return peek() == '\0';
+    }
+
+    void expect(const char ch, const char * what)
+    {
+        if (peek() != ch) {
+            expression_error(std::string("Expected ") + what, position);
+        }
+
+        position++;
+    }
+
+    std::string_view letters()
+    {
+        const std::size_t begin = position;
+        while (position < line.size() && is_alpha(line[position])) {
+            position++;
+        }
+
+        return line.substr(begin, position - begin);
+    }
+
+    // letters followed by letters or digits, like INT3
+    std::string_view mnemonic()
+    {
+        const std::size_t begin = position;
+        letters();
+        while (position > begin && position < line.size()
+            && (is_alpha(line[position]) || is_digit(line[position])))
+        {
+            position++;
+        }
+
+        return line.substr(begin, position - begin);
+    }
+
+    // decimal number, returns -1 if there are no digits
+    int number()
+    {
+        peek();
+        const std::size_t begin = position;
+        int value = 0;
+        while (position < line.size() && is_digit(line[position]))
+        {
+            value = value * 10 + (line[position] - '0');
+            if (value > 0xFFFF) {
+                expression_error("Number too large", begin);
+            }
+            position++;
+        }
+
+        return position == begin ? -1 : value;
+    }
+
+    void register_target(lexed_target_t & target)
+    {
+        target.TargetType = lexed_target_t::REGISTER;
+        target.Column = position + 1;
+        const std::size_t begin = position;
+        position++; // '%'
+
+        const auto name = letters();
+        struct special_register_t { const char * name; uint8_t code; };
+        static constexpr special_register_t special_registers[] = {
+            { "SB", R_StackBase }, { "SP", R_StackPointer },
+            { "CB", R_CodeBase }, { "DB", R_DataBase }, { "DP", R_DataPointer },
+            { "EB", R_ExtendedBase }, { "EP", R_ExtendedPointer },
+        };
+
+        for (const auto & [special_name, code] : special_registers)
+        {
+            if (iequals(name, special_name)) {
+                target.RegisterWidth = _64bit_prefix;
+                target.RegisterIndex = code;
+                return;
+            }
+        }
+
+        int limit;
+        if (iequals(name, "R"))         { target.RegisterWidth = _8bit_prefix;      limit = 7;  }
+        else if (iequals(name, "EXR"))  { target.RegisterWidth = _16bit_prefix;     limit = 7;  }
+        else if (iequals(name, "HER"))  { target.RegisterWidth = _32bit_prefix;     limit = 7;  }
+        else if (iequals(name, "FER"))  { target.RegisterWidth = _64bit_prefix;     limit = 15; }
+        else if (iequals(name, "XMM"))  { target.RegisterWidth = _float_ptr_prefix; limit = 5;  }
+        else { expression_error("Unknown register %" + std::string(name), begin); }
+
+        const std::size_t index_begin = position;
+        int index = 0;
+        bool has_digits = false;
+        while (position < line.size() && is_digit(line[position])) {
+            index = std::min(index * 10 + (line[position] - '0'), 0xFF);
+            has_digits = true;
+            position++;
+        }
+
+        if (!has_digits || index > limit) {
+            expression_error("Illegal register index for %" + std::string(name), index_begin);
+        }
+
+        target.RegisterIndex = static_cast<uint8_t>(index);
+    }
+
+    void constant_target(lexed_target_t & target)
+    {
+        target.TargetType = lexed_target_t::CONSTANT;
+        target.Column = position + 1;
+        position++; // '$'
+        expect('(', "'(' after '$'");
+
+        const std::size_t begin = position;
+        int depth = 1;
+        for (; position < line.size(); position++)
+        {
+            if (line[position] == '(') {
+                depth++;
+            } else if (line[position] == ')' && --depth == 0) {
+                break;
+            } else if (line[position] == '>' || line[position] == ',') {
+                break;
+            }
+        }
+
+        if (depth != 0) {
+            expression_error("Unterminated constant expression", target.Column - 1);
+        }
+
+        target.ConstantExpression = line.substr(begin, position - begin);
+        position++; // ')'
+    }
+
+    void memory_operand(lexed_operand_t & operand)
+    {
+        operand.TargetType = lexed_target_t::MEMORY;
+        operand.Column = position + 1;
+        position++; // '*'
+
+        const std::size_t ratio_at = position;
+        switch (number())
+        {
+        case 1:  operand.MemoryAccessRatio = 0x01; break;
+        case 2:  operand.MemoryAccessRatio = 0x02; break;
+        case 4:  operand.MemoryAccessRatio = 0x04; break;
+        case 8:  operand.MemoryAccessRatio = 0x08; break;
+        case 16: operand.MemoryAccessRatio = 0x16; break;
+        default: expression_error("Illegal memory access ratio", ratio_at);
+        }
+
+        expect('&', "'&' after memory access ratio");
+
+        const std::size_t width_at = position;
+        switch (number())
+        {
+        case 8:  operand.MemoryWidth = _8bit_prefix;  break;
+        case 16: operand.MemoryWidth = _16bit_prefix; break;
+        case 32: operand.MemoryWidth = _32bit_prefix; break;
+        case 64: operand.MemoryWidth = _64bit_prefix; break;
+        default: expression_error("Illegal memory access width", width_at);
+        }
+
+        expect('(', "'(' after memory access width");
+        for (std::size_t i = 0; i < operand.MemoryParameters.size(); i++)
+        {
+            if (i != 0) {
+                expect(',', "',' between memory parameters");
+            }
+
+            auto & parameter = operand.MemoryParameters[i];
+            switch (peek())
+            {
+            case '%':
+                register_target(parameter);
+                if (parameter.RegisterWidth != _64bit_prefix
+                    || (parameter.RegisterIndex > 15
+                        && parameter.RegisterIndex != R_StackPointer
+                        && parameter.RegisterIndex != R_DataPointer))
+                {
+                    expression_error("Not a 64bit Register", parameter.Column - 1);
+                }
+                break;
+            case '$': constant_target(parameter); break;
+            default: expression_error("Expected register or constant as memory parameter", position);
+            }
+        }
+        expect(')', "')' after memory parameters");
+    }
+
+public:
+    explicit InstructionLexer(const std::string_view _line) : line(_line) { }
+
+    void operand(lexed_operand_t & operand)
+    {
+        operand = lexed_operand_t { };
+        switch (peek())
+        {
+        case '%': register_target(operand); break;
+        case '$': constant_target(operand); break;
+        case '*': memory_operand(operand); break;
+        default: expression_error("Expected register, constant or memory operand", position);
+        }
+
+        if (!end()) {
+            expression_error("Unexpected character after operand", position);
+        }
+    }
+
+    void instruction(lexed_instruction_t & instruction)
+    {
+        instruction.Width = 0;
+        instruction.Operands.clear();
+
+        peek();
+        instruction.MnemonicColumn = position + 1;
+        instruction.Mnemonic = mnemonic();
+        if (instruction.Mnemonic.empty()) {
+            instruction_error("No match for instruction", position);
+        }
+
+        if (peek() == '.')
+        {
+            const std::size_t width_at = position;
+            position++;
+            const int width = number();
+            if (!iequals(letters(), "BIT")) {
+                instruction_error("Unknown width specifier", width_at);
+            }
+
+            switch (width)
+            {
+            case 8:  instruction.Width = _8bit_prefix;  break;
+            case 16: instruction.Width = _16bit_prefix; break;
+            case 32: instruction.Width = _32bit_prefix; break;
+            case 64: instruction.Width = _64bit_prefix; break;
+            default: instruction_error("Unknown width specifier", width_at);
+            }
+
+            instruction.WidthColumn = width_at + 1;
+        }
+
+        while (!end())
+        {
+            if (!instruction.Operands.empty())
+            {
+                if (peek() != ',') {
+                    instruction_error("Expected ',' between operands", position);
+                }
+                position++;
+            }
+
+            if (peek() != '<') {
+                instruction_error("Expected '<' to open an operand", position);
+            }
+            position++;
+
+            auto & operand = instruction.Operands.emplace_back();
+            switch (peek())
+            {
+            case '%': register_target(operand); break;
+            case '$': constant_target(operand); break;
+            case '*': memory_operand(operand); break;
+            default: expression_error("Expected register, constant or memory operand", position);
+            }
+
+            if (peek() != '>') {
+                instruction_error("Expected '>' to close the operand", position);
+            }
+            position++;
+        }
+    }
+};
+
+void SYSDARFT_EXPORT_SYMBOL lex_instruction(const std::string_view line, lexed_instruction_t & instruction)
+{
+    InstructionLexer(line).instruction(instruction);
+}
+
+lexed_operand_t lex_operand(const std::string_view operand)
+{
+    lexed_operand_t ret;
+    InstructionLexer(operand).operand(ret);
+    return ret;
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstring>
+#include <SysdarftAssembler.h>
+
+struct global_symbol_t
+{
+    constant_value_t value;
+    const sysdarft_object_t * object;
+};
+
+std::vector < uint8_t > link_objects(const std::span < const sysdarft_object_t > objects,
+    const uint64_t origin, std::map < std::string, constant_value_t, std::less<> > & symbols)
+{
+    // sections of the same name are merged, in object order
+    std::vector < std::string_view > section_names;
+    for (const auto & object : objects)
+    {
+        for (const auto & section : object.Sections)
+        {
+            if (std::ranges::find(section_names, section.Name) == section_names.end()) {
+                section_names.push_back(section.Name);
+            }
+        }
+    }
+
+    // offset of every section of every object in the image
+    std::vector < std::vector < uint64_t > > placement(objects.size());
+    for (std::size_t i = 0; i < objects.size(); i++) {
+        placement[i].resize(objects[i].Sections.size());
+    }
+
+    uint64_t size = 0;
+    for (const auto & name : section_names)
+    {
+        for (std::size_t i = 0; i < objects.size(); i++)
+        {
+            const auto & sections = objects[i].Sections;
+            for (std::size_t section = 0; section < sections.size(); section++)
+            {
+                if (sections[section].Name == name) {
+                    placement[i][section] = size;
+                    size += sections[section].Code.size();
+                }
+            }
+        }
+    }
+
+    std::vector < uint8_t > image(size);
+    for (std::size_t i = 0; i < objects.size(); i++)
+    {
+        for (std::size_t section = 0; section < objects[i].Sections.size(); section++) {
+            const auto & code = objects[i].Sections[section].Code;
+            std::memcpy(image.data() + placement[i][section], code.data(), code.size());
+        }
+    }
+
+    auto final_value = [&](const std::size_t object, const assembler_value_t & value) -> constant_value_t
+    {
+        if (value.Section < 0) {
+            return value.Value;
+        }
+
+        if (static_cast<uint64_t>(value.Section) >= objects[object].Sections.size()) {
+            throw SysdarftLinkerError("Bad section index in " + objects[object].Name);
+        }
+
+        return {
+            .ValueType = constant_value_t::INTEGER,
+            .IntegerValue = origin + placement[object][value.Section] + value.Value.IntegerValue,
+            .FloatValue = 0
+        };
+    };
+
+    std::map < std::string, global_symbol_t, std::less<> > globals;
+    for (std::size_t i = 0; i < objects.size(); i++)
+    {
+        for (const auto & symbol : objects[i].Symbols)
+        {
+            if (!symbol.Global) {
+                continue;
+            }
+
+            const auto [it, inserted] = globals.emplace(symbol.Name,
+                global_symbol_t { .value = final_value(i, symbol.Value), .object = &objects[i] });
+            if (!inserted) {
+                throw SysdarftLinkerError("Symbol " + symbol.Name + " defined in both " + it->second.object->Name
+                    + " and " + objects[i].Name);
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < objects.size(); i++)
+    {
+        const auto & object = objects[i];
+        for (const auto & relocation : object.Relocations)
+        {
+            uint64_t base;
+            if (relocation.TargetSection >= 0) {
+                base = constant_value_to_operand(final_value(i, { .Value = { }, .Section = relocation.TargetSection }));
+            } else {
+                const auto it = globals.find(relocation.Symbol);
+                if (it == globals.end()) {
+                    throw SysdarftLinkerError("Undefined symbol " + relocation.Symbol + " referenced in " + object.Name);
+                }
+
+                if (it->second.value.ValueType != constant_value_t::INTEGER) {
+                    throw SysdarftLinkerError("Floating point symbol " + relocation.Symbol
+                        + " used as an address in " + object.Name);
+                }
+
+                base = constant_value_to_operand(it->second.value);
+            }
+
+            if (relocation.Section >= object.Sections.size()
+                || relocation.Offset + sizeof(uint64_t) > object.Sections[relocation.Section].Code.size())
+            {
+                throw SysdarftLinkerError("Relocation outside of its section in " + object.Name);
+            }
+
+            const uint64_t value = base + relocation.Addend;
+            std::memcpy(image.data() + placement[i][relocation.Section] + relocation.Offset, &value, sizeof(value));
+        }
+    }
+
+    symbols.clear();
+    for (auto & [name, global] : globals) {
+        symbols.emplace(name, global.value);
+    }
+
+    for (std::size_t i = 0; i < objects.size(); i++)
+    {
+        for (const auto & symbol : objects[i].Symbols) {
+            symbols.emplace(symbol.Name, final_value(i, symbol.Value));
+        }
+    }
+
+    return image;
+}
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <fstream>
+#include <ranges>
+#include <SysdarftAssembler.h>
+
+// Assembler cache and object files. Integers are stored in host byte order, neither format is
+// meant to be shared between machines. Both start with a magic carrying the format version.
+constexpr char cache_magic[8] = { 'S', 'D', 'A', 'S', 'C', 'A', 'C', '3' };
+constexpr char object_magic[8] = { 'S', 'D', 'O', 'B', 'J', '0', '0', '1' };
+
+template < typename Type >
+void binary_write(std::ofstream & file, const Type & value) {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void binary_write(std::ofstream & file, const std::string & text)
+{
+    binary_write(file, static_cast<uint64_t>(text.size()));
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void binary_write(std::ofstream & file, const std::vector < uint8_t > & data)
+{
+    binary_write(file, static_cast<uint64_t>(data.size()));
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+void binary_write(std::ofstream & file, const assembler_value_t & value)
+{
+    binary_write(file, value.Section);
+    binary_write(file, static_cast<uint8_t>(value.Value.ValueType));
+    binary_write(file, value.Value.IntegerValue);
+    binary_write(file, value.Value.FloatValue);
+}
+
+void binary_write(std::ofstream & file, const object_relocation_t & relocation)
+{
+    binary_write(file, relocation.Section);
+    binary_write(file, relocation.Offset);
+    binary_write(file, relocation.TargetSection);
+    binary_write(file, relocation.Symbol);
+    binary_write(file, relocation.Addend);
+}
+
+class binary_reader
+{
+private:
+    std::ifstream & file;
+    const std::string & path;
+    std::streamoff end = 0;
+
+    void read(char * data, const std::size_t size) const
+    {
+        if (!file.read(data, static_cast<std::streamsize>(size))) {
+            throw SysdarftAssemblerError("Truncated file " + path);
+        }
+    }
+
+    // lengths are checked before anything is allocated for them, a corrupt one is not a huge allocation
+    std::size_t length()
+    {
+        const auto size = get<uint64_t>();
+        if (size > static_cast<uint64_t>(end - file.tellg())) {
+            throw SysdarftAssemblerError("Truncated file " + path);
+        }
+
+        return size;
+    }
+
+public:
+    binary_reader(std::ifstream & _file, const std::string & _path) : file(_file), path(_path)
+    {
+        const auto position = file.tellg();
+        file.seekg(0, std::ios::end);
+        end = file.tellg();
+        file.seekg(position);
+    }
+
+    template < typename Type >
+    Type get()
+    {
+        Type value { };
+        read(reinterpret_cast<char *>(&value), sizeof(value));
+        return value;
+    }
+
+    std::string string()
+    {
+        std::string text(length(), '\0');
+        read(text.data(), text.size());
+        return text;
+    }
+
+    std::vector < uint8_t > bytes()
+    {
+        std::vector < uint8_t > data(length());
+        read(reinterpret_cast<char *>(data.data()), data.size());
+        return data;
+    }
+
+    assembler_value_t value()
+    {
+        assembler_value_t value;
+        value.Section = get<int64_t>();
+        value.Value.ValueType = get<uint8_t>() == constant_value_t::FLOAT ? constant_value_t::FLOAT : constant_value_t::INTEGER;
+        value.Value.IntegerValue = get<__int128_t>();
+        value.Value.FloatValue = get<double>();
+        return value;
+    }
+
+    object_relocation_t relocation()
+    {
+        object_relocation_t relocation;
+        relocation.Section = get<uint64_t>();
+        relocation.Offset = get<uint64_t>();
+        relocation.TargetSection = get<int64_t>();
+        relocation.Symbol = string();
+        relocation.Addend = get<uint64_t>();
+        return relocation;
+    }
+};
+
+bool SysdarftAssembler::load_cache(const std::string & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    // a cache of another version or a damaged one is rebuilt, only a file that is no cache at all is an error
+    char magic[sizeof(cache_magic)] { };
+    if (!file.read(magic, sizeof(magic)) || !std::ranges::equal(magic, magic + 7, cache_magic, cache_magic + 7)) {
+        throw SysdarftAssemblerError("Not an assembler cache file: " + path);
+    }
+
+    cache.clear();
+    if (magic[7] != cache_magic[7]) {
+        return false;
+    }
+
+    try {
+        read_cache(file, path);
+    } catch (const SysdarftAssemblerError &) {
+        cache.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void SysdarftAssembler::read_cache(std::ifstream & file, const std::string & path)
+{
+    binary_reader reader(file, path);
+    if (reader.get<uint8_t>() != mode) {
+        throw SysdarftAssemblerError("Cache written for another encoding mode: " + path);
+    }
+
+    for (auto count = reader.get<uint64_t>(); count != 0; count--)
+    {
+        assembler_cache_entry_t entry;
+        entry.text = reader.string();
+        entry.code = reader.bytes();
+        entry.size = entry.code.size();
+        for (auto references = reader.get<uint64_t>(); references != 0; references--)
+        {
+            auto name = reader.string();
+            entry.references.emplace_back(std::move(name), reader.value());
+        }
+
+        for (auto relocations = reader.get<uint64_t>(); relocations != 0; relocations--) {
+            entry.relocations.push_back(reader.relocation());
+        }
+
+        const auto hash = assembler_hash(entry.text);
+        cache.insert_or_assign(hash, std::move(entry));
+    }
+}
+
+void SysdarftAssembler::save_cache(const std::string & path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(cache_magic, sizeof(cache_magic));
+    binary_write(file, static_cast<uint8_t>(mode));
+    binary_write(file, static_cast<uint64_t>(cache.size()));
+    for (const auto & entry : cache | std::views::values)
+    {
+        binary_write(file, entry.text);
+        binary_write(file, entry.code);
+        binary_write(file, static_cast<uint64_t>(entry.references.size()));
+        for (const auto & [name, value] : entry.references)
+        {
+            binary_write(file, name);
+            binary_write(file, value);
+        }
+
+        binary_write(file, static_cast<uint64_t>(entry.relocations.size()));
+        for (const auto & relocation : entry.relocations) {
+            binary_write(file, relocation);
+        }
+    }
+
+    if (!file) {
+        throw SysdarftAssemblerError("Cannot write cache file " + path);
+    }
+}
+
+// Object file: magic, source hash, name, then the sections, symbols and relocations
+void sysdarft_object_t::save(const std::string & path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(object_magic, sizeof(object_magic));
+    binary_write(file, SourceHash);
+    binary_write(file, Name);
+
+    binary_write(file, static_cast<uint64_t>(Sections.size()));
+    for (const auto & section : Sections)
+    {
+        binary_write(file, section.Name);
+        binary_write(file, section.Code);
+    }
+
+    binary_write(file, static_cast<uint64_t>(Symbols.size()));
+    for (const auto & symbol : Symbols)
+    {
+        binary_write(file, symbol.Name);
+        binary_write(file, static_cast<uint8_t>(symbol.Global));
+        binary_write(file, symbol.Value);
+    }
+
+    binary_write(file, static_cast<uint64_t>(Relocations.size()));
+    for (const auto & relocation : Relocations) {
+        binary_write(file, relocation);
+    }
+
+    if (!file) {
+        throw SysdarftAssemblerError("Cannot write object file " + path);
+    }
+}
+
+sysdarft_object_t sysdarft_object_t::load(const std::string & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw SysdarftAssemblerError("Cannot open object file " + path);
+    }
+
+    char magic[sizeof(object_magic)] { };
+    if (!file.read(magic, sizeof(magic)) || !std::ranges::equal(magic, object_magic)) {
+        throw SysdarftAssemblerError("Not an object file: " + path);
+    }
+
+    binary_reader reader(file, path);
+    sysdarft_object_t object;
+    object.SourceHash = reader.get<uint64_t>();
+    object.Name = reader.string();
+
+    for (auto count = reader.get<uint64_t>(); count != 0; count--)
+    {
+        auto name = reader.string();
+        object.Sections.push_back({ .Name = std::move(name), .Code = reader.bytes() });
+    }
+
+    for (auto count = reader.get<uint64_t>(); count != 0; count--)
+    {
+        object_symbol_t symbol;
+        symbol.Name = reader.string();
+        symbol.Global = reader.get<uint8_t>() != 0;
+        symbol.Value = reader.value();
+        object.Symbols.push_back(std::move(symbol));
+    }
+
+    for (auto count = reader.get<uint64_t>(); count != 0; count--) {
+        object.Relocations.push_back(reader.relocation());
+    }
+
+    return object;
+}
+
+uint64_t sysdarft_object_t::peek_source_hash(const std::string & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(object_magic)] { };
+    uint64_t hash = 0;
+    if (!file.read(magic, sizeof(magic)) || !std::ranges::equal(magic, object_magic)
+        || !file.read(reinterpret_cast<char *>(&hash), sizeof(hash)))
+    {
+        return 0;
+    }
+
+    return hash;
+}
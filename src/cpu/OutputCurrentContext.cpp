@@ -357,23 +357,17 @@ void SysdarftCPUInstructionExecutor::show_context()
           SysdarftRegister::load<CodeBaseType>()
         + SysdarftRegister::load<InstructionPointerType>();
     const uint64_t length = std::min<uint64_t>(256, TotalMemory - offset);
-    std::vector<uint8_t> buffer_max256;
-    buffer_max256.reserve(length);
+    std::vector<uint8_t> buffer_max256(length);
+    SysdarftCPUMemoryAccess::read_memory(offset, reinterpret_cast<char *>(buffer_max256.data()), length);
 
-    for (uint64_t i = 0; i < length; i++)
-    {
-        char c;
-        SysdarftCPUMemoryAccess::read_memory(offset + i, &c, 1);
-        buffer_max256.push_back(static_cast<uint8_t>(c));
-    }
-
-    while (!buffer_max256.empty())
+    uint64_t decoded = 0;
+    while (decoded < length && next_8_instructions.size() < 8)
     {
         std::stringstream line_num;
         line_num << std::hex << std::uppercase << std::setfill('0') << std::setw(16)
-                 << (offset + (length - buffer_max256.size()));
+                 << (offset + decoded);
 
-        decode_instruction(next_8_instructions, buffer_max256);
+        decode_instruction(next_8_instructions, buffer_max256, decoded);
 
         if (!next_8_instructions.empty()) {
             next_8_instructions.back() =
@@ -381,10 +375,6 @@ void SysdarftCPUInstructionExecutor::show_context()
         }
     }
 
-    if (next_8_instructions.size() > 8) {
-        next_8_instructions.resize(8);
-    }
-
     for (const auto &instruction : next_8_instructions) {
         log(instruction, "\n");
     }
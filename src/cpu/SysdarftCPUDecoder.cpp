@@ -1,3 +1,4 @@
+#include <array>
 #include <iomanip>
 #include <InstructionSet.h>
 #include <EncodingDecoding.h>
@@ -77,49 +78,72 @@ void OperandType::do_decode_register_without_prefix()
 {
     const uint8_t width = Access.pop_code8();
     const auto register_index = Access.pop_code8();
+    set_register(width, register_index);
+}
+
+void OperandType::set_register(const uint8_t width, const uint8_t register_index)
+{
     OperandReferenceTable.OperandType = RegisterOperand;
     OperandReferenceTable.OperandInfo.RegisterValue.RegisterWidthBCD = width;
     OperandReferenceTable.OperandInfo.RegisterValue.RegisterIndex = register_index;
 
+    // names are checked either way, the literal is only built when asked for
     if (width == _64bit_prefix && register_index > 15)
     {
+        const char * name;
         switch (register_index) {
-        case R_StackBase: OperandReferenceTable.literal = "%SB"; break;
-        case R_StackPointer: OperandReferenceTable.literal = "%SP"; break;
-        case R_CodeBase: OperandReferenceTable.literal = "%CB"; break;
-        case R_DataBase: OperandReferenceTable.literal = "%DB"; break;
-        case R_DataPointer: OperandReferenceTable.literal = "%DP"; break;
-        case R_ExtendedBase: OperandReferenceTable.literal = "%EB"; break;
-        case R_ExtendedPointer: OperandReferenceTable.literal = "%EP"; break;
+        case R_StackBase: name = "%SB"; break;
+        case R_StackPointer: name = "%SP"; break;
+        case R_CodeBase: name = "%CB"; break;
+        case R_DataBase: name = "%DB"; break;
+        case R_DataPointer: name = "%DP"; break;
+        case R_ExtendedBase: name = "%EB"; break;
+        case R_ExtendedPointer: name = "%EP"; break;
         default: throw IllegalInstruction("Unknown register index");
         }
+
+        if (with_literal) {
+            OperandReferenceTable.literal = name;
+        }
     }
     else
     {
+        const char * prefix;
         switch (width) {
-        case _8bit_prefix:  OperandReferenceTable.literal = "%R"   + std::to_string(register_index); break;
-        case _16bit_prefix: OperandReferenceTable.literal = "%EXR" + std::to_string(register_index); break;
-        case _32bit_prefix: OperandReferenceTable.literal = "%HER" + std::to_string(register_index); break;
-        case _64bit_prefix: OperandReferenceTable.literal = "%FER" + std::to_string(register_index); break;
-        case _float_ptr_prefix: OperandReferenceTable.literal = "%XMM" + std::to_string(register_index); break;
+        case _8bit_prefix:  prefix = "%R"; break;
+        case _16bit_prefix: prefix = "%EXR"; break;
+        case _32bit_prefix: prefix = "%HER"; break;
+        case _64bit_prefix: prefix = "%FER"; break;
+        case _float_ptr_prefix: prefix = "%XMM"; break;
         default: throw IllegalInstruction("Unknown register type");
         }
+
+        if (with_literal) {
+            OperandReferenceTable.literal = prefix + std::to_string(register_index);
+        }
     }
 }
 
 void OperandType::do_decode_constant_without_prefix()
 {
-    if (const auto & prefix = Access.pop_code8();
-        prefix == _64bit_prefix || prefix == _float_ptr_prefix)
+    uint64_t num;
+    switch (Access.pop_code8())
     {
+    // compact immediates, zero extended
+    case _8bit_prefix: num = Access.pop_code8(); break;
+    case _16bit_prefix: num = Access.pop_code16(); break;
+    case _32bit_prefix: num = Access.pop_code32(); break;
+    case _64bit_prefix:
+    case _float_ptr_prefix: num = Access.pop_code64(); break;
+    default: throw IllegalInstruction("Unknown constant width");
+    }
+
+    OperandReferenceTable.OperandType = ConstantOperand;
+    OperandReferenceTable.OperandInfo.ConstantValue = num;
+    if (with_literal) {
         std::stringstream ss;
-        const auto num = Access.pop_code64();
-        OperandReferenceTable.OperandType = ConstantOperand;
-        OperandReferenceTable.OperandInfo.ConstantValue = num;
         ss << "0x" << std::uppercase << std::hex << num;
         OperandReferenceTable.literal = "$(" + ss.str() + ")";
-    } else {
-        throw IllegalInstruction("Unknown constant width");
     }
 }
 
@@ -152,21 +176,55 @@ void OperandType::do_decode_memory_without_prefix()
     decode_each_parameter(literal3, off2);
     const uint8_t ratio = Access.pop_code8();
 
+    set_memory(WidthBCD, ratio, { base, off1, off2 }, { literal1, literal2, literal3 });
+}
+
+void OperandType::do_decode_register_memory_without_prefix()
+{
+    const auto WidthBCD = Access.pop_code8();
+    std::array < uint64_t, 3 > values { };
+    std::array < std::string, 3 > literals;
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (const auto register_index = Access.pop_code8(); register_index == MEMORY_ZERO_PARAMETER) {
+            if (with_literal) {
+                literals[i] = "$(0x0)";
+            }
+        } else {
+            set_register(_64bit_prefix, register_index);
+            values[i] = do_access_register_based_on_table();
+            literals[i] = OperandReferenceTable.literal;
+        }
+    }
+
+    const uint8_t ratio = Access.pop_code8();
+    set_memory(WidthBCD, ratio, values, literals);
+}
+
+void OperandType::set_memory(const uint8_t WidthBCD, const uint8_t ratio,
+    const std::array < uint64_t, 3 > & parameters, const std::array < std::string, 3 > & literals)
+{
+    const auto & [base, off1, off2] = parameters;
+    const auto & [literal1, literal2, literal3] = literals;
     const uint64_t calculated_address = (base + off1 + off2) * ratio;
     OperandReferenceTable.OperandType = MemoryOperand;
     OperandReferenceTable.OperandInfo.CalculatedMemoryAddress.MemoryAddress = calculated_address;
     OperandReferenceTable.OperandInfo.CalculatedMemoryAddress.RegisterWidthBCD = WidthBCD;
-    OperandReferenceTable.literal = "*" + std::to_string(ratio) + "&";
 
+    const char * width;
     switch (WidthBCD) {
-    case _8bit_prefix:  OperandReferenceTable.literal += "8"; break;
-    case _16bit_prefix: OperandReferenceTable.literal += "16"; break;
-    case _32bit_prefix: OperandReferenceTable.literal += "32"; break;
-    case _64bit_prefix: OperandReferenceTable.literal += "64"; break;
+    case _8bit_prefix:  width = "8"; break;
+    case _16bit_prefix: width = "16"; break;
+    case _32bit_prefix: width = "32"; break;
+    case _64bit_prefix: width = "64"; break;
     default: throw IllegalInstruction("Unknown width");
     }
 
-    OperandReferenceTable.literal += "(" + literal1 + ", " + literal2 + ", " + literal3 + ")";
+    if (with_literal) {
+        OperandReferenceTable.literal = "*" + std::to_string(ratio) + "&" + width
+            + "(" + literal1 + ", " + literal2 + ", " + literal3 + ")";
+    }
 }
 
 void OperandType::do_decode_operand()
@@ -176,9 +234,14 @@ void OperandType::do_decode_operand()
         case REGISTER_PREFIX: do_decode_register_without_prefix(); break;
         case CONSTANT_PREFIX: do_decode_constant_without_prefix(); break;
         case MEMORY_PREFIX: do_decode_memory_without_prefix(); break;
+        case MEMORY_REGISTER_PREFIX: do_decode_register_memory_without_prefix(); break;
         default: throw IllegalInstruction("Unknown operand type");
     }
 
+    if (!with_literal) {
+        return;
+    }
+
     OperandReferenceTable.literal = "<" + OperandReferenceTable.literal + ">";
     if (OperandReferenceTable.OperandType == MemoryOperand) {
         std::stringstream ss;
@@ -300,7 +363,7 @@ void OperandType::store_value_to_memory_based_on_table(const uint64_t value)
 }
 
 SysdarftCPUInstructionDecoder::ActiveInstructionType
-SysdarftCPUInstructionDecoder::pop_instruction_from_ip_and_increase_ip()
+SysdarftCPUInstructionDecoder::pop_instruction_from_ip_and_increase_ip(const bool with_literal)
 {
     uint8_t instruction = 0;
     ActiveInstructionType ret { };
@@ -314,31 +377,44 @@ SysdarftCPUInstructionDecoder::pop_instruction_from_ip_and_increase_ip()
         {
             // register instruction opcode
             ret.opcode = instruction;
-            buffer << fst;
+            ret.mnemonic = fst;
+            if (with_literal) {
+                buffer << fst;
+            }
 
             if (snd.at(ENTRY_REQUIRE_OPERATION_WIDTH_SPECIFICATION) != 0)
             {
                 const auto width = pop_code8();
                 ret.width = width;
 
+                const char * suffix;
                 switch (width)
                 {
-                case _8bit_prefix: buffer << " .8bit "; break;
-                case _16bit_prefix: buffer << " .16bit";  break;
-                case _32bit_prefix: buffer << " .32bit";  break;
-                case _64bit_prefix: buffer << " .64bit";  break;
+                case _8bit_prefix: suffix = " .8bit "; break;
+                case _16bit_prefix: suffix = " .16bit";  break;
+                case _32bit_prefix: suffix = " .32bit";  break;
+                case _64bit_prefix: suffix = " .64bit";  break;
                 default: throw IllegalInstruction("Unknown width specification");
                 }
+
+                if (with_literal) {
+                    buffer << suffix;
+                }
             }
 
             const auto arg_count = snd.at(ENTRY_ARGUMENT_COUNT);
             for (uint64_t i = 0 ; i < arg_count; i++)
             {
-                ret.operands.emplace_back(*this);
-                buffer << " " << ret.operands.back().get_literal() << (i == 0 && arg_count > 1 ? "," : "");
+                ret.operands.emplace_back(*this, with_literal);
+                if (with_literal) {
+                    buffer << " " << ret.operands.back().get_literal() << (i == 0 && arg_count > 1 ? "," : "");
+                }
+            }
+
+            if (with_literal) {
+                ret.literal = buffer.str();
             }
 
-            ret.literal = buffer.str();
             return ret;
         }
     }
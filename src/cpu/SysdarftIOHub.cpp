@@ -0,0 +1,333 @@
+#include <bit>
+#include <cstring>
+#include <SysdarftIOHub.h>
+#include <SysdarftMemory.h>
+
+namespace {
+    uint64_t all_ones(const uint32_t size) {
+        return size >= 8 ? ~0ULL : (1ULL << size * 8) - 1;
+    }
+
+    // naturally sized pieces of at most 8 bytes, the sizes MMIO handlers are called with
+    uint32_t chunk_size(const uint64_t remaining) {
+        return remaining >= 8 ? 8 : static_cast<uint32_t>(std::bit_floor(remaining));
+    }
+}
+
+const sysdarft_host_api_t * SysdarftIOHub::connect()
+{
+    auto client = std::make_unique<client_t>();
+    client->hub = this;
+    client->api = {
+        .abi_version = SYSDARFT_DEVICE_ABI_VERSION,
+        .struct_size = sizeof(sysdarft_host_api_t),
+        .host = client.get(),
+        .register_mmio = [](void * host, const uint64_t first_page, const uint64_t pages,
+            const sysdarft_mmio_read_t read, const sysdarft_mmio_write_t write, void * context)
+        {
+            const auto * self = static_cast<client_t *>(host);
+            return self->hub->register_mmio(self, first_page, pages, read, write, context);
+        },
+        .register_ports = [](void * host, const uint16_t first_port, const uint32_t count,
+            const sysdarft_port_read_t read, const sysdarft_port_write_t write, void * context)
+        {
+            const auto * self = static_cast<client_t *>(host);
+            return self->hub->register_ports(self, first_port, count, read, write, context);
+        },
+        .register_irq = [](void * host, const uint32_t line)
+        {
+            const auto * self = static_cast<client_t *>(host);
+            return self->hub->register_irq(self, line);
+        },
+        .raise_irq = [](void * host, const uint32_t line)
+        {
+            const auto * self = static_cast<client_t *>(host);
+            self->hub->raise_irq(self, line);
+        },
+        .map_guest_memory = [](void * host, const uint64_t address, const uint64_t size,
+            sysdarft_memory_window_t * window)
+        {
+            return static_cast<client_t *>(host)->hub->map_guest_memory(address, size, window);
+        },
+    };
+
+    clients.emplace_back(std::move(client));
+    return &clients.back()->api;
+}
+
+void SysdarftIOHub::disconnect(const sysdarft_host_api_t * host)
+{
+    const auto * owner = static_cast<const client_t *>(host->host);
+
+    std::erase_if(mmio_regions, [owner](const auto & region) { return region.second.owner == owner; });
+
+    for (auto & port : ports) {
+        if (port.owner == owner) {
+            port = { };
+        }
+    }
+
+    for (uint32_t line = 0; line < irq_lines; line++)
+    {
+        if (irq_owners[line] == owner)
+        {
+            irq_owners[line] = nullptr;
+            pending_irqs.fetch_and(~(1ULL << line), std::memory_order_relaxed);
+        }
+    }
+
+    std::erase_if(clients, [owner](const auto & client) { return client.get() == owner; });
+}
+
+int SysdarftIOHub::register_mmio(const client_t * owner, const uint64_t first_page, const uint64_t pages,
+    const sysdarft_mmio_read_t read, const sysdarft_mmio_write_t write, void * context)
+{
+    constexpr uint64_t page_count = UINT64_MAX / page_size;
+    if (pages == 0 || first_page >= page_count || pages > page_count - first_page || !read || !write) {
+        return SYSDARFT_DEVICE_EINVAL;
+    }
+
+    const uint64_t begin = first_page * page_size;
+    const uint64_t size = pages * page_size;
+    if (find_region(begin, size) != mmio_regions.end()) {
+        return SYSDARFT_DEVICE_EBUSY;
+    }
+
+    mmio_regions.emplace(begin, mmio_region_t {
+        .end = begin + size,
+        .read = read,
+        .write = write,
+        .context = context,
+        .owner = owner,
+    });
+
+    return SYSDARFT_DEVICE_OK;
+}
+
+int SysdarftIOHub::register_ports(const client_t * owner, const uint16_t first_port, const uint32_t count,
+    const sysdarft_port_read_t read, const sysdarft_port_write_t write, void * context)
+{
+    if (count == 0 || first_port + count > 0x10000 || !read || !write) {
+        return SYSDARFT_DEVICE_EINVAL;
+    }
+
+    if (ports.empty()) {
+        ports.resize(0x10000);
+    }
+
+    for (uint32_t port = first_port; port < first_port + count; port++) {
+        if (ports[port].owner != nullptr) {
+            return SYSDARFT_DEVICE_EBUSY;
+        }
+    }
+
+    for (uint32_t port = first_port; port < first_port + count; port++) {
+        ports[port] = { .read = read, .write = write, .context = context, .owner = owner };
+    }
+
+    return SYSDARFT_DEVICE_OK;
+}
+
+int SysdarftIOHub::register_irq(const client_t * owner, const uint32_t line)
+{
+    if (line >= irq_lines) {
+        return SYSDARFT_DEVICE_EINVAL;
+    }
+
+    if (irq_owners[line] != nullptr && irq_owners[line] != owner) {
+        return SYSDARFT_DEVICE_EBUSY;
+    }
+
+    irq_owners[line] = owner;
+    return SYSDARFT_DEVICE_OK;
+}
+
+void SysdarftIOHub::raise_irq(const client_t * owner, const uint32_t line)
+{
+    // only the device that registered a line may raise it
+    if (line < irq_lines && irq_owners[line] == owner) {
+        raise_irq(line);
+    }
+}
+
+int SysdarftIOHub::map_guest_memory(const uint64_t address, const uint64_t size,
+    sysdarft_memory_window_t * window) const
+{
+    if (window == nullptr || size == 0 || address >= memory.size() || size > memory.size() - address) {
+        return SYSDARFT_DEVICE_EINVAL;
+    }
+
+    window->data = memory.data() + address;
+    window->size = size;
+    return SYSDARFT_DEVICE_OK;
+}
+
+std::map < uint64_t, SysdarftIOHub::mmio_region_t >::iterator
+SysdarftIOHub::find_region(const uint64_t address, const uint64_t size)
+{
+    // the first region starting after address, or the one before it if that one covers address
+    auto it = mmio_regions.upper_bound(address);
+    if (it != mmio_regions.begin() && std::prev(it)->second.end > address) {
+        return std::prev(it);
+    }
+
+    if (it != mmio_regions.end() && it->first - address < size) {
+        return it;
+    }
+
+    return mmio_regions.end();
+}
+
+bool SysdarftIOHub::mmio_read(const uint64_t address, char * dest, const uint64_t size)
+{
+    if (mmio_regions.empty() || size == 0) {
+        return false;
+    }
+
+    const auto it = find_region(address, size);
+    if (it == mmio_regions.end()) {
+        return false;
+    }
+
+    const auto & [begin, region] = *it;
+    if (address < begin || region.end - address < size) {
+        throw IllegalMemoryAccessException("Access crosses the boundary of an MMIO region");
+    }
+
+    for (uint64_t offset = 0; offset < size;)
+    {
+        const uint32_t chunk = chunk_size(size - offset);
+        const uint64_t value = region.read(region.context, address + offset - begin, chunk);
+        std::memcpy(dest + offset, &value, chunk);
+        offset += chunk;
+    }
+
+    return true;
+}
+
+bool SysdarftIOHub::mmio_write(const uint64_t address, const char * source, const uint64_t size)
+{
+    if (mmio_regions.empty() || size == 0) {
+        return false;
+    }
+
+    const auto it = find_region(address, size);
+    if (it == mmio_regions.end()) {
+        return false;
+    }
+
+    const auto & [begin, region] = *it;
+    if (address < begin || region.end - address < size) {
+        throw IllegalMemoryAccessException("Access crosses the boundary of an MMIO region");
+    }
+
+    for (uint64_t offset = 0; offset < size;)
+    {
+        const uint32_t chunk = chunk_size(size - offset);
+        uint64_t value = 0;
+        std::memcpy(&value, source + offset, chunk);
+        region.write(region.context, address + offset - begin, chunk, value);
+        offset += chunk;
+    }
+
+    return true;
+}
+
+uint64_t SysdarftIOHub::port_read(const uint16_t port, const uint32_t size)
+{
+    if (ports.empty() || ports[port].owner == nullptr) {
+        return all_ones(size);
+    }
+
+    return ports[port].read(ports[port].context, port, size) & all_ones(size);
+}
+
+void SysdarftIOHub::port_write(const uint16_t port, const uint32_t size, const uint64_t value)
+{
+    if (ports.empty() || ports[port].owner == nullptr) {
+        return;
+    }
+
+    ports[port].write(ports[port].context, port, size, value & all_ones(size));
+}
+
+void SysdarftIOHub::raise_irq(const uint32_t line)
+{
+    if (line < irq_lines) {
+        pending_irqs.fetch_or(1ULL << line, std::memory_order_release);
+    }
+}
+
+int SysdarftIOHub::take_interrupt()
+{
+    uint64_t pending = pending_irqs.load(std::memory_order_acquire);
+    while (pending != 0)
+    {
+        const int line = std::countr_zero(pending);
+        if (pending_irqs.compare_exchange_weak(pending, pending & ~(1ULL << line), std::memory_order_acq_rel)) {
+            return line;
+        }
+    }
+
+    return -1;
+}
+
+void SysdarftIOHub::attach_executor()
+{
+    std::lock_guard<std::mutex> lock(quiesce_mutex);
+    executor_attached = true;
+}
+
+void SysdarftIOHub::detach_executor()
+{
+    std::unique_lock<std::mutex> lock(quiesce_mutex);
+    // nobody would run a pending request anymore
+    run_quiesced_work(lock);
+    executor_attached = false;
+}
+
+void SysdarftIOHub::run_quiesced_work()
+{
+    std::unique_lock<std::mutex> lock(quiesce_mutex);
+    run_quiesced_work(lock);
+}
+
+void SysdarftIOHub::run_quiesced_work(std::unique_lock < std::mutex > &)
+{
+    if (!quiesce_requested.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    try {
+        (*quiesce_work)();
+    } catch (...) {
+        quiesce_error = std::current_exception();
+    }
+
+    quiesce_requested.store(false, std::memory_order_release);
+    quiesce_cv.notify_all();
+}
+
+void SysdarftIOHub::quiesce(const std::function < void() > & work)
+{
+    std::unique_lock<std::mutex> lock(quiesce_mutex);
+    quiesce_cv.wait(lock, [this] { return quiesce_work == nullptr; });
+
+    if (!executor_attached) {
+        work();
+        return;
+    }
+
+    quiesce_work = &work;
+    quiesce_error = nullptr;
+    quiesce_requested.store(true, std::memory_order_release);
+    quiesce_cv.wait(lock, [this] { return !quiesce_requested.load(std::memory_order_acquire); });
+
+    const auto error = quiesce_error;
+    quiesce_work = nullptr;
+    quiesce_cv.notify_all();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -49,22 +49,30 @@ SysdarftCPUInstructionExecutor::SysdarftCPUInstructionExecutor()
 
 void SysdarftCPUInstructionExecutor::execute(const __uint128_t timestamp)
 {
-    auto [opcode, width, operands, literal]
-        = SysdarftCPUInstructionDecoder::pop_instruction_from_ip_and_increase_ip();
+    // the disassembly is only for the trace
+#if SYSDARFT_LOG_LEVEL <= SYSDARFT_LOG_TRACE
+    const bool with_literal = debug::log_enabled(debug::log_subsystem_t::CPU, debug::log_level_t::TRACE);
+#else
+    constexpr bool with_literal = false;
+#endif
+
+    auto [opcode, width, operands, mnemonic, literal]
+        = SysdarftCPUInstructionDecoder::pop_instruction_from_ip_and_increase_ip(with_literal);
 
     WidthAndOperandsType Arg = std::make_pair(width, operands);
 
     // FIXME: Mask FPU and Signed output
-    log("[CPU] ", literal, "\n");
+    log_trace(CPU, "[CPU] ", literal, "\n");
 
     if (is_break_here()) {
-        log("[CPU] Breakpoint reached!\n");
+        log_debug(CPU, "[CPU] Breakpoint reached!\n");
         breakpoint_handler(timestamp, opcode, Arg);
     }
 
     try {
         (this->*ExecutorMap.at(opcode))(timestamp, Arg);
     } catch (std::out_of_range&) {
-        log("[CPU] Instruction `", literal, "` not implemented.\n");
+        log_warning(CPU, "[CPU] Instruction `", with_literal ? std::string_view(literal) : mnemonic,
+            "` not implemented.\n");
     }
 }
@@ -1,7 +1,12 @@
 #include <SysdarftMemory.h>
+#include <SysdarftIOHub.h>
 #include <cstring>
 #include <mutex>
 
+// RAM is handed to devices as one span
+static_assert(sizeof(std::array<uint8_t, BLOCK_SIZE>) == BLOCK_SIZE);
+static_assert(BLOCK_SIZE == SysdarftIOHub::page_size);
+
 SysdarftCPUMemoryAccess::SysdarftCPUMemoryAccess()
 {
     // We assume TotalMemory and BLOCK_SIZE are defined in the header.
@@ -20,8 +25,20 @@ SysdarftCPUMemoryAccess::SysdarftCPUMemoryAccess()
     }
 }
 
+void SysdarftCPUMemoryAccess::attach_io_hub(SysdarftIOHub & hub)
+{
+    std::lock_guard<std::mutex> lock(MemoryAccessMutex);
+    hub.attach_memory(std::span(Memory.front().data(), Memory.size() * BLOCK_SIZE));
+    IOHub = &hub;
+}
+
 void SysdarftCPUMemoryAccess::read_memory(const uint64_t address, char* _dest, const uint64_t size)
 {
+    // device handlers run outside the lock, they may access RAM themselves
+    if (IOHub != nullptr && IOHub->mmio_read(address, _dest, size)) {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(MemoryAccessMutex);
 
     // Basic range check
@@ -67,6 +84,10 @@ void SysdarftCPUMemoryAccess::read_memory(const uint64_t address, char* _dest, c
 
 void SysdarftCPUMemoryAccess::write_memory(const uint64_t address, const char* _source, const uint64_t size)
 {
+    if (IOHub != nullptr && IOHub->mmio_write(address, _source, size)) {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(MemoryAccessMutex);
 
     // Basic range check
@@ -1,6 +1,6 @@
 #include <chrono>
 #include <thread>
-#include <WorkerThread.h>
+#include <SysdarftExecutor.h>
 #include <cpu.h>
 
 void processor::triggerer_thread(std::atomic<bool> & running)
@@ -12,6 +12,10 @@
 #define REGISTER_PREFIX (0x01)
 #define CONSTANT_PREFIX (0x02)
 #define MEMORY_PREFIX   (0x03)
+#define MEMORY_REGISTER_PREFIX (0x04)   // compact memory operand made of registers and zeros
+
+// Parameter of a MEMORY_REGISTER_PREFIX operand standing for $(0) instead of a register index
+#define MEMORY_ZERO_PARAMETER (0xFF)
 
 // Special Registers
 #define R_StackBase                     (0xA0)
@@ -22,10 +26,17 @@
 #define R_ExtendedBase                  (0xA5)
 #define R_ExtendedPointer               (0xA6)
 
+#include <array>
+#include <charconv>
+#include <cctype>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
 #include <vector>
 #include <SysdarftDebug.h>
 
@@ -43,26 +54,18 @@ public:
         SysdarftBaseError("Invalid argument provided: " + message) { }
 };
 
+class InstructionExpressionError final : public SysdarftBaseError {
+public:
+    explicit InstructionExpressionError(const std::string& message) :
+        SysdarftBaseError("Instruction Expression Error: " + message) { }
+};
+
 class CodeBufferEmptiedWhenPop final : public SysdarftBaseError {
 public:
     explicit CodeBufferEmptiedWhenPop(const std::string & msg) :
         SysdarftBaseError("Code buffer emptied before pop finished: " + msg) { }
 };
 
-inline std::string & remove_space(std::string & str)
-{
-    std::erase(str, ' ');
-    return str;
-}
-
-// Function to convert a string to uppercase
-inline std::string & capitalization(std::string& input)
-{
-    std::ranges::transform(input, input.begin(),
-                           [](const unsigned char c) { return std::toupper(c); });
-    return input;
-}
-
 template < unsigned int LENGTH >
 void code_buffer_push(std::vector<uint8_t> & buffer, const void * value)
 {
@@ -92,20 +95,60 @@ inline void code_buffer_push64(std::vector<uint8_t> & buffer, const uint64_t val
     code_buffer_push<64>(buffer, &value);
 }
 
+// Cursor based store into a buffer already sized for the encoding, advances the cursor
 template < typename DataType >
-DataType code_buffer_pop(std::vector < uint8_t > & input)
+void code_buffer_store(uint8_t *& output, const DataType value)
 {
-    DataType Return;
-    for (uint64_t i = 0; i < sizeof(DataType); i++)
+    std::memcpy(output, &value, sizeof(DataType));
+    output += sizeof(DataType);
+}
+
+// Cursor based pop: reads at offset and advances it, the buffer itself is left untouched
+template < typename DataType >
+DataType code_buffer_pop(const std::span < const uint8_t > input, uint64_t & offset)
+{
+    if (offset > input.size() || input.size() - offset < sizeof(DataType))
     {
-        if (input.empty()) {
-            throw CodeBufferEmptiedWhenPop("No data left before pop finished!");
-        }
+        offset = input.size();
+        throw CodeBufferEmptiedWhenPop("No data left before pop finished!");
+    }
+
+    DataType Return;
+    std::memcpy(&Return, input.data() + offset, sizeof(DataType));
+    offset += sizeof(DataType);
+    return Return;
+}
+
+inline uint8_t code_buffer_pop8(const std::span < const uint8_t > buffer, uint64_t & offset) {
+    return code_buffer_pop<uint8_t>(buffer, offset);
+}
+
+inline uint16_t code_buffer_pop16(const std::span < const uint8_t > buffer, uint64_t & offset) {
+    return code_buffer_pop<uint16_t>(buffer, offset);
+}
+
+inline uint32_t code_buffer_pop32(const std::span < const uint8_t > buffer, uint64_t & offset) {
+    return code_buffer_pop<uint32_t>(buffer, offset);
+}
+
+inline uint64_t code_buffer_pop64(const std::span < const uint8_t > buffer, uint64_t & offset) {
+    return code_buffer_pop<uint64_t>(buffer, offset);
+}
 
-        ((uint8_t*)(&Return))[i] = input.front();
-        input.erase(input.begin());
+// Pops from the front of the vector. Every pop moves the whole remaining buffer,
+// decode long buffers with the cursor based functions above instead
+template < typename DataType >
+DataType code_buffer_pop(std::vector < uint8_t > & input)
+{
+    if (input.size() < sizeof(DataType))
+    {
+        input.clear();
+        throw CodeBufferEmptiedWhenPop("No data left before pop finished!");
     }
 
+    DataType Return;
+    std::memcpy(&Return, input.data(), sizeof(DataType));
+    input.erase(input.begin(), input.begin() + sizeof(DataType));
     return Return;
 }
 
@@ -140,8 +183,146 @@ struct SYSDARFT_EXPORT_SYMBOL parsed_target_t
     } memory { };
 };
 
+// Register or constant, as found by the lexer
+struct SYSDARFT_EXPORT_SYMBOL lexed_target_t
+{
+    enum { NOTaValidType, REGISTER, CONSTANT, MEMORY } TargetType { };
+    std::size_t Column { };                     // 1-based column in the source line
+    uint8_t RegisterWidth { };                  // width prefix of the register
+    uint8_t RegisterIndex { };                  // register index, or R_* for special registers
+    std::string_view ConstantExpression { };    // text between $( and )
+};
+
+// Full operand, memory operands carry three register or constant parameters
+struct SYSDARFT_EXPORT_SYMBOL lexed_operand_t : lexed_target_t
+{
+    uint8_t MemoryWidth { };                    // width prefix of the access
+    uint8_t MemoryAccessRatio { };              // packed BCD ratio
+    std::array < lexed_target_t, 3 > MemoryParameters { };
+};
+
+// Views into the source line, valid as long as the line is
+struct SYSDARFT_EXPORT_SYMBOL lexed_instruction_t
+{
+    std::string_view Mnemonic { };
+    std::size_t MnemonicColumn { };
+    uint8_t Width { };                          // 0 when no width was specified
+    std::size_t WidthColumn { };
+    std::vector < lexed_operand_t > Operands { };
+};
+
+void SYSDARFT_EXPORT_SYMBOL lex_instruction(std::string_view, lexed_instruction_t &);
+lexed_operand_t lex_operand(std::string_view);
+
+struct SYSDARFT_EXPORT_SYMBOL constant_value_t
+{
+    enum { INTEGER, FLOAT } ValueType { };
+    __int128_t IntegerValue { };
+    double FloatValue { };
+};
+
+// looks up a symbol referenced by a constant expression, returns false if it is undefined
+using symbol_resolver_t = std::function<bool(std::string_view, constant_value_t &)>;
+
+// evaluate the content of a $(...) operand (hex, decimal, floats, symbols, + - * / % ^ and parentheses)
+constant_value_t SYSDARFT_EXPORT_SYMBOL evaluate_constant_expression(std::string_view,
+    const symbol_resolver_t & = nullptr);
+// 64bit operand encoding of an evaluated constant
+uint64_t SYSDARFT_EXPORT_SYMBOL constant_value_to_operand(const constant_value_t &);
+
+// The standard encoding stores every constant in 8 bytes. The compact one stores integer
+// literals in 1, 2 or 4 zero extended bytes when they fit (width prefix 0x08, 0x16, 0x32), and
+// memory operands made of 64bit registers and literal zeros as MEMORY_REGISTER_PREFIX, width,
+// three register indexes or MEMORY_ZERO_PARAMETER, and ratio. Constants using symbols keep
+// 8 bytes, so their size is known before the symbols are. Decoders accept both encodings, the
+// choice is made per image by whoever encodes it
+enum encoding_mode_t { STANDARD_ENCODING, COMPACT_ENCODING };
+
+// The pointer versions write at a cursor into memory holding at least the encoded size
+void encode_operand(uint8_t *&, const lexed_operand_t &, const symbol_resolver_t & = nullptr,
+    encoding_mode_t = STANDARD_ENCODING);
+void encode_operand(std::vector<uint8_t> &, const lexed_operand_t &, const symbol_resolver_t & = nullptr,
+    encoding_mode_t = STANDARD_ENCODING);
+// encoded sizes, known without resolving any symbol
+uint64_t encoded_target_size(const lexed_target_t &, encoding_mode_t = STANDARD_ENCODING);
+uint64_t encoded_operand_size(const lexed_operand_t &, encoding_mode_t = STANDARD_ENCODING);
+uint64_t encoded_instruction_size(const lexed_instruction_t &, encoding_mode_t = STANDARD_ENCODING);
+void encode_lexed_instruction(uint8_t *&, const lexed_instruction_t &, std::string_view,
+    const symbol_resolver_t & = nullptr, encoding_mode_t = STANDARD_ENCODING);
+void encode_lexed_instruction(std::vector<uint8_t> &, const lexed_instruction_t &, std::string_view,
+    const symbol_resolver_t & = nullptr, encoding_mode_t = STANDARD_ENCODING);
 parsed_target_t encode_target(std::vector<uint8_t> &, const std::string&);
-void SYSDARFT_EXPORT_SYMBOL encode_instruction(std::vector<uint8_t> &, const std::string &);
+void SYSDARFT_EXPORT_SYMBOL encode_instruction(std::vector<uint8_t> &, const std::string &,
+    encoding_mode_t = STANDARD_ENCODING);
+
+// Lexer output reused by encode_instructions(), one block of lines at a time. Keeping the arena
+// between calls keeps the operand storage, so steady state encoding does not allocate
+struct SYSDARFT_EXPORT_SYMBOL encoding_arena_t
+{
+    static constexpr std::size_t block_lines = 1024;
+    std::vector < lexed_instruction_t > instructions;
+};
+
+// Encodes lines back to back at the end of buffer, growing it once per block of lines; reserve
+// the buffer beforehand to avoid reallocations entirely. offsets receives the offset of every
+// line in buffer, followed by the end offset, for listings. On error buffer and offsets are
+// restored to their previous size and the error of the first bad line is thrown
+void SYSDARFT_EXPORT_SYMBOL encode_instructions(std::vector<uint8_t> & buffer,
+    std::span < const std::string_view > lines, encoding_arena_t & arena, std::vector < uint64_t > & offsets,
+    const symbol_resolver_t & resolver = nullptr, encoding_mode_t mode = STANDARD_ENCODING);
+
+// Destination of decoded text. Without a string only the cursor advances, which finds
+// instruction boundaries without paying for the formatting
+class decode_output_t
+{
+private:
+    std::string * text;
+
+public:
+    explicit decode_output_t(std::string * _text = nullptr) : text(_text) { }
+
+    [[nodiscard]] bool formatting() const {
+        return text != nullptr;
+    }
+
+    void append(const std::string_view str) {
+        if (text) { text->append(str); }
+    }
+
+    void append_decimal(const uint64_t value)
+    {
+        if (!text) { return; }
+        char buffer[24];
+        text->append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+    }
+
+    void append_hex(const uint64_t value)
+    {
+        if (!text) { return; }
+        char buffer[24];
+        const auto end = std::to_chars(buffer, buffer + sizeof(buffer), value, 16).ptr;
+        std::transform(buffer, end, buffer, [](const char ch) { return static_cast<char>(std::toupper(ch)); });
+        text->append(buffer, end);
+    }
+
+    void append_float(const double value)
+    {
+        if (!text) { return; }
+        char buffer[512];
+        text->append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 16).ptr);
+    }
+};
+
+// decode one target/instruction at offset and advance offset past it, linear in the buffer size
+void decode_target(decode_output_t &, std::span<const uint8_t>, uint64_t &);
+void decode_target(std::vector<std::string> &, std::span<const uint8_t>, uint64_t &);
+// appends the text to output, "(bad)" if the instruction cannot be decoded
+void SYSDARFT_EXPORT_SYMBOL decode_instruction(std::string &, std::span<const uint8_t>, uint64_t &);
+void SYSDARFT_EXPORT_SYMBOL decode_instruction(std::vector < std::string > &,
+    std::span<const uint8_t>, uint64_t &);
+// advance offset exactly as decode_instruction() would, without formatting anything
+void SYSDARFT_EXPORT_SYMBOL skip_instruction(std::span<const uint8_t>, uint64_t &);
+// compatibility wrappers, decode from the front of the buffer and erase what was decoded
 void decode_target(std::vector<std::string> &, std::vector<uint8_t> &);
 void SYSDARFT_EXPORT_SYMBOL decode_instruction(std::vector < std::string > &,
     std::vector<uint8_t> &);
@@ -1,6 +1,7 @@
 #ifndef GLOBAL_EVENT_H
 #define GLOBAL_EVENT_H
 
+#include <cstdint>
 #include <SysdarftMessageMap.h>
 #include <SysdarftDebug.h>
 
@@ -10,6 +11,8 @@
 #define UI_SET_CURSOR_METHOD_NAME               "set_cursor"
 #define UI_GET_CURSOR_METHOD_NAME               "get_cursor"
 #define UI_DISPLAY_CHAR_METHOD_NAME             "display_char"
+#define UI_DISPLAY_REGION_METHOD_NAME           "display_region"
+#define UI_SCROLL_METHOD_NAME                   "scroll"
 #define UI_SET_CURSOR_VISIBILITY_METHOD_NAME    "set_cursor_visibility"
 #define UI_INPUT_PROCESSOR_METHOD_NAME          "input_processor"
 
@@ -30,19 +33,33 @@ struct SYSDARFT_EXPORT_SYMBOL CursorPosition
                 instance_name, &instance,                               \
                 method_name, &decltype(instance)::method)
 
-#define g_ui_cleanup() GlobalEventProcessor(UI_INSTANCE_NAME, UI_CLEANUP_METHOD_NAME)()
+// Handle resolved on the first call at each call site, see SysdarftMessageMap::handle()
+#define _g_method(signature, instance_name, method_name)                                    \
+    ([]() -> const auto & {                                                                 \
+        static const auto handle = GlobalEventProcessor.handle<signature>(instance_name, method_name); \
+        return handle;                                                                      \
+    }())
+
+#define g_ui_cleanup() _g_method(void(), UI_INSTANCE_NAME, UI_CLEANUP_METHOD_NAME)()
 #define g_ui_cleanup_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_CLEANUP_METHOD_NAME, method)
-#define g_ui_initialize() GlobalEventProcessor(UI_INSTANCE_NAME, UI_INITIALIZE_METHOD_NAME)()
+#define g_ui_initialize() _g_method(void(), UI_INSTANCE_NAME, UI_INITIALIZE_METHOD_NAME)()
 #define g_ui_initialize_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_INITIALIZE_METHOD_NAME, method)
-#define g_ui_set_cursor(x, y) GlobalEventProcessor(UI_INSTANCE_NAME, UI_SET_CURSOR_METHOD_NAME)(x, y)
+#define g_ui_set_cursor(x, y) _g_method(void(int, int), UI_INSTANCE_NAME, UI_SET_CURSOR_METHOD_NAME)(x, y)
 #define g_ui_set_cursor_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_SET_CURSOR_METHOD_NAME, method)
-#define g_ui_get_cursor() std::any_cast<CursorPosition>(GlobalEventProcessor(UI_INSTANCE_NAME, UI_GET_CURSOR_METHOD_NAME)())
+#define g_ui_get_cursor() _g_method(CursorPosition(), UI_INSTANCE_NAME, UI_GET_CURSOR_METHOD_NAME)()
 #define g_ui_get_cursor_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_GET_CURSOR_METHOD_NAME, method)
-#define g_ui_display_char(x, y, ch) GlobalEventProcessor(UI_INSTANCE_NAME, UI_DISPLAY_CHAR_METHOD_NAME)(x, y, ch)
+#define g_ui_display_char(x, y, ch) _g_method(void(int, int, int), UI_INSTANCE_NAME, UI_DISPLAY_CHAR_METHOD_NAME)(x, y, ch)
 #define g_ui_display_char_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_DISPLAY_CHAR_METHOD_NAME, method)
-#define g_ui_set_cur_vsb(vsb) GlobalEventProcessor(UI_INSTANCE_NAME, UI_SET_CURSOR_VISIBILITY_METHOD_NAME)(vsb)
+// cells is h rows of w characters, rows start stride bytes apart
+#define g_ui_display_region(x, y, w, h, cells, stride) \
+    _g_method(void(int, int, int, int, const uint8_t *, int), UI_INSTANCE_NAME, UI_DISPLAY_REGION_METHOD_NAME)(x, y, w, h, cells, stride)
+#define g_ui_display_region_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_DISPLAY_REGION_METHOD_NAME, method)
+// move the screen content up by lines (down if negative), blanking the lines uncovered
+#define g_ui_scroll(lines) _g_method(void(int), UI_INSTANCE_NAME, UI_SCROLL_METHOD_NAME)(lines)
+#define g_ui_scroll_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_SCROLL_METHOD_NAME, method)
+#define g_ui_set_cur_vsb(vsb) _g_method(void(bool), UI_INSTANCE_NAME, UI_SET_CURSOR_VISIBILITY_METHOD_NAME)(vsb)
 #define g_ui_set_cur_vsb_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_SET_CURSOR_VISIBILITY_METHOD_NAME, method)
-#define g_input_processor(ch) GlobalEventProcessor(UI_INSTANCE_NAME, UI_INPUT_PROCESSOR_METHOD_NAME)(ch)
+#define g_input_processor(ch) _g_method(void(int), UI_INSTANCE_NAME, UI_INPUT_PROCESSOR_METHOD_NAME)(ch)
 #define g_input_processor_install(instance, method) _g_method_install(UI_INSTANCE_NAME, instance, UI_INPUT_PROCESSOR_METHOD_NAME, method)
 
 #endif //GLOBAL_EVENT_H
@@ -0,0 +1,182 @@
+#ifndef SYSDARFT_ASSEMBLER_H
+#define SYSDARFT_ASSEMBLER_H
+
+#include <iosfwd>
+#include <map>
+#include <unordered_map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <SysdarftDebug.h>
+#include <SysdarftMemory.h>
+#include <EncodingDecoding.h>
+
+class SysdarftAssemblerError final : public SysdarftBaseError
+{
+    std::string description;
+
+public:
+    explicit SysdarftAssemblerError(const std::string & message) :
+        SysdarftBaseError("Assembler error: " + message), description(message) { }
+
+    // without the "Assembler error" prefix, so that a located error carries it once
+    [[nodiscard]] const std::string & message() const noexcept override { return description; }
+};
+
+class SysdarftRelocationError final : public SysdarftBaseError
+{
+public:
+    explicit SysdarftRelocationError(const std::string & message) :
+        SysdarftBaseError("Relocation error: " + message) { }
+};
+
+class SysdarftLinkerError final : public SysdarftBaseError
+{
+public:
+    explicit SysdarftLinkerError(const std::string & message) :
+        SysdarftBaseError("Linker error: " + message) { }
+};
+
+// Value of a symbol inside an object: absolute, or an offset into one of its sections
+struct assembler_value_t
+{
+    constant_value_t Value { };
+    int64_t Section = -1;                       // -1 for absolute values
+};
+
+// The 64bit constant at Offset in Section is patched to address(target) + Addend when linking.
+// The target is a section of the same object, or a global symbol of any object
+struct object_relocation_t
+{
+    uint64_t Section { };
+    uint64_t Offset { };
+    int64_t TargetSection = -1;                 // -1 when the target is the external Symbol
+    std::string Symbol { };
+    uint64_t Addend { };
+};
+
+struct object_section_t
+{
+    std::string Name;
+    std::vector < uint8_t > Code;
+};
+
+struct object_symbol_t
+{
+    std::string Name;
+    bool Global { };
+    assembler_value_t Value;
+};
+
+// Relocatable object, the unit sysdarft-as --relocatable writes and sysdarft-ld links
+struct SYSDARFT_EXPORT_SYMBOL sysdarft_object_t
+{
+    std::string Name;                           // source file, for error messages
+    uint64_t SourceHash { };                    // SysdarftAssembler::source_hash() of its source
+    std::vector < object_section_t > Sections;
+    std::vector < object_symbol_t > Symbols;
+    std::vector < object_relocation_t > Relocations;
+
+    void save(const std::string & path) const;
+    static sysdarft_object_t load(const std::string & path);
+
+    // SourceHash of an object file without loading the rest, 0 if there is no readable object
+    static uint64_t peek_source_hash(const std::string & path);
+};
+
+// 64bit FNV-1a, stable across builds so it can be kept on disk
+uint64_t SYSDARFT_EXPORT_SYMBOL assembler_hash(std::string_view text);
+
+// Lays out the sections of all objects by name, in order of first appearance, starting at
+// origin, and resolves all relocations. symbols receives the final value of every symbol,
+// global ones first, then local ones not shadowed by another symbol of the same name
+std::vector < uint8_t > SYSDARFT_EXPORT_SYMBOL link_objects(std::span < const sysdarft_object_t > objects,
+    uint64_t origin, std::map < std::string, constant_value_t, std::less<> > & symbols);
+
+/*
+ * Two-pass assembler producing relocatable objects and flat images. Source syntax, one
+ * statement per line:
+ *
+ *   ; comment until the end of the line
+ *   label:                       ; address of the next instruction in the current section
+ *   .equ NAME, <expression>      ; symbolic constant, may reference labels and other constants
+ *   .section NAME                ; switch sections, the default one is .text
+ *   .global NAME[, NAME...]      ; make symbols visible to other objects
+ *   mov .64bit <%FER0>, <$(label + NAME * 2)>
+ *
+ * Pass one lexes every line and computes the instruction sizes, which only depend on the
+ * operand kinds. Labels are then laid out and constants resolved, and pass two encodes the
+ * instructions with every symbol known. Both passes work on independent chunks of lines,
+ * spread over the worker threads.
+ *
+ * Addresses are only known once the sections are placed, so a constant operand depending on
+ * one must have the form address + constant and becomes a relocation. Symbols not defined in
+ * the source are taken as external. A flat image is the object of the source linked alone.
+ *
+ * Encoded lines are cached, keyed by a hash of their text. A line is only encoded again when
+ * its text is new or one of the symbols it referenced changed value, so reassembling an edited
+ * source costs roughly the edit. The cache can be saved to and loaded from disk.
+ */
+struct assembler_cache_entry_t
+{
+    std::string text;                           // instruction text, to rule out hash collisions
+    uint64_t size { };
+    std::vector < uint8_t > code;
+    std::vector < std::pair < std::string, assembler_value_t > > references;  // symbols and the values used
+    std::vector < object_relocation_t > relocations;  // Offset relative to the line, Section unused
+    uint64_t generation { };                    // last assembly that used the entry
+};
+
+struct assembler_statistics_t
+{
+    uint64_t instructions;                      // instructions in the last assembled source
+    uint64_t encoded;                           // of which were (re)encoded
+};
+
+class SYSDARFT_EXPORT_SYMBOL SysdarftAssembler
+{
+private:
+    uint64_t origin;
+    unsigned int threads;
+    encoding_mode_t mode;
+    std::map < std::string, constant_value_t, std::less<> > symbols;
+    std::map < std::string, std::size_t, std::less<> > externals;  // first line referencing each one
+    std::unordered_map < uint64_t, assembler_cache_entry_t > cache;
+    uint64_t generation = 0;
+    assembler_statistics_t statistics { };
+
+    // entries of a cache file after its magic, throws on anything it cannot use
+    void read_cache(std::ifstream & file, const std::string & path);
+
+public:
+    // threads == 0 uses one thread per hardware thread
+    explicit SysdarftAssembler(uint64_t _origin = BIOS_START, unsigned int _threads = 0,
+        encoding_mode_t _mode = STANDARD_ENCODING);
+
+    // assemble a source file into a relocatable object, file_name is used in error messages
+    sysdarft_object_t assemble_object(std::string_view source, const std::string & file_name = "<input>");
+
+    // identifies the object built from source with the settings of this assembler
+    [[nodiscard]] uint64_t source_hash(std::string_view source) const;
+
+    // assemble a whole program into a flat image mapped at the origin
+    std::vector < uint8_t > assemble(std::string_view source, const std::string & file_name = "<input>");
+
+    // labels and constants of the last flat image
+    [[nodiscard]] const std::map < std::string, constant_value_t, std::less<> > & get_symbols() const {
+        return symbols;
+    }
+
+    [[nodiscard]] assembler_statistics_t get_statistics() const {
+        return statistics;
+    }
+
+    // persist the line cache between runs, load_cache() returns false if the file is missing, damaged,
+    // or was written by another version or for another encoding mode
+    bool load_cache(const std::string & path);
+    void save_cache(const std::string & path) const;
+};
+
+#endif // SYSDARFT_ASSEMBLER_H
@@ -0,0 +1,180 @@
+#ifndef SYSDARFT_ASYNC_LOG_H
+#define SYSDARFT_ASYNC_LOG_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Asynchronous back-end of log()
+//
+// While it is running log() does not print. It encodes its arguments into a record in a ring buffer of the
+// calling thread: the print function instantiated for the argument types, standing for the format, and the raw
+// argument values, text copied. A writer thread drains all rings and prints the records exactly as log() would
+// have. Every thread's records appear in order, records of different threads are interleaved per batch.
+//
+// Rings have a fixed size. A record that does not fit is dropped and counted, logging never blocks or allocates
+// once the thread's ring and scratch buffer have grown.
+namespace debug
+{
+    void SYSDARFT_EXPORT_SYMBOL start_async_log(std::size_t ring_size = 64 * 1024);
+    // prints everything logged before it was called
+    void SYSDARFT_EXPORT_SYMBOL stop_async_log();
+    void SYSDARFT_EXPORT_SYMBOL flush_log();
+    uint64_t SYSDARFT_EXPORT_SYMBOL dropped_log_records();
+
+    extern std::atomic<bool> SYSDARFT_EXPORT_SYMBOL async_log_enabled;
+
+    namespace async
+    {
+        using print_t = void (*)(const uint8_t * payload);
+
+        // encode buffer of the calling thread
+        SYSDARFT_EXPORT_SYMBOL std::vector<uint8_t> & scratch();
+        // move the encoded arguments into the calling thread's ring, or count a drop
+        void SYSDARFT_EXPORT_SYMBOL commit(print_t print);
+
+        template <typename T>
+        void put(std::vector<uint8_t> & out, const T & value)
+        {
+            const auto * bytes = reinterpret_cast<const uint8_t *>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <typename T>
+        T get(const uint8_t *& in)
+        {
+            T value;
+            std::memcpy(&value, in, sizeof(T));
+            in += sizeof(T);
+            return value;
+        }
+
+        inline void put_text(std::vector<uint8_t> & out, const std::string_view text)
+        {
+            put<uint64_t>(out, text.size());
+            out.insert(out.end(), text.begin(), text.end());
+        }
+
+        inline std::string_view get_text(const uint8_t *& in)
+        {
+            const auto size = get<uint64_t>(in);
+            const std::string_view text(reinterpret_cast<const char *>(in), size);
+            in += size;
+            return text;
+        }
+
+        // a value printed with operator<<, formatted by the caller unless it is a number or text
+        template <typename T>
+        void put_streamed(std::vector<uint8_t> & out, const T & value)
+        {
+            if constexpr (std::is_arithmetic_v<T>) {
+                put(out, value);
+            } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+                put_text(out, std::string_view(value));
+            } else {
+                thread_local std::ostringstream formatted;
+                formatted.str({ });
+                formatted << value;
+                put_text(out, formatted.view());
+            }
+        }
+
+        template <typename T>
+        void print_streamed(const uint8_t *& in)
+        {
+            if constexpr (std::is_arithmetic_v<T>) {
+                std::cout << get<T>(in);
+            } else {
+                std::cout << get_text(in);
+            }
+        }
+
+        template <typename Container>
+        using element_t = std::remove_cvref_t<decltype(*std::begin(std::declval<const Container &>()))>;
+
+        // the cases of _log()
+        template <typename T>
+        void put_argument(std::vector<uint8_t> & out, const T & value)
+        {
+            if constexpr (is_string_v<T>) {
+                put_text(out, value);
+            } else if constexpr (is_map_v<T> || is_unordered_map_v<T>) {
+                put<uint64_t>(out, value.size());
+                for (const auto & [key, mapped] : value) {
+                    put_streamed(out, key);
+                    put_streamed(out, mapped);
+                }
+            } else if constexpr (is_container_v<T>) {
+                put<uint64_t>(out, std::distance(std::begin(value), std::end(value)));
+                for (const auto & element : value) {
+                    put_streamed<element_t<T>>(out, element);
+                }
+            } else if constexpr (std::is_same_v<T, __uint128_t>) {
+                put(out, value);
+            } else {
+                put_streamed(out, value);
+            }
+        }
+
+        template <typename T>
+        void print_argument(const uint8_t *& in)
+        {
+            if constexpr (is_string_v<T>) {
+                std::cout << get_text(in);
+            } else if constexpr (is_map_v<T> || is_unordered_map_v<T>) {
+                std::cout << "{";
+                for (auto count = get<uint64_t>(in); count > 0; count--)
+                {
+                    print_streamed<typename T::key_type>(in);
+                    std::cout << ": ";
+                    print_streamed<typename T::mapped_type>(in);
+                    if (count > 1) {
+                        std::cout << ", ";
+                    }
+                }
+                std::cout << "}";
+            } else if constexpr (is_container_v<T>) {
+                std::cout << "[";
+                for (auto count = get<uint64_t>(in); count > 0; count--)
+                {
+                    print_streamed<element_t<T>>(in);
+                    if (count > 1) {
+                        std::cout << ", ";
+                    }
+                }
+                std::cout << "]";
+            } else if constexpr (std::is_same_v<T, __uint128_t>) {
+                _log(get<__uint128_t>(in));
+            } else {
+                print_streamed<T>(in);
+            }
+        }
+
+        template <typename... Args>
+        void print_record(const uint8_t * payload)
+        {
+            (print_argument<Args>(payload), ...);
+        }
+    }
+
+    template <typename... Args>
+    void _log_dispatch(const Args &... args)
+    {
+        if (async_log_enabled.load(std::memory_order_relaxed))
+        {
+            auto & out = async::scratch();
+            out.clear();
+            (async::put_argument(out, args), ...);
+            async::commit(&async::print_record<Args...>);
+            return;
+        }
+
+        _log(args...);
+    }
+}
+
+#endif // SYSDARFT_ASYNC_LOG_H
@@ -5,7 +5,7 @@
 #include <memory>
 #include <EncodingDecoding.h>
 #include <SysdarftRegister.h>
-#include <WorkerThread.h>
+#include <SysdarftExecutor.h>
 
 inline unsigned long long operator"" _Hz(const unsigned long long freq) {
     return freq;
@@ -1,6 +1,7 @@
 #ifndef SYSDARFTCPUINSTRUCTIONDECODER_H
 #define SYSDARFTCPUINSTRUCTIONDECODER_H
 
+#include <array>
 #include <SysdarftDebug.h>
 #include <SysdarftRegister.h>
 #include <SysdarftMemory.h>
@@ -52,6 +53,7 @@ class SYSDARFT_EXPORT_SYMBOL OperandType
 {
 protected:
     DecoderDataAccess & Access;
+    const bool with_literal;
 
     enum OperandType_t { NaO, RegisterOperand, ConstantOperand, MemoryOperand };
 
@@ -101,9 +103,14 @@ protected:
     void store_value_to_register_based_on_table(uint64_t value);
     void store_value_to_memory_based_on_table(uint64_t value);
 
+    void set_register(uint8_t width, uint8_t register_index);
+    void set_memory(uint8_t WidthBCD, uint8_t ratio,
+        const std::array < uint64_t, 3 > & parameters, const std::array < std::string, 3 > & literals);
+
     void do_decode_register_without_prefix();
     void do_decode_constant_without_prefix();
     void do_decode_memory_without_prefix();
+    void do_decode_register_memory_without_prefix();
     void do_decode_operand();
 
     uint64_t do_access_operand_based_on_table();
@@ -113,7 +120,9 @@ public:
     [[nodiscard]] uint64_t get_val() { return do_access_operand_based_on_table(); }
     void set_val(const uint64_t val) { store_value_to_operand_based_on_table(val); }
     [[nodiscard]] std::string get_literal() const { return OperandReferenceTable.literal; }
-    explicit OperandType(DecoderDataAccess & Access_) : Access(Access_) { do_decode_operand(); }
+    // literal stays empty unless with_literal_ is set, building it costs more than decoding
+    explicit OperandType(DecoderDataAccess & Access_, const bool with_literal_ = true)
+        : Access(Access_), with_literal(with_literal_) { do_decode_operand(); }
 };
 
 class SYSDARFT_EXPORT_SYMBOL SysdarftCPUInstructionDecoder : public DecoderDataAccess
@@ -123,13 +132,15 @@ protected:
         uint8_t opcode;
         uint8_t width;
         std::vector< OperandType > operands;
+        std::string_view mnemonic;
         std::string literal; // again, literals for FPU and signed operations are all wrong
                              // it will remain this way to reduce the complicity
                              // manually output these instruction literals
                              // instead of relying on automatic literalization
     };
 
-    ActiveInstructionType pop_instruction_from_ip_and_increase_ip();
+    // literal is only built with with_literal, the mnemonic is always there
+    ActiveInstructionType pop_instruction_from_ip_and_increase_ip(bool with_literal = true);
 };
 
 #endif //SYSDARFTCPUINSTRUCTIONDECODER_H
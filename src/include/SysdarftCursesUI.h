@@ -2,29 +2,38 @@
 #define UI_CURSES_H
 
 #include <array>
-#include <mutex>
 #include <atomic>
+#include <vector>
 #include <SysdarftDebug.h>
 #include <GlobalEvents.h>
-#include <WorkerThread.h>
-
-// -----------------------------------------------------
-// Virtual screen dimensions
-// -----------------------------------------------------
-static constexpr int V_WIDTH  = 127;
-static constexpr int V_HEIGHT = 31;
+#include <SysdarftUIEventQueue.h>
+#include <SysdarftTextFramebuffer.h>
+#include <SysdarftExecutor.h>
 
 class SYSDARFT_EXPORT_SYMBOL SysdarftCursesUI
 {
 private:
-    std::array< std::array<int, V_HEIGHT>, V_WIDTH> video_memory = { ' ' };
-    std::atomic<bool> video_memory_changed = false;
-    std::mutex g_data_mutex;
+    // owned by the renderer thread, other threads post changes through events
+    SysdarftTextFramebuffer video_memory;
+    bool cursor_visible = true;
+    SysdarftUIEventQueue events;
+    ui_frame_t frame;
+
+    // What the terminal shows. Only the cells that differ from video_memory are written. It is invalid
+    // after the terminal was resized or the picture moved
+    SysdarftTextFramebuffer on_screen;
+    bool on_screen_valid = false;
+    int shown_rows = -1, shown_cols = -1, shown_offset_x = -1, shown_offset_y = -1;
+    std::vector < ui_span_t > spans;
 
     std::atomic<int> offset_x = 0;
     std::atomic<int> offset_y = 0;
 
-    WorkerThread renderer;
+    // frames per second at most, events arriving faster are coalesced. 0 draws every change at once
+    std::atomic<int> frame_rate = 60;
+    std::atomic<bool> stopping = false;
+
+    SysdarftThread renderer;
 
     std::atomic<CursorPosition> current_cursor_position = { };
 
@@ -33,16 +42,21 @@ private:
     void monitor_input();
     void render_screen();
     void recalc_offsets(int rows, int cols);
+    bool apply_events();
+    bool handle_input();
 
 public:
-    SysdarftCursesUI() : renderer(this, &SysdarftCursesUI::run) { }
+    SysdarftCursesUI() : renderer("UI Runner", this, &SysdarftCursesUI::run, executor::core_for(thread_role_t::UI)) { }
 
     void cleanup();
     void initialize();
     void set_cursor(int, int);
     CursorPosition get_cursor();
     void display_char(int, int, int);
+    void display_region(int, int, int, int, const uint8_t *, int);
+    void scroll(int);
     void set_cursor_visibility(bool);
+    void set_frame_rate(int fps);
 };
 
 #endif //UI_CURSES_H
@@ -8,6 +8,7 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <pthread.h>
 #include <regex>
@@ -38,6 +39,9 @@ namespace debug
     // returns current timesstamp
     std::string SYSDARFT_EXPORT_SYMBOL get_current_date_time();
 
+    // drops the symbols cached for backtraces. An object file mapped again can be another build at the same address
+    void SYSDARFT_EXPORT_SYMBOL forget_symbols();
+
     // helper functions:
     /////////////////////////////////////////////////////////////////////////////////////////////
     template <typename T, typename = void>
@@ -115,7 +119,7 @@ namespace debug
     extern std::mutex SYSDARFT_EXPORT_SYMBOL log_mutex;
     template <typename ParamType>
     void _log(const ParamType& param);
-    void _log(const __uint128_t& param);
+    void SYSDARFT_EXPORT_SYMBOL _log(const __uint128_t& param);
     template <typename ParamType, typename... Args>
     void _log(const ParamType& param, const Args&... args);
     /////////////////////////////////////////////////////////////////////////////////////////////
@@ -125,6 +129,9 @@ namespace debug
 
     typedef std::vector < std::pair<std::string, void*> > backtrace_info;
 
+    // what SysdarftBaseError captured when thrown, turned into text on first request
+    struct error_report_t;
+
     backtrace_info SYSDARFT_EXPORT_SYMBOL obtain_stack_frame();
     std::string SYSDARFT_EXPORT_SYMBOL separate_before_slash(const std::string& input);
 
@@ -138,9 +145,9 @@ namespace debug
 }
 
 #if !defined(__DEBUG__) || defined(__CLEAN_OUTPUT__)
-#define log(...) ::debug::_log(__VA_ARGS__);
+#define log(...) ::debug::_log_dispatch(__VA_ARGS__);
 #else
-#define log(...) ::debug::_log(__FILE__, ":", __LINE__, ":", __PRETTY_FUNCTION__, ": ", __VA_ARGS__);
+#define log(...) ::debug::_log_dispatch(__FILE__, ":", __LINE__, ":", __PRETTY_FUNCTION__, ": ", __VA_ARGS__);
 #endif
 
 /**
@@ -151,16 +158,39 @@ class SYSDARFT_EXPORT_SYMBOL SysdarftBaseError : public std::runtime_error
 {
 protected:
     int cur_errno; // system errno
+
+private:
+    std::string bare_message;
+
+    // shared by copies, the report is symbolized once
+    std::shared_ptr < debug::error_report_t > report;
+
 public:
     /**
      * @brief SysdarftBaseError is not meant to be called by user, but
      * automatically invoked by derivatives.
      *
+     * In verbose mode only the raw stack frames are captured here, they are
+     * symbolized when what() is first called.
+     *
      * @param msg error message
      */
     explicit SysdarftBaseError(const std::string& msg);
+
+    /**
+     * @brief The error message, in verbose mode with time, backtrace and thread
+     * information
+     */
+    [[nodiscard]] const char * what() const noexcept override;
+
+    /**
+     * @brief The message alone, for errors that wrap this one in their own
+     */
+    [[nodiscard]] virtual const std::string & message() const noexcept { return bare_message; }
 };
 
 #include "SysdarftDebug.inl"
+#include "SysdarftAsyncLog.h"
+#include "SysdarftLogLevel.h"
 
 #endif // DEBUG_H
@@ -0,0 +1,97 @@
+#ifndef SYSDARFT_DEVICE_ABI_H
+#define SYSDARFT_DEVICE_ABI_H
+
+/*
+ * Sysdarft device module ABI
+ *
+ * Plain C, so devices can be built by any compiler against this header alone. A device module is a
+ * module (module_init/module_exit, see SysdarftModule) that also exports:
+ *
+ *   const uint32_t sysdarft_device_abi_version;        - SYSDARFT_DEVICE_MODULE defines it
+ *   int  sysdarft_device_attach(const sysdarft_host_api_t * host, void ** device);
+ *   void sysdarft_device_detach(void * device);
+ *
+ * and, to keep its state across a hot reload (since 1.1, both or neither):
+ *
+ *   int64_t sysdarft_device_save_state(void * device, void * buffer, uint64_t size);
+ *   int sysdarft_device_restore_state(void * device, const void * state, uint64_t size);
+ *
+ * save_state returns the size of the state, and writes it only if it fits into size bytes. On reload
+ * the old build is saved and detached, the new build attached and its state restored, all while the
+ * CPU is stopped at a block boundary. The state format is the device's own business, it has to be
+ * readable by the next build.
+ *
+ * The version is checked right after dlopen(): the major version has to be the one of the emulator
+ * and the minor version not newer. Newer minor versions only append members to sysdarft_host_api_t,
+ * its size is in struct_size.
+ *
+ * In sysdarft_device_attach() the device registers its MMIO pages, I/O ports and interrupt lines
+ * and maps the guest memory it accesses directly (DMA). Handlers are called on the CPU thread,
+ * synchronously, with the context given at registration. Guest memory windows point into guest RAM,
+ * they are not synchronized with the CPU and stay valid until the device is detached.
+ *
+ * Functions returning int return SYSDARFT_DEVICE_OK or a negative SYSDARFT_DEVICE_E* code.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYSDARFT_DEVICE_ABI_VERSION_MAJOR   1
+#define SYSDARFT_DEVICE_ABI_VERSION_MINOR   1
+#define SYSDARFT_DEVICE_ABI_VERSION         ((SYSDARFT_DEVICE_ABI_VERSION_MAJOR << 16) | SYSDARFT_DEVICE_ABI_VERSION_MINOR)
+
+#define SYSDARFT_DEVICE_PAGE_SIZE           4096
+#define SYSDARFT_DEVICE_IRQ_LINES           64
+
+#define SYSDARFT_DEVICE_OK                  0
+#define SYSDARFT_DEVICE_EINVAL              (-1)    /* empty or out of range */
+#define SYSDARFT_DEVICE_EBUSY               (-2)    /* already claimed by another device */
+
+/* size is 1, 2, 4 or 8 bytes, offset is relative to the first byte of the registered range */
+typedef uint64_t (*sysdarft_mmio_read_t)(void * context, uint64_t offset, uint32_t size);
+typedef void (*sysdarft_mmio_write_t)(void * context, uint64_t offset, uint32_t size, uint64_t value);
+typedef uint64_t (*sysdarft_port_read_t)(void * context, uint16_t port, uint32_t size);
+typedef void (*sysdarft_port_write_t)(void * context, uint16_t port, uint32_t size, uint64_t value);
+
+typedef struct sysdarft_memory_window_t
+{
+    uint8_t * data;
+    uint64_t size;
+} sysdarft_memory_window_t;
+
+typedef struct sysdarft_host_api_t
+{
+    uint32_t abi_version;
+    uint32_t struct_size;
+    void * host;
+
+    int (*register_mmio)(void * host, uint64_t first_page, uint64_t pages,
+        sysdarft_mmio_read_t read, sysdarft_mmio_write_t write, void * context);
+    int (*register_ports)(void * host, uint16_t first_port, uint32_t ports,
+        sysdarft_port_read_t read, sysdarft_port_write_t write, void * context);
+    int (*register_irq)(void * host, uint32_t line);
+    void (*raise_irq)(void * host, uint32_t line);
+    int (*map_guest_memory)(void * host, uint64_t address, uint64_t size, sysdarft_memory_window_t * window);
+} sysdarft_host_api_t;
+
+typedef int (*sysdarft_device_attach_t)(const sysdarft_host_api_t * host, void ** device);
+typedef void (*sysdarft_device_detach_t)(void * device);
+typedef int64_t (*sysdarft_device_save_state_t)(void * device, void * buffer, uint64_t size);
+typedef int (*sysdarft_device_restore_state_t)(void * device, const void * state, uint64_t size);
+
+#ifdef __cplusplus
+}
+#define SYSDARFT_DEVICE_LINKAGE extern "C"
+#else
+#define SYSDARFT_DEVICE_LINKAGE
+#endif
+
+/* Place once in a device module */
+#define SYSDARFT_DEVICE_MODULE \
+    SYSDARFT_DEVICE_LINKAGE __attribute__((visibility("default"))) \
+    const uint32_t sysdarft_device_abi_version = SYSDARFT_DEVICE_ABI_VERSION
+
+#endif /* SYSDARFT_DEVICE_ABI_H */
@@ -0,0 +1,181 @@
+#ifndef SYSDARFT_EXECUTOR_H
+#define SYSDARFT_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SysdarftDebug.h>
+
+// Threads of the emulator. The CPU, the UI and I/O each run on a long-lived thread that can be pinned to a core
+// of its own, so the scheduler does not migrate the CPU thread and the UI does not compete with it. Background
+// jobs (assembling, disassembling, compression) share one pool.
+
+enum class thread_role_t { CPU, UI, IO };
+
+namespace executor
+{
+    // cores this process is allowed to run on
+    std::vector < unsigned > SYSDARFT_EXPORT_SYMBOL usable_cores();
+
+    // A core reserved for role, nullopt if there are too few cores to give every role its own
+    std::optional < unsigned > SYSDARFT_EXPORT_SYMBOL core_for(thread_role_t role);
+
+    // False if none of the cores is usable, the affinity is unchanged then
+    bool SYSDARFT_EXPORT_SYMBOL pin_current_thread(const std::vector < unsigned > & cores);
+    inline bool pin_current_thread(const unsigned core) { return pin_current_thread(std::vector { core }); }
+}
+
+// A named thread running body until stop(). The thread is created by the first start() and reused by later ones.
+// body returns when running turns false, an exception leaving it is logged and ends the run
+class SYSDARFT_EXPORT_SYMBOL SysdarftThread
+{
+public:
+    using body_t = std::function < void(std::atomic < bool > & running) >;
+
+    SysdarftThread(std::string _name, body_t _body, std::optional < unsigned > _core = std::nullopt);
+
+    template < typename InstanceType >
+    SysdarftThread(std::string _name, InstanceType * instance, void (InstanceType::*method)(std::atomic < bool > &),
+        std::optional < unsigned > _core = std::nullopt)
+        : SysdarftThread(std::move(_name),
+            [instance, method](std::atomic < bool > & running) { (instance->*method)(running); }, _core) { }
+
+    SysdarftThread(const SysdarftThread &) = delete;
+    SysdarftThread & operator=(const SysdarftThread &) = delete;
+    ~SysdarftThread();
+
+    void start();
+    // wait for body to return, from body itself only asks it to
+    void stop();
+
+    [[nodiscard]] bool is_running() const { return running.load(std::memory_order_relaxed); }
+    [[nodiscard]] const std::string & get_name() const { return name; }
+
+private:
+    void main_loop();
+
+    const std::string name;
+    const body_t body;
+    const std::optional < unsigned > core;
+
+    std::atomic < bool > running = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool run_requested = false;
+    bool body_active = false;
+    bool exiting = false;
+    std::thread thread;
+};
+
+// Fixed number of named worker threads taking jobs in submission order. Queued jobs still run on destruction
+class SYSDARFT_EXPORT_SYMBOL SysdarftThreadPool
+{
+public:
+    explicit SysdarftThreadPool(unsigned threads, const std::string & name = "Pool");
+    SysdarftThreadPool(const SysdarftThreadPool &) = delete;
+    SysdarftThreadPool & operator=(const SysdarftThreadPool &) = delete;
+    ~SysdarftThreadPool();
+
+    // one thread per core, the one reserved for the CPU excluded. Created on first use
+    static SysdarftThreadPool & shared();
+
+    void execute(std::function < void() > job);
+
+    template < typename Function >
+    auto submit(Function && function) -> std::future < std::invoke_result_t < Function > >
+    {
+        auto task = std::make_shared < std::packaged_task < std::invoke_result_t < Function >() > >(
+            std::forward<Function>(function));
+        auto result = task->get_future();
+        execute([task] { (*task)(); });
+        return result;
+    }
+
+    [[nodiscard]] unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    void worker();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque < std::function < void() > > jobs;
+    bool exiting = false;
+    std::vector < std::thread > workers;
+};
+
+// Run function(0 .. tasks - 1) on up to `threads` threads: the calling thread and jobs on the shared pool.
+// Errors are re-thrown after all tasks finished, the one of the lowest task first. Nesting is safe, the caller
+// does not wait for pool jobs that have not started, it does their tasks itself.
+template < typename Function >
+void run_in_parallel(const std::size_t tasks, const unsigned int threads, Function && function)
+{
+    struct helpers_t
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        unsigned inside = 0;
+        bool closed = false;
+    };
+
+    std::vector < std::exception_ptr > errors(tasks);
+    std::atomic < std::size_t > next = 0;
+
+    auto work = [&]
+    {
+        for (std::size_t task = next++; task < tasks; task = next++)
+        {
+            try {
+                function(task);
+            } catch (...) {
+                errors[task] = std::current_exception();
+            }
+        }
+    };
+
+    // a job outlives this frame if it starts late, it only touches helpers then
+    const auto helpers = std::make_shared < helpers_t >();
+    for (std::size_t i = 1; i < std::min<std::size_t>(threads, tasks); i++)
+    {
+        SysdarftThreadPool::shared().execute([helpers, &work]
+        {
+            {
+                std::lock_guard<std::mutex> lock(helpers->mutex);
+                if (helpers->closed) {
+                    return;
+                }
+                helpers->inside++;
+            }
+
+            work();
+
+            std::lock_guard<std::mutex> lock(helpers->mutex);
+            helpers->inside--;
+            helpers->cv.notify_all();
+        });
+    }
+
+    work();
+
+    {
+        std::unique_lock<std::mutex> lock(helpers->mutex);
+        helpers->closed = true;
+        helpers->cv.wait(lock, [&helpers] { return helpers->inside == 0; });
+    }
+
+    for (const auto & error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+#endif // SYSDARFT_EXECUTOR_H
@@ -0,0 +1,46 @@
+#ifndef SYSDARFT_FRAME_PROTOCOL_H
+#define SYSDARFT_FRAME_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <SysdarftDebug.h>
+#include <GlobalEvents.h>
+#include <SysdarftTextFramebuffer.h>
+
+// Screen updates of the GUI back-end, sent as binary websocket messages. A viewer gets a keyframe when it
+// connects and a delta whenever the screen or the cursor changed. Integers are little endian.
+//
+//   keyframe   u8 type = 1, u8 flags, u16 cursor x, u16 cursor y, u8 columns, u8 rows,
+//              columns * rows glyphs, then columns * rows attributes, row by row
+//   delta      u8 type = 2, u8 flags, u16 cursor x, u16 cursor y, u16 runs,
+//              per run: u8 row, u8 column, u8 length, length glyphs, then length attributes
+//
+// Flags: bit 0 is set while the cursor is visible.
+namespace frame_protocol
+{
+    enum message_type_t : uint8_t { KEYFRAME = 1, DELTA = 2 };
+    enum flags_t : uint8_t { CURSOR_VISIBLE = 1 << 0 };
+
+    struct cursor_state_t
+    {
+        CursorPosition position;
+        bool visible;
+
+        bool operator==(const cursor_state_t &) const = default;
+    };
+
+    std::string SYSDARFT_EXPORT_SYMBOL encode_keyframe(const SysdarftTextFramebuffer & frame,
+        const cursor_state_t & cursor);
+
+    // empty if neither the screen nor the cursor changed
+    std::string SYSDARFT_EXPORT_SYMBOL encode_delta(const SysdarftTextFramebuffer & frame,
+        const SysdarftTextFramebuffer & previous, const cursor_state_t & cursor,
+        const cursor_state_t & previous_cursor);
+
+    // what a viewer does with a message. False if it is malformed, frame may be partly updated then
+    bool SYSDARFT_EXPORT_SYMBOL apply(std::string_view message, SysdarftTextFramebuffer & frame,
+        cursor_state_t & cursor);
+}
+
+#endif // SYSDARFT_FRAME_PROTOCOL_H
@@ -0,0 +1,85 @@
+#ifndef UI_HEADLESS_H
+#define UI_HEADLESS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <SysdarftDebug.h>
+#include <GlobalEvents.h>
+#include <SysdarftUIEventQueue.h>
+#include <SysdarftTextFramebuffer.h>
+#include <SysdarftExecutor.h>
+
+// A display without a terminal or a browser, for benchmarks and CI. It keeps the screen in memory and
+// can append frames to a file as text. The CPU thread only posts events, frames are built and written
+// by a thread of the UI.
+class SYSDARFT_EXPORT_SYMBOL SysdarftHeadlessUI
+{
+public:
+    enum class dump_mode_t { NEVER, ON_CHANGE, INTERVAL };
+
+private:
+    // owned by the UI thread, read under screen_mutex
+    SysdarftTextFramebuffer video_memory;
+    bool cursor_visible = true;
+    SysdarftUIEventQueue events;
+    ui_frame_t frame;
+    mutable std::mutex screen_mutex;
+
+    std::atomic<CursorPosition> current_cursor_position = { };
+    std::atomic<uint64_t> frame_count = 0;
+
+    // set before initialize()
+    dump_mode_t dump_mode = dump_mode_t::NEVER;
+    std::string dump_path;
+    std::chrono::milliseconds dump_interval { 1000 };
+    std::ofstream dump_file;
+    bool changed_since_dump = false;
+    std::chrono::steady_clock::time_point started;
+
+    // flush(): callers wait until the UI thread has applied what was posted before
+    std::mutex flush_mutex;
+    std::condition_variable flushed;
+    uint64_t flush_requested = 0;
+    uint64_t flush_completed = 0;
+    std::atomic<bool> stopping = false;
+
+    SysdarftThread worker;
+
+    void run(std::atomic<bool>& running);
+    bool apply_events();
+    void dump_frame();
+
+public:
+    SysdarftHeadlessUI() : worker("UI Headless", this, &SysdarftHeadlessUI::run, executor::core_for(thread_role_t::UI)) { }
+
+    // become the UI behind the g_ui_* hooks
+    void install();
+
+    // Frames are appended to path. ON_CHANGE writes every frame that changed the screen, INTERVAL at most
+    // one frame per interval, the latest, and only if the screen changed since the last one
+    void set_dump(const std::string & path, dump_mode_t mode,
+        std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+
+    // wait until everything posted before is on the screen
+    void flush();
+    [[nodiscard]] SysdarftTextFramebuffer snapshot() const;
+    // screen updates applied so far, batches count once
+    [[nodiscard]] uint64_t get_frame_count() const {
+        return frame_count.load(std::memory_order_relaxed);
+    }
+
+    void cleanup();
+    void initialize();
+    void set_cursor(int, int);
+    CursorPosition get_cursor();
+    void display_char(int, int, int);
+    void display_region(int, int, int, int, const uint8_t *, int);
+    void scroll(int);
+    void set_cursor_visibility(bool);
+};
+
+#endif // UI_HEADLESS_H
@@ -1,8 +1,121 @@
 #ifndef SYSDARFTIOHUB_H
 #define SYSDARFTIOHUB_H
 
-class SysdarftIOHub {
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+#include <SysdarftDebug.h>
+#include <SysdarftDeviceABI.h>
+
+// Devices of the machine: MMIO pages, I/O ports and interrupt lines, and the guest RAM they access directly.
+//
+// Every device connects and gets its own host API (SysdarftDeviceABI.h), everything it registers through it
+// belongs to it and is released by disconnect(). Registration is not synchronized with dispatch, devices are
+// connected and disconnected while the CPU is not running, or inside quiesce() while it is. Dispatch takes no
+// lock, raising interrupts is lock-free and may happen on any thread.
+class SYSDARFT_EXPORT_SYMBOL SysdarftIOHub
+{
 public:
+    static constexpr uint64_t page_size = SYSDARFT_DEVICE_PAGE_SIZE;
+    static constexpr uint32_t irq_lines = SYSDARFT_DEVICE_IRQ_LINES;
+
+    SysdarftIOHub() = default;
+    SysdarftIOHub(const SysdarftIOHub &) = delete;
+    SysdarftIOHub & operator=(const SysdarftIOHub &) = delete;
+
+    // guest RAM, memory windows handed to devices point into it
+    void attach_memory(std::span < uint8_t > guest_memory) { memory = guest_memory; }
+
+    const sysdarft_host_api_t * connect();
+    void disconnect(const sysdarft_host_api_t * host);
+
+    // False if no byte of the access is MMIO, otherwise the access is dispatched to the device.
+    // Accesses covering more than one region, or MMIO and RAM, throw IllegalMemoryAccessException
+    bool mmio_read(uint64_t address, char * dest, uint64_t size);
+    bool mmio_write(uint64_t address, const char * source, uint64_t size);
+
+    // ports without a device read all ones and ignore writes
+    uint64_t port_read(uint16_t port, uint32_t size);
+    void port_write(uint16_t port, uint32_t size, uint64_t value);
+
+    void raise_irq(uint32_t line);
+    // lowest pending interrupt line, which is cleared, or -1
+    int take_interrupt();
+
+    // The thread running the CPU attaches itself and calls safe_point() at every block boundary
+    void attach_executor();
+    void detach_executor();
+    void safe_point()
+    {
+        if (quiesce_requested.load(std::memory_order_acquire)) {
+            run_quiesced_work();
+        }
+    }
+
+    // Run work on the CPU thread at its next safe point and wait for it, the CPU does not execute and no
+    // device is accessed meanwhile. Without an attached executor work runs right away. Exceptions of work
+    // are rethrown here
+    void quiesce(const std::function < void() > & work);
+
+private:
+    struct client_t
+    {
+        sysdarft_host_api_t api;
+        SysdarftIOHub * hub;
+    };
+
+    struct mmio_region_t
+    {
+        uint64_t end;
+        sysdarft_mmio_read_t read;
+        sysdarft_mmio_write_t write;
+        void * context;
+        const client_t * owner;
+    };
+
+    struct port_t
+    {
+        sysdarft_port_read_t read;
+        sysdarft_port_write_t write;
+        void * context;
+        const client_t * owner;
+    };
+
+    // called through the host API
+    int register_mmio(const client_t * owner, uint64_t first_page, uint64_t pages,
+        sysdarft_mmio_read_t read, sysdarft_mmio_write_t write, void * context);
+    int register_ports(const client_t * owner, uint16_t first_port, uint32_t count,
+        sysdarft_port_read_t read, sysdarft_port_write_t write, void * context);
+    int register_irq(const client_t * owner, uint32_t line);
+    void raise_irq(const client_t * owner, uint32_t line);
+    int map_guest_memory(uint64_t address, uint64_t size, sysdarft_memory_window_t * window) const;
+
+    void run_quiesced_work();
+    void run_quiesced_work(std::unique_lock < std::mutex > & lock);
+
+    // region overlapping [address, address + size), end() if there is none
+    std::map < uint64_t, mmio_region_t >::iterator find_region(uint64_t address, uint64_t size);
+
+    std::span < uint8_t > memory;
+    std::vector < std::unique_ptr < client_t > > clients;
+    std::map < uint64_t, mmio_region_t > mmio_regions;  // keyed by the first byte
+    std::vector < port_t > ports;                       // all ports once the first one is registered
+    std::array < const client_t *, irq_lines > irq_owners { };
+    std::atomic < uint64_t > pending_irqs = 0;
+
+    std::mutex quiesce_mutex;
+    std::condition_variable quiesce_cv;
+    std::atomic < bool > quiesce_requested = false;
+    const std::function < void() > * quiesce_work = nullptr;   // in flight, one at a time
+    std::exception_ptr quiesce_error;
+    bool executor_attached = false;
 };
 
 #endif //SYSDARFTIOHUB_H
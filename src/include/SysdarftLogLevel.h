@@ -0,0 +1,93 @@
+#ifndef SYSDARFT_LOG_LEVEL_H
+#define SYSDARFT_LOG_LEVEL_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Levels of log_trace() .. log_error(). Everything below SYSDARFT_LOG_LEVEL is removed by the preprocessor,
+// its arguments are never compiled into the program. Above it, the level of the subsystem is checked before
+// any argument is evaluated
+#define SYSDARFT_LOG_TRACE      0
+#define SYSDARFT_LOG_DEBUG      1
+#define SYSDARFT_LOG_INFO       2
+#define SYSDARFT_LOG_WARNING    3
+#define SYSDARFT_LOG_ERROR      4
+
+#ifndef SYSDARFT_LOG_LEVEL
+#define SYSDARFT_LOG_LEVEL SYSDARFT_LOG_TRACE
+#endif
+
+namespace debug
+{
+    enum class log_subsystem_t : uint8_t { GENERAL, CPU, MEMORY, UI, BACKEND, MODULE, COUNT };
+
+    enum class log_level_t : uint8_t
+    {
+        TRACE = SYSDARFT_LOG_TRACE,
+        DEBUG = SYSDARFT_LOG_DEBUG,
+        INFO = SYSDARFT_LOG_INFO,
+        WARNING = SYSDARFT_LOG_WARNING,
+        ERROR = SYSDARFT_LOG_ERROR,
+        NONE,
+    };
+
+    // per subsystem, INFO unless changed
+    extern std::array < std::atomic < log_level_t >, static_cast<std::size_t>(log_subsystem_t::COUNT) >
+        SYSDARFT_EXPORT_SYMBOL log_levels;
+
+    inline bool log_enabled(const log_subsystem_t subsystem, const log_level_t level) {
+        return level >= log_levels[static_cast<std::size_t>(subsystem)].load(std::memory_order_relaxed);
+    }
+
+    inline void set_log_level(const log_subsystem_t subsystem, const log_level_t level) {
+        log_levels[static_cast<std::size_t>(subsystem)].store(level, std::memory_order_relaxed);
+    }
+
+    // "debug" for every subsystem, or a list like "info,cpu=trace,ui=none". False if spec is malformed,
+    // nothing is changed then
+    bool SYSDARFT_EXPORT_SYMBOL set_log_levels(const std::string & spec);
+}
+
+#define log_at(subsystem, level, ...) \
+    do { \
+        if (::debug::log_enabled(::debug::log_subsystem_t::subsystem, ::debug::log_level_t::level)) { \
+            log(__VA_ARGS__) \
+        } \
+    } while (false)
+
+// arguments stay in an unevaluated operand, no code is generated but variables only logged count as used
+#define log_disabled(subsystem, ...) do { (void)sizeof((__VA_ARGS__, 0)); } while (false)
+
+#if SYSDARFT_LOG_LEVEL <= SYSDARFT_LOG_TRACE
+#define log_trace(subsystem, ...) log_at(subsystem, TRACE, __VA_ARGS__)
+#else
+#define log_trace(subsystem, ...) log_disabled(subsystem, __VA_ARGS__)
+#endif
+
+#if SYSDARFT_LOG_LEVEL <= SYSDARFT_LOG_DEBUG
+#define log_debug(subsystem, ...) log_at(subsystem, DEBUG, __VA_ARGS__)
+#else
+#define log_debug(subsystem, ...) log_disabled(subsystem, __VA_ARGS__)
+#endif
+
+#if SYSDARFT_LOG_LEVEL <= SYSDARFT_LOG_INFO
+#define log_info(subsystem, ...) log_at(subsystem, INFO, __VA_ARGS__)
+#else
+#define log_info(subsystem, ...) log_disabled(subsystem, __VA_ARGS__)
+#endif
+
+#if SYSDARFT_LOG_LEVEL <= SYSDARFT_LOG_WARNING
+#define log_warning(subsystem, ...) log_at(subsystem, WARNING, __VA_ARGS__)
+#else
+#define log_warning(subsystem, ...) log_disabled(subsystem, __VA_ARGS__)
+#endif
+
+#if SYSDARFT_LOG_LEVEL <= SYSDARFT_LOG_ERROR
+#define log_error(subsystem, ...) log_at(subsystem, ERROR, __VA_ARGS__)
+#else
+#define log_error(subsystem, ...) log_disabled(subsystem, __VA_ARGS__)
+#endif
+
+#endif // SYSDARFT_LOG_LEVEL_H
@@ -30,6 +30,8 @@
 
 #define BLOCK_SIZE 4096
 
+class SysdarftIOHub;
+
 class IllegalMemoryAccessException final : public SysdarftBaseError
 {
 public:
@@ -43,6 +45,7 @@ protected:
     std::mutex MemoryAccessMutex;
     std::vector < std::array < uint8_t, BLOCK_SIZE > > Memory;
     std::atomic<uint64_t> TotalMemory = 32 * 1024 * 1024; // 32MB Memory
+    SysdarftIOHub * IOHub = nullptr; // MMIO pages, checked before RAM
 
     SysdarftCPUMemoryAccess();
     void read_memory(uint64_t address, char * _dest, uint64_t size);
@@ -97,6 +100,9 @@ protected:
     }
 
 public:
+    // Route MMIO to hub and give its devices direct access to the guest RAM
+    void attach_io_hub(SysdarftIOHub & hub);
+
     virtual ~SysdarftCPUMemoryAccess() = default;
     SysdarftCPUMemoryAccess operator=(const SysdarftCPUMemoryAccess&) = delete;
 };
@@ -1,8 +1,11 @@
 #ifndef MSG_MAP_H
 #define MSG_MAP_H
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
+#include <typeindex>
 #include <functional>
 #include <any>
 #include <utility>
@@ -100,13 +103,124 @@ public:
         methods[key] = [bound_function](const std::vector<std::any>& args) -> std::any {
             return invoke_with_any<decltype(bound_function), Args...>(bound_function, args);
         };
+
+        // Publish the method to typed handles. A method installed again with another signature
+        // gets a new slot, handles resolved for the old signature become uninstalled
+        using signature_t = ReturnType(Args...);
+        auto & entry = slots[key];
+        if (entry && entry->signature != typeid(signature_t))
+        {
+            entry->retire();
+            retired_slots.push_back(std::move(entry));
+        }
+
+        if (!entry) {
+            entry = std::make_unique<slot<signature_t>>();
+        }
+
+        auto & target = static_cast<slot<signature_t>&>(*entry);
+        target.bindings.push_back(std::make_unique<member_binding<InstanceType, signature_t>>(instance, method));
+        target.current.store(target.bindings.back().get(), std::memory_order_release);
     }
 
     std::any invoke_instance(const std::string& instance_name, const std::string& method_name, const std::vector<std::any>& args);
     wrapper operator()(const std::string& instance_name, const std::string& method_name);
 
+private:
+    template <typename Signature> struct binding;
+    template <typename ReturnType, typename... Args>
+    struct binding<ReturnType(Args...)>
+    {
+        virtual ReturnType call(Args... args) = 0;
+        virtual ~binding() = default;
+    };
+
+    template <typename InstanceType, typename Signature> struct member_binding;
+    template <typename InstanceType, typename ReturnType, typename... Args>
+    struct member_binding<InstanceType, ReturnType(Args...)> final : binding<ReturnType(Args...)>
+    {
+        InstanceType * instance;
+        ReturnType (InstanceType::*method)(Args...);
+
+        template <typename Method>
+        member_binding(InstanceType * _instance, Method _method) : instance(_instance), method(_method) { }
+
+        ReturnType call(Args... args) override {
+            return (instance->*method)(std::forward<Args>(args)...);
+        }
+    };
+
+    struct slot_base
+    {
+        const std::type_index signature;
+        explicit slot_base(const std::type_index _signature) : signature(_signature) { }
+        virtual void retire() = 0;
+        virtual ~slot_base() = default;
+    };
+
+    // Typed entry of a method. Replaced bindings are kept alive, a handle may still be calling one
+    template <typename Signature> struct slot;
+    template <typename ReturnType, typename... Args>
+    struct slot<ReturnType(Args...)> final : slot_base
+    {
+        std::atomic<binding<ReturnType(Args...)>*> current = nullptr;
+        std::vector<std::unique_ptr<binding<ReturnType(Args...)>>> bindings;
+
+        slot() : slot_base(typeid(ReturnType(Args...))) { }
+        void retire() override { current.store(nullptr, std::memory_order_release); }
+    };
+
+public:
+    // Method resolved once, calls go straight to the installed instance without building keys,
+    // locking or boxing arguments. Handles stay valid for the lifetime of the map and follow
+    // later installations of the same method
+    template <typename Signature> class event_handle;
+    template <typename ReturnType, typename... Args>
+    class event_handle<ReturnType(Args...)>
+    {
+    private:
+        slot<ReturnType(Args...)> * target;
+        explicit event_handle(slot<ReturnType(Args...)> * _target) : target(_target) { }
+
+    public:
+        ReturnType operator()(Args... args) const
+        {
+            auto * bound = target->current.load(std::memory_order_acquire);
+            if (bound == nullptr) {
+                throw MessageMapNoSuchInstance();
+            }
+
+            return bound->call(std::forward<Args>(args)...);
+        }
+
+        [[nodiscard]] bool installed() const {
+            return target->current.load(std::memory_order_acquire) != nullptr;
+        }
+
+        friend class SysdarftMessageMap;
+    };
+
+    // The method does not have to be installed yet. Throws MessageMapArgumentMismatch
+    // if it is installed with another signature
+    template <typename Signature>
+    event_handle<Signature> handle(const std::string& instance_name, const std::string& method_name)
+    {
+        std::lock_guard lock(mutex);
+
+        auto & entry = slots[instance_name + "::" + method_name];
+        if (!entry) {
+            entry = std::make_unique<slot<Signature>>();
+        } else if (entry->signature != typeid(Signature)) {
+            throw MessageMapArgumentMismatch();
+        }
+
+        return event_handle<Signature>(static_cast<slot<Signature>*>(entry.get()));
+    }
+
 private:
     std::map<std::string, std::function<std::any(const std::vector<std::any>&)>> methods;
+    std::map<std::string, std::unique_ptr<slot_base>> slots;
+    std::vector<std::unique_ptr<slot_base>> retired_slots;
     std::mutex mutex;
 };
 
@@ -3,8 +3,16 @@
 
 #include <string>
 #include <any>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
 #include <dlfcn.h>
 #include <SysdarftDebug.h>
+#include <SysdarftDeviceABI.h>
+
+class SysdarftIOHub;
 
 class SYSDARFT_EXPORT_SYMBOL SysdarftModuleLibraryLoadError final : public SysdarftBaseError {
 public:
@@ -16,13 +24,59 @@ public:
     explicit SysdarftModuleSymbolResolutionError(const std::string & msg) : SysdarftBaseError("Cannot resolve function: " + msg) { }
 };
 
+class SYSDARFT_EXPORT_SYMBOL SysdarftModuleDeviceStateError final : public SysdarftBaseError {
+public:
+    explicit SysdarftModuleDeviceStateError(const std::string & msg) : SysdarftBaseError("Cannot hand over device state: " + msg) { }
+};
+
 class SYSDARFT_EXPORT_SYMBOL SysdarftModule
 {
 private:
+    std::string path;
     std::atomic < void * > handle = nullptr;
     std::mutex ModuleCallMutex;
+    std::map < std::string, void *, std::less<> > symbols;   // resolved by bind()
+
+    void * resolve(const std::string & function_name);
+
+    // device modules, see SysdarftDeviceABI.h
+    uint32_t device_abi_version = 0;
+    bool device_has_state = false;
+    SysdarftIOHub * device_hub = nullptr;
+    const sysdarft_host_api_t * device_host = nullptr;
+    void * device = nullptr;
+
+    void load();
+    void close_library();
+    void check_device_abi();
+    std::optional < std::vector < uint8_t > > save_device_state();
+    void restore_device_state(const std::vector < uint8_t > & state);
 
 public:
+    // Function of the module resolved once by bind(). Calling it is a plain indirect call, no
+    // lock, lookup or boxing. It is valid until the module is unloaded
+    template < typename Signature > class bound_function;
+    template < typename Ret, typename... Args >
+    class bound_function < Ret(Args...) >
+    {
+    private:
+        Ret (*entry)(Args...);
+        explicit bound_function(Ret (*_entry)(Args...)) : entry(_entry) { }
+
+    public:
+        Ret operator()(Args... args) const {
+            return entry(std::forward<Args>(args)...);
+        }
+
+        friend class SysdarftModule;
+    };
+
+    template < typename Signature >
+    bound_function < Signature > bind(const std::string & function_name)
+    {
+        return bound_function < Signature > (reinterpret_cast<Signature *>(resolve(function_name)));
+    }
+
     template < typename Ret, typename... Args >
     std::any call(const std::string & function_name, const Args &... args)
     {
@@ -50,6 +104,18 @@ public:
     ~SysdarftModule() { unload(); }
     void init();
     void unload();
+
+    [[nodiscard]] bool is_device() const { return device_abi_version != 0; }
+    // Connect the device to hub and let it register its resources, it is detached by unload()
+    void attach_device(SysdarftIOHub & hub);
+    void detach_device();
+
+    // Unload and load the module again from its path, a new build if it has been rebuilt. An attached
+    // device is reloaded while the CPU is quiesced, it is attached to the same hub and gets the state of
+    // the old build if both builds support it. Bound functions of the old build are invalid afterward.
+    // If the new build fails to load the module stays unloaded and the error is thrown
+    void reload();
+
     SysdarftModule & operator=(const SysdarftModule &) = delete;
 };
 
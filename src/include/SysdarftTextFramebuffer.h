@@ -0,0 +1,90 @@
+#ifndef SYSDARFT_TEXT_FRAMEBUFFER_H
+#define SYSDARFT_TEXT_FRAMEBUFFER_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <SysdarftDebug.h>
+#include <SysdarftUIEventQueue.h>
+
+// A run of cells in a row that differ between two frames
+struct ui_span_t
+{
+    int begin;
+    int length;
+};
+
+// The text screen as the UIs draw it: row major, one glyph byte and one attribute byte per cell, rows
+// padded to a multiple of 16 so two frames can be compared 16 cells at a time. Padding is always zero.
+//
+// A cell value from the emulator carries the glyph in its low byte and the attribute above it.
+class SYSDARFT_EXPORT_SYMBOL SysdarftTextFramebuffer
+{
+public:
+    static constexpr int width = V_WIDTH;
+    static constexpr int height = V_HEIGHT;
+    static constexpr int stride = (V_WIDTH + 15) & ~15;
+
+    enum attribute_t : uint8_t
+    {
+        ATTR_BOLD       = 1 << 0,
+        ATTR_REVERSE    = 1 << 1,
+        ATTR_UNDERLINE  = 1 << 2,
+        ATTR_BLINK      = 1 << 3,
+    };
+
+    // one bit per cell of a row
+    using row_mask_t = std::array < uint64_t, stride / 64 >;
+
+    SysdarftTextFramebuffer() = default;
+
+    [[nodiscard]] uint8_t glyph(const int x, const int y) const {
+        return glyphs[y][x];
+    }
+
+    [[nodiscard]] uint8_t attribute(const int x, const int y) const {
+        return attributes[y][x];
+    }
+
+    [[nodiscard]] int cell(const int x, const int y) const {
+        return glyphs[y][x] | attributes[y][x] << 8;
+    }
+
+    void set_cell(const int x, const int y, const int value)
+    {
+        glyphs[y][x] = static_cast<uint8_t>(value);
+        attributes[y][x] = static_cast<uint8_t>(value >> 8);
+    }
+
+    [[nodiscard]] const uint8_t * glyph_row(const int y) const {
+        return glyphs[y].data();
+    }
+
+    [[nodiscard]] const uint8_t * attribute_row(const int y) const {
+        return attributes[y].data();
+    }
+
+    void fill(uint8_t glyph, uint8_t attribute = 0);
+    // clipped at the end of the row
+    void write_text(int x, int y, std::string_view text, uint8_t attribute = 0);
+    void copy_row(const SysdarftTextFramebuffer & from, int y);
+
+    // Write the cells of a drained frame. Returns cursor_visible as the frame leaves it
+    [[nodiscard]] bool apply(const ui_frame_t & frame, bool cursor_visible);
+
+    // cells of row y whose glyph or attribute differ from previous
+    [[nodiscard]] row_mask_t changed_cells(const SysdarftTextFramebuffer & previous, int y) const;
+
+    // The changed cells of row y as runs. Runs fewer than merge_gap cells apart are joined
+    void changed_spans(const SysdarftTextFramebuffer & previous, int y, std::vector < ui_span_t > & spans,
+        int merge_gap = 4) const;
+
+    bool operator==(const SysdarftTextFramebuffer &) const = default;
+
+private:
+    alignas(64) std::array < std::array < uint8_t, stride >, height > glyphs { };
+    alignas(64) std::array < std::array < uint8_t, stride >, height > attributes { };
+};
+
+#endif // SYSDARFT_TEXT_FRAMEBUFFER_H
@@ -0,0 +1,126 @@
+#ifndef UI_EVENT_QUEUE_H
+#define UI_EVENT_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <SysdarftDebug.h>
+#include <GlobalEvents.h>
+
+// -----------------------------------------------------
+// Virtual screen dimensions
+// -----------------------------------------------------
+static constexpr int V_WIDTH  = 127;
+static constexpr int V_HEIGHT = 31;
+
+struct ui_event_t
+{
+    enum : uint8_t { DISPLAY_CHAR, DISPLAY_REGION, SCROLL, SET_CURSOR, SET_CURSOR_VISIBILITY } type;
+    int x;
+    int y;
+    int value;  // character, visibility, or lines scrolled
+    int width = 0;  // size of a region, its cells are read from the shadow copy when drained
+    int height = 0;
+};
+
+struct ui_cell_update_t
+{
+    int x;
+    int y;
+    int ch;
+};
+
+// Updates of one frame, every cell and the cursor at most once, in their latest state
+struct SYSDARFT_EXPORT_SYMBOL ui_frame_t
+{
+    std::vector < ui_cell_update_t > cells;
+    std::optional < CursorPosition > cursor;
+    std::optional < bool > cursor_visibility;
+    bool full_redraw = false;   // scrolled or events were lost, cells holds the whole screen
+
+    [[nodiscard]] bool empty() const {
+        return cells.empty() && !cursor && !cursor_visibility;
+    }
+
+    void clear();
+};
+
+// Events from the emulator to a UI back-end. Any number of threads push, pushing never blocks and
+// never waits for the UI. One UI thread drains the queue once per frame.
+//
+// The queue is a bounded ring in which producers claim slots with a CAS on the tail and publish
+// them with a per slot sequence number. Every push first updates a shadow copy of the screen. Regions
+// and scrolling only post their bounds, the cells are read from the shadow when drained. When the
+// ring is full the event is dropped and the next drain reports the whole screen from the shadow.
+//
+// The first event after a drain makes wakeup_fd() readable, so the UI thread can sleep in poll() until
+// there is something to draw. Events after it do not touch the descriptor again.
+class SYSDARFT_EXPORT_SYMBOL SysdarftUIEventQueue
+{
+public:
+    static constexpr std::size_t capacity = 4096;
+
+    SysdarftUIEventQueue();
+    ~SysdarftUIEventQueue();
+
+    SysdarftUIEventQueue(const SysdarftUIEventQueue &) = delete;
+    SysdarftUIEventQueue & operator=(const SysdarftUIEventQueue &) = delete;
+
+    void display_char(int x, int y, int ch);
+    void display_region(int x, int y, int w, int h, const uint8_t * cells, int stride);
+    // not atomic with respect to characters written by other threads at the same time
+    void scroll(int lines);
+    void set_cursor(int x, int y);
+    void set_cursor_visibility(bool visible);
+
+    // Coalesce pending events into frame, at most capacity of them. More left over keep wakeup_fd()
+    // readable for the next frame. Single consumer. False if there was nothing to do
+    bool drain(ui_frame_t & frame);
+
+    // an eventfd, readable while events wait to be drained
+    [[nodiscard]] int wakeup_fd() const {
+        return wakeup;
+    }
+
+    // make wakeup_fd() readable without an event, e.g. to stop the UI thread
+    void wake() const;
+
+    [[nodiscard]] uint64_t get_dropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct slot_t
+    {
+        std::atomic < uint64_t > sequence;
+        ui_event_t event;
+    };
+
+    static_assert((capacity & (capacity - 1)) == 0, "capacity has to be a power of two");
+
+    bool push(const ui_event_t & event);
+    void post(const ui_event_t & event);
+    void signal();
+    void coalesce(ui_frame_t & frame, const ui_event_t & event);
+
+    std::array < slot_t, capacity > ring;
+    alignas(64) std::atomic < uint64_t > tail = 0;
+    alignas(64) uint64_t head = 0;
+
+    // latest state, for redraws after an overflow
+    std::array < std::atomic < int >, V_WIDTH * V_HEIGHT > shadow;
+    std::atomic < CursorPosition > shadow_cursor = CursorPosition { 0, 0 };
+    std::atomic < bool > shadow_visibility = true;
+    std::atomic < bool > overflowed = false;
+    std::atomic < uint64_t > dropped = 0;
+
+    int wakeup = -1;
+    std::atomic < bool > signalled = false;     // wakeup was written since the last drain
+
+    // consumer side: position of each cell in the frame being built, -1 if absent
+    std::array < int32_t, V_WIDTH * V_HEIGHT > frame_index;
+};
+
+#endif // UI_EVENT_QUEUE_H
@@ -0,0 +1,259 @@
+// Throughput of the coding module on a synthetic corpus covering every opcode, width and operand kind.
+//
+// Usage: benchmark.coding [--repeat N] [--check BASELINE]
+//
+// One JSON object is printed per benchmark. Saving the output of a known good build and passing it
+// back with --check makes the run fail when a throughput falls below half of its baseline, which is
+// how regressions such as a process spawned per constant show up.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <EncodingDecoding.h>
+#include <InstructionSet.h>
+#include <SysdarftAssembler.h>
+
+struct benchmark_result_t
+{
+    std::string name;
+    uint64_t lines;
+    uint64_t bytes;
+    double seconds;
+};
+
+std::vector < std::string > generate_corpus()
+{
+    const std::map < uint8_t, std::vector < std::string > > registers = {
+        { 0,              { "%FER9", "%XMM2" } },
+        { _8bit_prefix,   { "%R3" } },
+        { _16bit_prefix,  { "%EXR2" } },
+        { _32bit_prefix,  { "%HER5" } },
+        { _64bit_prefix,  { "%FER9", "%SP" } },
+    };
+
+    const std::vector < std::string > constants = {
+        "$(0x2A)", "$(0x1234)", "$(0x12345678)", "$(0x123456789ABC)", "$(-3 * 4 + 0x10)", "$(3.14159)",
+    };
+
+    const std::vector < std::string > memories = {
+        "*2&64($(0x1000), %FER1, $(8))", "*1&32(%FER2, $(0), %FER3)", "*16&8($(0xC1800), $(0x20), $(0))",
+        "*4&16(%FER5, %FER4, $(0x10 * 2))",
+    };
+
+    const std::map < uint8_t, std::string > widths = {
+        { _8bit_prefix, " .8bit" }, { _16bit_prefix, " .16bit" }, { _32bit_prefix, " .32bit" }, { _64bit_prefix, " .64bit" },
+    };
+
+    // instruction_map is unordered, sort it so every run times the same corpus
+    std::map < std::string, std::map < std::string, uint64_t > > instructions(instruction_map.begin(), instruction_map.end());
+
+    std::vector < std::string > corpus;
+    for (const auto & [name, entry] : instructions)
+    {
+        std::vector < std::pair < uint8_t, std::string > > variants;
+        if (entry.at(ENTRY_REQUIRE_OPERATION_WIDTH_SPECIFICATION) != 0) {
+            for (const auto & [width, text] : widths) {
+                variants.emplace_back(width, name + text);
+            }
+        } else {
+            variants.emplace_back(0, name);
+        }
+
+        for (const auto & [width, prefix] : variants)
+        {
+            std::vector < std::string > operands = registers.at(width);
+            operands.insert(operands.end(), constants.begin(), constants.end());
+            operands.insert(operands.end(), memories.begin(), memories.end());
+
+            switch (entry.at(ENTRY_ARGUMENT_COUNT))
+            {
+            case 0: corpus.push_back(prefix); break;
+            case 1:
+                for (const auto & operand : operands) {
+                    corpus.push_back(prefix + " <" + operand + ">");
+                }
+                break;
+            default:
+                for (const auto & first : operands) {
+                    for (const auto & second : operands) {
+                        corpus.push_back(prefix + " <" + first + ">, <" + second + ">");
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    return corpus;
+}
+
+// best of three runs, the corpus is walked repeat times per run
+benchmark_result_t measure(const std::string & name, const int repeat, const std::function < uint64_t () > & pass,
+    const uint64_t lines)
+{
+    benchmark_result_t result { .name = name, .lines = lines * repeat, .bytes = 0, .seconds = 0 };
+    for (int run = 0; run < 3; run++)
+    {
+        uint64_t bytes = 0;
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; i++) {
+            bytes += pass();
+        }
+        const std::chrono::duration < double > elapsed = std::chrono::steady_clock::now() - begin;
+
+        if (run == 0 || elapsed.count() < result.seconds) {
+            result.seconds = elapsed.count();
+        }
+        result.bytes = bytes;
+    }
+
+    return result;
+}
+
+double lines_per_second(const benchmark_result_t & result) {
+    return static_cast<double>(result.lines) / result.seconds;
+}
+
+double bytes_per_second(const benchmark_result_t & result) {
+    return static_cast<double>(result.bytes) / result.seconds;
+}
+
+// name -> bytes/s of a previous run, as printed below
+std::map < std::string, double > load_baseline(const std::string & path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open baseline " + path);
+    }
+
+    std::map < std::string, double > baseline;
+    for (std::string line; std::getline(file, line); )
+    {
+        char name[64] { };
+        double value = 0;
+        const auto bytes = line.find("\"bytes_per_second\":");
+        if (std::sscanf(line.c_str(), "{\"benchmark\":\"%63[^\"]\"", name) == 1 && bytes != std::string::npos
+            && std::sscanf(line.c_str() + bytes + std::strlen("\"bytes_per_second\":"), "%lf", &value) == 1)
+        {
+            baseline[name] = value;
+        }
+    }
+
+    return baseline;
+}
+
+int main(int argc, char ** argv)
+{
+    int repeat = 10;
+    std::string baseline_file;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--repeat") && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--check") && i + 1 < argc) {
+            baseline_file = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--repeat N] [--check BASELINE]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto corpus = generate_corpus();
+    std::vector < std::string_view > views(corpus.begin(), corpus.end());
+    std::string source;
+    for (const auto & line : corpus) {
+        source += line + "\n";
+    }
+
+    std::vector < uint8_t > standard, compact;
+    for (const auto & line : corpus)
+    {
+        encode_instruction(standard, line);
+        encode_instruction(compact, line, COMPACT_ENCODING);
+    }
+
+    auto encode = [&corpus](const encoding_mode_t mode)
+    {
+        return [&corpus, mode]
+        {
+            std::vector < uint8_t > buffer;
+            for (const auto & line : corpus) {
+                encode_instruction(buffer, line, mode);
+            }
+            return static_cast<uint64_t>(buffer.size());
+        };
+    };
+
+    auto decode = [](const std::vector < uint8_t > & buffer)
+    {
+        return [&buffer]
+        {
+            std::string text;
+            for (uint64_t offset = 0; offset < buffer.size(); )
+            {
+                text.clear();
+                decode_instruction(text, buffer, offset);
+            }
+            return static_cast<uint64_t>(buffer.size());
+        };
+    };
+
+    encoding_arena_t arena;
+    const auto lines = static_cast<uint64_t>(corpus.size());
+    const std::vector < benchmark_result_t > results = {
+        measure("encode_instruction", repeat, encode(STANDARD_ENCODING), lines),
+        measure("encode_instruction_compact", repeat, encode(COMPACT_ENCODING), lines),
+        measure("encode_instructions", repeat, [&]
+        {
+            std::vector < uint8_t > buffer;
+            std::vector < uint64_t > offsets;
+            encode_instructions(buffer, views, arena, offsets);
+            return static_cast<uint64_t>(buffer.size());
+        }, lines),
+        measure("assemble", repeat, [&source]
+        {
+            return static_cast<uint64_t>(SysdarftAssembler(BIOS_START, 1).assemble(source).size());
+        }, lines),
+        measure("decode_instruction", repeat, decode(standard), lines),
+        measure("decode_instruction_compact", repeat, decode(compact), lines),
+        measure("skip_instruction", repeat, [&standard]
+        {
+            for (uint64_t offset = 0; offset < standard.size(); ) {
+                skip_instruction(standard, offset);
+            }
+            return static_cast<uint64_t>(standard.size());
+        }, lines),
+    };
+
+    for (const auto & result : results)
+    {
+        std::printf("{\"benchmark\":\"%s\",\"lines\":%lu,\"bytes\":%lu,\"seconds\":%.6f,"
+                    "\"lines_per_second\":%.1f,\"bytes_per_second\":%.1f}\n",
+            result.name.c_str(), result.lines, result.bytes, result.seconds,
+            lines_per_second(result), bytes_per_second(result));
+    }
+
+    if (baseline_file.empty()) {
+        return EXIT_SUCCESS;
+    }
+
+    int regressions = 0;
+    for (const auto baseline = load_baseline(baseline_file); const auto & result : results)
+    {
+        if (const auto it = baseline.find(result.name); it != baseline.end() && bytes_per_second(result) < it->second / 2)
+        {
+            std::cerr << "Regression: " << result.name << " at " << bytes_per_second(result)
+                      << " bytes/s, baseline " << it->second << " bytes/s" << std::endl;
+            regressions++;
+        }
+    }
+
+    return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,70 @@
+// Cost of calling into a module: SysdarftModule::call() against a function resolved by bind().
+//
+// Usage: benchmark.module [--calls N]
+//
+// One JSON object is printed per benchmark, like benchmark.coding.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <SysdarftModule.h>
+
+double seconds_for(const std::function < void () > & pass)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    pass();
+    const std::chrono::duration < double > elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count();
+}
+
+void print_result(const char * name, const uint64_t calls, const double seconds)
+{
+    std::printf("{\"benchmark\":\"%s\",\"calls\":%lu,\"seconds\":%.6f,\"calls_per_second\":%.1f,"
+                "\"nanoseconds_per_call\":%.2f}\n",
+        name, calls, seconds, static_cast<double>(calls) / seconds, seconds * 1e9 / static_cast<double>(calls));
+}
+
+int main(int argc, char ** argv)
+{
+    uint64_t calls = 1000000;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--calls") && i + 1 < argc) {
+            calls = std::max<uint64_t>(1, std::strtoull(argv[++i], nullptr, 0));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--calls N]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    SysdarftModule Module("./libExampleModule.so");
+
+    const auto call_seconds = seconds_for([&]
+    {
+        for (uint64_t i = 0; i < calls; i++) {
+            Module.call<void>("inc");
+        }
+    });
+
+    const auto bind_seconds = seconds_for([&]
+    {
+        const auto inc = Module.bind<void()>("inc");
+        for (uint64_t i = 0; i < calls; i++) {
+            inc();
+        }
+    });
+
+    print_result("call", calls, call_seconds);
+    print_result("bind", calls, bind_seconds);
+
+    if (Module.bind<int()>("get")() != static_cast<int>(calls * 2)) {
+        std::cerr << "Lost calls" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
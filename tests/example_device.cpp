@@ -0,0 +1,148 @@
+#include <cstdio>
+#include <cstring>
+#include <SysdarftDeviceABI.h>
+
+/*
+ * A device filling guest memory:
+ *  MMIO page EXAMPLE_DEVICE_PAGE
+ *      0x00    scratch register
+ *      0x08    DMA address
+ *      0x10    DMA size
+ *      0x18    write: fill [DMA address, DMA address + DMA size) with the byte written, raise IRQ 5
+ *  Port 0x60   latch, reads return the value written plus one
+ *
+ * Registers and latch are kept across a hot reload.
+ */
+
+#define EXAMPLE_DEVICE_PAGE 0x1F00
+#define EXAMPLE_DEVICE_IRQ  5
+
+#ifdef EXAMPLE_DEVICE_ABI_VERSION
+extern "C" __attribute__((visibility("default"))) const uint32_t sysdarft_device_abi_version = EXAMPLE_DEVICE_ABI_VERSION;
+#else
+SYSDARFT_DEVICE_MODULE;
+#endif
+
+extern "C" {
+    int __attribute__((visibility("default")))  module_init(void);
+    void __attribute__((visibility("default"))) module_exit(void);
+    int __attribute__((visibility("default")))  sysdarft_device_attach(const sysdarft_host_api_t * host, void ** device);
+    void __attribute__((visibility("default"))) sysdarft_device_detach(void * device);
+    int64_t __attribute__((visibility("default"))) sysdarft_device_save_state(void * device, void * buffer, uint64_t size);
+    int __attribute__((visibility("default")))  sysdarft_device_restore_state(void * device, const void * state, uint64_t size);
+}
+
+struct example_device_t
+{
+    const sysdarft_host_api_t * host;
+    uint64_t scratch;
+    uint64_t dma_address;
+    uint64_t dma_size;
+    uint64_t latch;
+};
+
+static example_device_t example_device;
+
+int module_init(void)
+{
+    printf("example device initialization!\n");
+    return 0;
+}
+
+void module_exit(void)
+{
+    printf("example device exit!\n");
+}
+
+static uint64_t mmio_read(void * context, const uint64_t offset, uint32_t)
+{
+    const auto * device = static_cast<example_device_t *>(context);
+    switch (offset)
+    {
+    case 0x00: return device->scratch;
+    case 0x08: return device->dma_address;
+    case 0x10: return device->dma_size;
+    default: return 0;
+    }
+}
+
+static void mmio_write(void * context, const uint64_t offset, uint32_t, const uint64_t value)
+{
+    auto * device = static_cast<example_device_t *>(context);
+    switch (offset)
+    {
+    case 0x00: device->scratch = value; break;
+    case 0x08: device->dma_address = value; break;
+    case 0x10: device->dma_size = value; break;
+    case 0x18:
+    {
+        sysdarft_memory_window_t window;
+        if (device->host->map_guest_memory(device->host->host, device->dma_address, device->dma_size, &window)
+            == SYSDARFT_DEVICE_OK)
+        {
+            memset(window.data, static_cast<int>(value), window.size);
+            device->host->raise_irq(device->host->host, EXAMPLE_DEVICE_IRQ);
+        }
+        break;
+    }
+    default: break;
+    }
+}
+
+static uint64_t port_read(void * context, uint16_t, uint32_t)
+{
+    return static_cast<example_device_t *>(context)->latch + 1;
+}
+
+static void port_write(void * context, uint16_t, uint32_t, const uint64_t value)
+{
+    static_cast<example_device_t *>(context)->latch = value;
+}
+
+int sysdarft_device_attach(const sysdarft_host_api_t * host, void ** device)
+{
+    example_device = { .host = host, .scratch = 0, .dma_address = 0, .dma_size = 0, .latch = 0 };
+
+    int result;
+    if ((result = host->register_mmio(host->host, EXAMPLE_DEVICE_PAGE, 1, mmio_read, mmio_write, &example_device)) != 0
+        || (result = host->register_ports(host->host, 0x60, 1, port_read, port_write, &example_device)) != 0
+        || (result = host->register_irq(host->host, EXAMPLE_DEVICE_IRQ)) != 0)
+    {
+        return result;
+    }
+
+    *device = &example_device;
+    return SYSDARFT_DEVICE_OK;
+}
+
+void sysdarft_device_detach(void * device)
+{
+    static_cast<example_device_t *>(device)->host = nullptr;
+}
+
+int64_t sysdarft_device_save_state(void * device, void * buffer, const uint64_t size)
+{
+    const auto * self = static_cast<example_device_t *>(device);
+    const uint64_t state[] = { self->scratch, self->dma_address, self->dma_size, self->latch };
+    if (size >= sizeof(state)) {
+        memcpy(buffer, state, sizeof(state));
+    }
+
+    return sizeof(state);
+}
+
+int sysdarft_device_restore_state(void * device, const void * state, const uint64_t size)
+{
+    uint64_t registers[4];
+    if (size != sizeof(registers)) {
+        return SYSDARFT_DEVICE_EINVAL;
+    }
+
+    memcpy(registers, state, sizeof(registers));
+    auto * self = static_cast<example_device_t *>(device);
+    self->scratch = registers[0];
+    self->dma_address = registers[1];
+    self->dma_size = registers[2];
+    self->latch = registers[3];
+    return SYSDARFT_DEVICE_OK;
+}
@@ -0,0 +1,18 @@
+#include <SysdarftDebug.h>
+
+extern "C" {
+    int __attribute__((visibility("default")))  module_init(void);
+    void __attribute__((visibility("default"))) module_exit(void);
+}
+
+int module_init(void)
+{
+    log("logging example initialization!\n");
+    return 0;
+}
+
+// printed by the log writer, after module_exit returned
+void module_exit(void)
+{
+    log("logging example exit: ", std::string("still mapped"), " ", 42, "\n");
+}
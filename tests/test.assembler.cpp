@@ -0,0 +1,280 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <SysdarftAssembler.h>
+
+const char * source = R"(
+; forward and backward references
+.equ COUNT, 4
+.equ END_ADDRESS, end + COUNT * 2       ; constants may use labels defined later
+start:
+    mov .64bit <%FER0>, <$(COUNT)>
+loop: sub .64bit <%FER0>, <$(1)>
+    mov .64bit <*1&64($(start), %FER0, $(0))>, <$(END_ADDRESS)>
+    jmp .64bit <*1&64($(loop), $(0), $(0))>     ; jump back
+end:
+    hlt
+)";
+
+int main()
+{
+    int failed = 0;
+
+    // reference: the same program with every symbol substituted by hand
+    std::vector<uint8_t> expected;
+    const uint64_t start = BIOS_START;
+    encode_instruction(expected, "mov .64bit <%FER0>, <$(4)>");
+    const uint64_t loop = BIOS_START + expected.size();
+    encode_instruction(expected, "sub .64bit <%FER0>, <$(1)>");
+    std::vector<uint8_t> scratch;
+    encode_instruction(scratch, "mov .64bit <*1&64($(0), %FER0, $(0))>, <$(0)>");
+    encode_instruction(scratch, "jmp .64bit <*1&64($(0), $(0), $(0))>");
+    const uint64_t end = BIOS_START + expected.size() + scratch.size();
+    encode_instruction(expected, "mov .64bit <*1&64($(" + std::to_string(start) + "), %FER0, $(0))>, <$("
+        + std::to_string(end + 8) + ")>");
+    encode_instruction(expected, "jmp .64bit <*1&64($(" + std::to_string(loop) + "), $(0), $(0))>");
+    encode_instruction(expected, "hlt");
+
+    SysdarftAssembler assembler;
+    if (assembler.assemble(source) != expected) {
+        log("Assembled image differs from the hand encoded one\n");
+        failed++;
+    }
+
+    if (constant_value_to_operand(assembler.get_symbols().at("end")) != end) {
+        log("Wrong address for label end\n");
+        failed++;
+    }
+
+    for (const auto * malformed : {
+        "jmp .64bit <*1&64($(nowhere), $(0), $(0))>",
+        "a: nop\na: nop",
+        ".equ A, B\n.equ B, A",
+        ".byte 1",
+        "nop\nmov .64bit <%FER0> <%FER1>" })
+    {
+        try {
+            (void)assembler.assemble(malformed);
+            log("Malformed source accepted: ", malformed, "\n");
+            failed++;
+        } catch (const SysdarftAssemblerError &) { }
+    }
+
+    // large source: chunked encoding has to match the single threaded result
+    std::string large;
+    for (int i = 0; i < 20000; i++) {
+        large += "l" + std::to_string(i) + ": add .64bit <%FER1>, <$(l" + std::to_string(19999 - i) + ")>\n";
+    }
+
+    if (SysdarftAssembler(BIOS_START, 1).assemble(large) != SysdarftAssembler(BIOS_START, 8).assemble(large)) {
+        log("Parallel assembly differs from single threaded assembly\n");
+        failed++;
+    }
+
+    // compact images decode to the same program, symbols keep their full width
+    const auto compact = SysdarftAssembler(BIOS_START, 0, COMPACT_ENCODING).assemble(source);
+    std::vector<std::string> standard_text, compact_text;
+    for (uint64_t offset = 0; offset < expected.size(); ) {
+        decode_instruction(standard_text, expected, offset);
+    }
+    for (uint64_t offset = 0; offset < compact.size(); ) {
+        decode_instruction(compact_text, compact, offset);
+    }
+
+    if (compact.size() >= expected.size() || compact_text.size() != standard_text.size()
+        || compact_text.back() != standard_text.back())
+    {
+        log("Compact assembly differs from standard assembly\n");
+        failed++;
+    }
+
+    // incremental assembly: only edited lines and lines using moved labels are encoded again
+    std::vector<std::string> program_lines = { "jmp .64bit <*1&64($(target), $(0), $(0))>" };
+    for (int i = 0; i < 5000; i++) {
+        program_lines.push_back("add .64bit <%FER1>, <$(" + std::to_string(i) + ")>");
+    }
+    program_lines.emplace_back("target: hlt");
+
+    auto join = [](const std::vector<std::string> & input) {
+        std::string ret;
+        for (const auto & line : input) {
+            ret += line + "\n";
+        }
+        return ret;
+    };
+
+    auto check_incremental = [&](SysdarftAssembler & incremental, const uint64_t expected_encoded, const char * step)
+    {
+        const auto program = join(program_lines);
+        const auto image = incremental.assemble(program);
+        if (image != SysdarftAssembler().assemble(program)) {
+            log("Incremental image differs from a full build after ", step, "\n");
+            failed++;
+        }
+
+        if (incremental.get_statistics().encoded != expected_encoded) {
+            log(step, ": expected ", expected_encoded, " encoded lines, got ", incremental.get_statistics().encoded, "\n");
+            failed++;
+        }
+    };
+
+    SysdarftAssembler incremental;
+    check_incremental(incremental, program_lines.size(), "first build");
+    check_incremental(incremental, 0, "unchanged source");
+    program_lines[2500] = "add .64bit <%FER1>, <$(114514)>";
+    check_incremental(incremental, 1, "same size edit");
+    program_lines[2500] = "add .64bit <%FER1>, <%FER2>";
+    check_incremental(incremental, 2, "edit moving a label");
+
+    incremental.save_cache("test.assembler.cache");
+    SysdarftAssembler reloaded;
+    if (!reloaded.load_cache("test.assembler.cache")) {
+        log("Cache file not written\n");
+        failed++;
+    }
+    check_incremental(reloaded, 0, "reloading the cache");
+
+    // caches of other versions and damaged ones are rebuilt, not errors
+    auto rewrite_cache = [](const std::function<void(std::string &)> & damage)
+    {
+        std::ifstream in("test.assembler.cache", std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        damage(contents);
+        std::ofstream("test.assembler.cache", std::ios::binary | std::ios::trunc) << contents;
+    };
+
+    for (const auto & [damage, step] : std::initializer_list<std::pair<std::function<void(std::string &)>, const char *>> {
+        { [](std::string & cache) { cache[7] = '2'; }, "cache of another version" },
+        { [](std::string & cache) { cache.resize(cache.size() / 2); }, "truncated cache" },
+        { [](std::string & cache) { std::memset(cache.data() + 17, 0x7f, 8); }, "cache with a corrupt length" } })
+    {
+        incremental.save_cache("test.assembler.cache");
+        rewrite_cache(damage);
+        SysdarftAssembler rebuilt;
+        try {
+            if (rebuilt.load_cache("test.assembler.cache")) {
+                log(step, ": loaded\n");
+                failed++;
+            }
+        } catch (const std::exception & e) {
+            log(step, ": ", e.what(), "\n");
+            failed++;
+        }
+    }
+
+    rewrite_cache([](std::string & cache) { cache = "not a cache at all"; });
+    try {
+        (void)SysdarftAssembler().load_cache("test.assembler.cache");
+        log("Foreign file loaded as a cache\n");
+        failed++;
+    } catch (const SysdarftAssemblerError &) { }
+    std::remove("test.assembler.cache");
+
+    // relocatable objects: linking two sources lays them out like the concatenated source
+    const std::string program = R"(
+.global entry
+entry: jmp .64bit <*1&64($(helper), $(0), $(0))>
+    mov .64bit <%FER0>, <$(table + 8)>
+    mov .64bit <%FER1>, <$(table_end - table)>
+.section data
+table: nop
+    nop
+table_end:
+)";
+    const std::string library = R"(
+.section .text
+.global helper
+helper: add .64bit <%FER1>, <$(entry)>
+    ret
+.section data
+    nop
+)";
+
+    SysdarftAssembler object_assembler;
+    std::vector<sysdarft_object_t> objects = {
+        object_assembler.assemble_object(program, "program.s"),
+        object_assembler.assemble_object(library, "library.s") };
+    std::map < std::string, constant_value_t, std::less<> > linked_symbols;
+    if (link_objects(objects, BIOS_START, linked_symbols) != SysdarftAssembler().assemble(program + library)) {
+        log("Linked objects differ from the assembled concatenation\n");
+        failed++;
+    }
+
+    objects[0].save("test.assembler.sdo");
+    if (sysdarft_object_t::peek_source_hash("test.assembler.sdo") != object_assembler.source_hash(program)) {
+        log("Object file does not record its source\n");
+        failed++;
+    }
+
+    std::vector<sysdarft_object_t> reloaded_objects = { sysdarft_object_t::load("test.assembler.sdo"), objects[1] };
+
+    // a corrupt length is reported, not allocated
+    {
+        std::ifstream in("test.assembler.sdo", std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::memset(contents.data() + 16, 0x7f, 8); // length of the name
+        std::ofstream("test.assembler.corrupt.sdo", std::ios::binary | std::ios::trunc) << contents;
+        try {
+            (void)sysdarft_object_t::load("test.assembler.corrupt.sdo");
+            log("Corrupt object file loaded\n");
+            failed++;
+        } catch (const SysdarftAssemblerError & e) {
+            if (std::string(e.what()).find("Truncated") == std::string::npos) {
+                log("Corrupt object file: ", e.what(), "\n");
+                failed++;
+            }
+        }
+        std::remove("test.assembler.corrupt.sdo");
+    }
+
+    std::remove("test.assembler.sdo");
+    std::map < std::string, constant_value_t, std::less<> > reloaded_symbols;
+    if (link_objects(reloaded_objects, BIOS_START, reloaded_symbols) != link_objects(objects, BIOS_START, linked_symbols)) {
+        log("Object differs after saving and loading it\n");
+        failed++;
+    }
+
+    for (const auto & unlinkable : {
+        std::vector<sysdarft_object_t> { objects[0] },              // helper is undefined
+        std::vector<sysdarft_object_t> { objects[0], objects[0], objects[1] } })  // entry defined twice
+    {
+        try {
+            (void)link_objects(unlinkable, BIOS_START, linked_symbols);
+            log("Unlinkable objects accepted\n");
+            failed++;
+        } catch (const SysdarftLinkerError &) { }
+    }
+
+    for (const auto * unrelocatable : {
+        "mov .64bit <%FER0>, <$(a * 2)>\na: nop",
+        "a: nop\n.section data\nb: mov .64bit <%FER0>, <$(b - a)>",
+        ".global nowhere" })
+    {
+        try {
+            (void)object_assembler.assemble_object(unrelocatable);
+            log("Unrelocatable source accepted: ", unrelocatable, "\n");
+            failed++;
+        } catch (const SysdarftAssemblerError &) { }
+    }
+
+    // the location is added once to the message of whatever went wrong on that line
+    for (const auto * faulty : { "nop\n.bogus", "nop\nmov .64bit <%FER0>, <$(1 +)>", "nop\nfrobnicate" })
+    {
+        try {
+            (void)object_assembler.assemble_object(faulty, "faulty.s");
+            log("Faulty source accepted: ", faulty, "\n");
+            failed++;
+        } catch (const SysdarftAssemblerError & e) {
+            const std::string message = e.what();
+            if (message.find("faulty.s:2: ") == std::string::npos || message.rfind(">>>") != 0
+                || message.find("Assembler error") != message.rfind("Assembler error"))
+            {
+                log("Badly located error: ", message, "\n");
+                failed++;
+            }
+        }
+    }
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -28,6 +28,7 @@ int main()
     encode_instruction(buffer, "neg .64bit <%FER0>");
     encode_instruction(buffer, "cmp .16bit <%EXR0>, <%EXR1>");
     encode_instruction(buffer, "nop");
+    encode_instruction(buffer, "int3");
     encode_instruction(buffer, "mov .64bit <*2&64($(255), %FER14, $(4))>, <$(114514)>");
     encode_instruction(buffer, "mov .64bit <*2&64($(255), %FER14, $(6))>, <$(0xFFF)>");
     encode_instruction(buffer, "mov .64bit <%FER0>, <*2&64($(255), %FER14, $(6))>");
@@ -72,19 +73,161 @@ int main()
     encode_instruction(buffer, "mov .64bit <%EP>, <$(0xFF)>");
 
     uint64_t IP = 0;
-    const uint64_t Space = buffer.size();
-    while (!buffer.empty())
+    while (IP < buffer.size())
     {
         std::stringstream line_num;
         line_num
             << std::hex << std::uppercase << std::setfill('0') << std::setw(16)
             << IP;
         lines.emplace_back(line_num.str());
-        decode_instruction(lines, buffer);
-        IP = Space - buffer.size();
+        decode_instruction(lines, buffer, IP);
     }
 
     for (auto it = lines.begin(); it != lines.end(); it += 2) {
         std::cout << *it << ": " << *(it + 1) << std::endl;
     }
+
+    int failed = 0;
+
+    // decoded text encodes back to the same bytes, and the vector wrapper agrees with the cursor
+    std::vector<uint8_t> reencoded;
+    std::vector<uint8_t> remaining = buffer;
+    std::vector<std::string> wrapper_lines;
+    for (auto it = lines.begin(); it != lines.end(); it += 2)
+    {
+        encode_instruction(reencoded, *(it + 1));
+        decode_instruction(wrapper_lines, remaining);
+        if (wrapper_lines.back() != *(it + 1)) {
+            log("Compatibility wrapper decoded ", wrapper_lines.back(), " instead of ", *(it + 1), "\n");
+            failed++;
+        }
+    }
+
+    if (reencoded != buffer || !remaining.empty()) {
+        log("Decoded instructions do not encode back to the original buffer\n");
+        failed++;
+    }
+
+    // batch encoding, spanning several arena blocks, matches line by line encoding
+    std::vector<std::string_view> batch;
+    for (int i = 0; i < 40; i++) {
+        for (auto it = lines.begin(); it != lines.end(); it += 2) {
+            batch.emplace_back(*(it + 1));
+        }
+    }
+
+    std::vector<uint8_t> batch_buffer;
+    std::vector<uint64_t> offsets;
+    encoding_arena_t arena;
+    batch_buffer.reserve(buffer.size() * 40);
+    encode_instructions(batch_buffer, batch, arena, offsets);
+    for (std::size_t i = 0; i < batch.size() && offsets.size() == batch.size() + 1; i++)
+    {
+        std::vector<uint8_t> single;
+        encode_instruction(single, std::string(batch[i]));
+        if (!std::equal(single.begin(), single.end(), batch_buffer.begin() + static_cast<std::ptrdiff_t>(offsets[i]))
+            || offsets[i + 1] - offsets[i] != single.size())
+        {
+            log("Batch encoding differs at line ", i, ": ", batch[i], "\n");
+            failed++;
+            break;
+        }
+    }
+
+    if (offsets.size() != batch.size() + 1 || offsets.back() != batch_buffer.size()) {
+        log("Wrong batch offsets\n");
+        failed++;
+    }
+
+    const std::string_view bad_batch[] = { "nop", "mov .64bit <%FER0> <%FER1>" };
+    try {
+        encode_instructions(batch_buffer, bad_batch, arena, offsets);
+        log("Malformed batch accepted\n");
+        failed++;
+    } catch (const InstructionExpressionError &) {
+        if (offsets.size() != batch.size() + 1 || offsets.back() != batch_buffer.size()) {
+            log("Failed batch left output behind\n");
+            failed++;
+        }
+    }
+
+    // compact encoding decodes to the same text in fewer bytes, and is reproduced from that text
+    std::vector<uint8_t> compact;
+    std::vector<std::string> compact_texts;
+    for (auto it = lines.begin(); it != lines.end(); it += 2) {
+        encode_instruction(compact, *(it + 1), COMPACT_ENCODING);
+    }
+    encode_instruction(compact, "mov .64bit <%FER0>, <*1&64(%FER1, $(0), %FER2)>", COMPACT_ENCODING);
+
+    std::vector<uint8_t> recompacted;
+    for (uint64_t offset = 0; offset < compact.size(); )
+    {
+        decode_instruction(compact_texts, compact, offset);
+        encode_instruction(recompacted, compact_texts.back(), COMPACT_ENCODING);
+    }
+
+    if (compact_texts.size() != lines.size() / 2 + 1 || compact.size() >= buffer.size() || recompacted != compact) {
+        log("Compact encoding does not round trip\n");
+        failed++;
+    }
+
+    for (std::size_t i = 0; i + 1 < compact_texts.size() && i * 2 + 1 < lines.size(); i++)
+    {
+        if (compact_texts[i] != lines[i * 2 + 1]) {
+            log("Compact encoding decoded ", compact_texts[i], " instead of ", lines[i * 2 + 1], "\n");
+            failed++;
+        }
+    }
+
+    if (compact_texts.back() != "MOV .64bit <%FER0>, <*1&64(%FER1, $(0x0), %FER2)>") {
+        log("Register only memory operand decoded as ", compact_texts.back(), "\n");
+        failed++;
+    }
+
+    // skipping has to stop exactly where decoding stops, also on garbage
+    std::vector<uint8_t> garbage(65536);
+    uint32_t seed = 0x2545F491;
+    for (auto & byte : garbage) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        byte = static_cast<uint8_t>(seed);
+    }
+
+    for (uint64_t decoded = 0, skipped = 0; decoded < garbage.size(); )
+    {
+        std::string text;
+        decode_instruction(text, garbage, decoded);
+        skip_instruction(garbage, skipped);
+        if (decoded != skipped) {
+            log("skip_instruction() stopped at ", skipped, ", decode_instruction() at ", decoded, "\n");
+            failed++;
+            break;
+        }
+    }
+
+    // malformed lines are rejected with the column of the offending token
+    const std::pair < const char *, const char * > malformed[] = {
+        { "mov .64bit <%FER0> <%FER1>",     "column 20" },
+        { "mov .64bit <%FER16>, <$(1)>",    "column 17" },
+        { "mov .64bit <%FER0>, <$(1+)>",    "column 22" },
+        { "mov .64bit <*3&64($(1), $(2), $(3))>, <%FER0>", "column 14" },
+        { "mov .8bit <%R0>, <%FER1>",       "column 19" },
+        { "mvo .64bit <%FER0>, <%FER1>",    "column 1" },
+    };
+
+    for (const auto & [line, column] : malformed)
+    {
+        try {
+            std::vector<uint8_t> scratch;
+            encode_instruction(scratch, line);
+            log("Malformed instruction accepted: ", line, "\n");
+            failed++;
+        } catch (const SysdarftBaseError & Err) {
+            if (!std::string(Err.what()).contains(column)) {
+                log("Expected ", column, " in error for ", line, "\n");
+                failed++;
+            }
+        }
+    }
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -14,6 +14,45 @@ public:
 
 int main(int argc, char **)
 {
+    // only changed cells are written, close runs are joined
+    std::vector < ui_span_t > spans;
+    SysdarftTextFramebuffer shown, wanted;
+    shown.fill('.');
+    shown.write_text(0, 3, "abcdefghijkl");
+    wanted = shown;
+    wanted.set_cell(1, 3, 'X');
+    wanted.set_cell(3, 3, 'X');
+    wanted.set_cell(10, 3, 'X');
+    wanted.set_cell(11, 3, 'k' | SysdarftTextFramebuffer::ATTR_BOLD << 8);
+    wanted.set_cell(V_WIDTH - 1, 3, 'X');
+    wanted.changed_spans(shown, 3, spans);
+    if (spans.size() != 3 || spans[0].begin != 1 || spans[0].length != 3
+        || spans[1].begin != 10 || spans[1].length != 2 || spans[2].begin != V_WIDTH - 1 || spans[2].length != 1)
+    {
+        log("Wrong damaged spans\n");
+        return EXIT_FAILURE;
+    }
+
+    const auto changed = wanted.changed_cells(shown, 3);
+    if (changed[0] != 0b110000001010 || changed[1] != 1ull << (V_WIDTH - 1 - 64)
+        || wanted.cell(11, 3) != ('k' | SysdarftTextFramebuffer::ATTR_BOLD << 8))
+    {
+        log("Wrong changed cells\n");
+        return EXIT_FAILURE;
+    }
+
+    wanted.changed_spans(shown, 4, spans);
+    if (!spans.empty()) {
+        log("Unchanged row damaged\n");
+        return EXIT_FAILURE;
+    }
+
+    shown.copy_row(wanted, 3);
+    if (shown != wanted) {
+        log("Row not copied\n");
+        return EXIT_FAILURE;
+    }
+
     SysdarftCursesUI curses;
     g_input_processor_install(dummy, input_processor);
 
@@ -1,84 +1,100 @@
+#include <algorithm>
 #include <SysdarftCPUDecoder.h>
 #include <EncodingDecoding.h>
 
+const char * program[] = {
+    "add .64bit <*2&64($(255), %FER14, $(4))>, <$(114514)>",
+    "add .64bit <%FER14>, <*2&64($(255), %FER14, $(4))>",
+    "add .8bit <%R2>, <$(0xFF)>",
+    "add .8bit <%R3>, <$(0xA0)>",
+    "add .8bit <%R0>, <$(0x02)>",
+    "add .8bit <%R1>, <$(0x30)>",
+    "add .8bit <%R0>, <%R2>",
+    "adc .8bit <%R1>, <%R3>",
+    "sub .16bit <%EXR0>, <$(0xFFFF)>",
+    "mov .16bit <%EXR0>, <$(-32)>",
+    "imul .16bit <$(-2)>",
+    "mov .32bit <%HER0>, <$(65536)>",
+    "mov .32bit <%HER2>, <$(0x02)>",
+    "mul .32bit <%HER2>",
+    "mov .64bit <%FER0>, <$(-65536)>",
+    "mov .64bit <%FER1>, <$(-2)>",
+    "idiv .64bit <%FER1>",
+    "div .64bit <$(3)>",
+    "neg .64bit <%FER0>",
+    "cmp .16bit <%EXR0>, <%EXR1>",
+    "nop",
+    "mov .64bit <*2&64($(255), %FER14, $(4))>, <$(114514)>",
+    "mov .64bit <*2&64($(255), %FER14, $(6))>, <$(0xFFF)>",
+    "mov .64bit <%FER0>, <*2&64($(255), %FER14, $(6))>",
+    "mov .64bit <%FER1>, <*2&64($(255), %FER14, $(4))>",
+    "mov .64bit <%FER3>, <*1&64(%FER14, $(0), %FER1)>",
+    "xchg .64bit <%FER0>, <%FER1>",
+    "mov .64bit <%SP>, <$(0xFFFF)>",
+    "push .64bit <%FER0>",
+    "pop .64bit <%FER2>",
+    "pushall",
+    "div .64bit <%FER1>",
+    "popall",
+    "enter .64bit <$(0xFF)>",
+    "leave",
+    "mov .64bit <%FER0>, <$(0x00)>",
+    "mov .64bit <%FER1>, <$(0xC1800)>",
+    "mov .64bit <%FER2>, <$(0xFFF)>",
+    "movs",
+    "mov .64bit <*2&64($(255), %FER14, $(4))>, <$(114514)>",
+    "mov .64bit <*2&64($(255), %FER14, $(6))>, <$(0xFFF)>",
+    "and .64bit <*2&64($(255), %FER14, $(4))>, <*2&64($(255), %FER14, $(6))>",
+    "mov .64bit <%FER0>, <*2&64($(255), %FER14, $(4))>",
+    "or .32bit <%HER1>, <%HER0>",
+    "xor .64bit <%FER0>, <%FER0>",
+    "mov .8bit <%R0>, <$(0x34)>",
+    "not .64bit <%FER0>",
+    "shl .8bit <%R0>, <$(4)>",
+    "shr .8bit <%R0>, <$(6)>",
+    "mov .8bit <%R0>, <$(0xF4)>",
+    "rol .8bit <%R0>, <$(2)>",
+    "ror .8bit <%R0>, <$(1)>",
+    "mov .8bit <%R0>, <$(0x8F)>",
+    "rcl .8bit <%R0>, <$(1)>",
+    "rcr .8bit <%R0>, <$(1)>",
+    "fadd <%XMM2>, <$(3.141592653589793)>",
+    "fdiv <$(3.141592653589793)>",
+    "mov .64bit <%SB>, <$(0xFF)>",
+    "mov .64bit <%SP>, <$(0xFF)>",
+    "mov .64bit <%CB>, <$(0xFF)>",
+    "mov .64bit <%DB>, <$(0xFF)>",
+    "mov .64bit <%DP>, <$(0xFF)>",
+    "mov .64bit <%EB>, <$(0xFF)>",
+    "mov .64bit <%EP>, <$(0xFF)>"
+};
+
 class CodeBase : public SysdarftCPUInstructionDecoder {
 public:
+    std::vector<std::string> literals;
+    std::vector<std::string> mnemonics;
 
-    CodeBase()
+    explicit CodeBase(const encoding_mode_t mode, const bool with_literal = true)
     {
         std::vector<uint8_t> buffer;
-        encode_instruction(buffer, "add .64bit <*2&64($(255), %FER14, $(4))>, <$(114514)>");
-        encode_instruction(buffer, "add .64bit <%FER14>, <*2&64($(255), %FER14, $(4))>");
-        encode_instruction(buffer, "add .8bit <%R2>, <$(0xFF)>");
-        encode_instruction(buffer, "add .8bit <%R3>, <$(0xA0)>");
-        encode_instruction(buffer, "add .8bit <%R0>, <$(0x02)>");
-        encode_instruction(buffer, "add .8bit <%R1>, <$(0x30)>");
-        encode_instruction(buffer, "add .8bit <%R0>, <%R2>");
-        encode_instruction(buffer, "adc .8bit <%R1>, <%R3>");
-        encode_instruction(buffer, "sub .16bit <%EXR0>, <$(0xFFFF)>");
-        encode_instruction(buffer, "mov .16bit <%EXR0>, <$(-32)>");
-        encode_instruction(buffer, "imul .16bit <$(-2)>");
-        encode_instruction(buffer, "mov .32bit <%HER0>, <$(65536)>");
-        encode_instruction(buffer, "mov .32bit <%HER2>, <$(0x02)>");
-        encode_instruction(buffer, "mul .32bit <%HER2>");
-        encode_instruction(buffer, "mov .64bit <%FER0>, <$(-65536)>");
-        encode_instruction(buffer, "mov .64bit <%FER1>, <$(-2)>");
-        encode_instruction(buffer, "idiv .64bit <%FER1>");
-        encode_instruction(buffer, "div .64bit <$(3)>");
-        encode_instruction(buffer, "neg .64bit <%FER0>");
-        encode_instruction(buffer, "cmp .16bit <%EXR0>, <%EXR1>");
-        encode_instruction(buffer, "nop");
-        encode_instruction(buffer, "mov .64bit <*2&64($(255), %FER14, $(4))>, <$(114514)>");
-        encode_instruction(buffer, "mov .64bit <*2&64($(255), %FER14, $(6))>, <$(0xFFF)>");
-        encode_instruction(buffer, "mov .64bit <%FER0>, <*2&64($(255), %FER14, $(6))>");
-        encode_instruction(buffer, "mov .64bit <%FER1>, <*2&64($(255), %FER14, $(4))>");
-        encode_instruction(buffer, "xchg .64bit <%FER0>, <%FER1>");
-        encode_instruction(buffer, "mov .64bit <%SP>, <$(0xFFFF)>");
-        encode_instruction(buffer, "push .64bit <%FER0>");
-        encode_instruction(buffer, "pop .64bit <%FER2>");
-        encode_instruction(buffer, "pushall");
-        encode_instruction(buffer, "div .64bit <%FER1>");
-        encode_instruction(buffer, "popall");
-        encode_instruction(buffer, "enter .64bit <$(0xFF)>");
-        encode_instruction(buffer, "leave");
-        encode_instruction(buffer, "mov .64bit <%FER0>, <$(0x00)>");
-        encode_instruction(buffer, "mov .64bit <%FER1>, <$(0xC1800)>");
-        encode_instruction(buffer, "mov .64bit <%FER2>, <$(0xFFF)>");
-        encode_instruction(buffer, "movs");
-        encode_instruction(buffer, "mov .64bit <*2&64($(255), %FER14, $(4))>, <$(114514)>");
-        encode_instruction(buffer, "mov .64bit <*2&64($(255), %FER14, $(6))>, <$(0xFFF)>");
-        encode_instruction(buffer, "and .64bit <*2&64($(255), %FER14, $(4))>, <*2&64($(255), %FER14, $(6))>");
-        encode_instruction(buffer, "mov .64bit <%FER0>, <*2&64($(255), %FER14, $(4))>");
-        encode_instruction(buffer, "or .32bit <%HER1>, <%HER0>");
-        encode_instruction(buffer, "xor .64bit <%FER0>, <%FER0>");
-        encode_instruction(buffer, "mov .8bit <%R0>, <$(0x34)>");
-        encode_instruction(buffer, "not .64bit <%FER0>");
-        encode_instruction(buffer, "shl .8bit <%R0>, <$(4)>");
-        encode_instruction(buffer, "shr .8bit <%R0>, <$(6)>");
-        encode_instruction(buffer, "mov .8bit <%R0>, <$(0xF4)>");
-        encode_instruction(buffer, "rol .8bit <%R0>, <$(2)>");
-        encode_instruction(buffer, "ror .8bit <%R0>, <$(1)>");
-        encode_instruction(buffer, "mov .8bit <%R0>, <$(0x8F)>");
-        encode_instruction(buffer, "rcl .8bit <%R0>, <$(1)>");
-        encode_instruction(buffer, "rcr .8bit <%R0>, <$(1)>");
-        encode_instruction(buffer, "fadd <%XMM2>, <$(3.141592653589793)>");
-        encode_instruction(buffer, "fdiv <$(3.141592653589793)>");
-        encode_instruction(buffer, "mov .64bit <%SB>, <$(0xFF)>");
-        encode_instruction(buffer, "mov .64bit <%SP>, <$(0xFF)>");
-        encode_instruction(buffer, "mov .64bit <%CB>, <$(0xFF)>");
-        encode_instruction(buffer, "mov .64bit <%DB>, <$(0xFF)>");
-        encode_instruction(buffer, "mov .64bit <%DP>, <$(0xFF)>");
-        encode_instruction(buffer, "mov .64bit <%EB>, <$(0xFF)>");
-        encode_instruction(buffer, "mov .64bit <%EP>, <$(0xFF)>");
+        for (const auto * line : program) {
+            encode_instruction(buffer, line, mode);
+        }
 
         uint64_t off = BIOS_START;
         for (const auto & code : buffer) {
             write_memory(off++, (char*)&code, 1);
         }
 
-        for (uint64_t i = 0; i < 64; i++) {
-            auto Instruction = pop_instruction_from_ip_and_increase_ip();
+        for (std::size_t i = 0; i < std::size(program); i++) {
+            auto Instruction = pop_instruction_from_ip_and_increase_ip(with_literal);
             log(Instruction.literal, "\n");
+            literals.emplace_back(Instruction.literal);
+            mnemonics.emplace_back(Instruction.mnemonic);
+        }
+
+        if (load<InstructionPointerType>() != BIOS_START + buffer.size()) {
+            literals.emplace_back("decoder stopped at the wrong address");
         }
     }
 };
@@ -86,5 +102,23 @@ public:
 int main()
 {
     debug::verbose = true;
-    CodeBase base;
+    const CodeBase standard(STANDARD_ENCODING);
+    const CodeBase compact(COMPACT_ENCODING);
+
+    // both encodings decode to the same instructions
+    if (standard.literals != compact.literals) {
+        log("Compact encoding decodes differently\n");
+        return EXIT_FAILURE;
+    }
+
+    // without the literal the same bytes are consumed and nothing is formatted
+    const CodeBase bare(STANDARD_ENCODING, false);
+    if (bare.mnemonics != standard.mnemonics || bare.literals.size() != standard.literals.size()
+        || std::ranges::any_of(bare.literals, [](const std::string & literal) { return !literal.empty(); }))
+    {
+        log("Decoding without literals differs\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
 }
@@ -0,0 +1,160 @@
+#include <thread>
+#include <SysdarftIOHub.h>
+#include <SysdarftMemory.h>
+#include <SysdarftModule.h>
+
+class Machine final : public SysdarftCPUMemoryAccess
+{
+public:
+    template < typename DataType >
+    DataType read(const uint64_t address)
+    {
+        DataType value;
+        read_memory(address, reinterpret_cast<char *>(&value), sizeof(value));
+        return value;
+    }
+
+    template < typename DataType >
+    void write(const uint64_t address, const DataType value) {
+        write_memory(address, reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+};
+
+int main()
+{
+    constexpr uint64_t device_base = 0x1F00 * SysdarftIOHub::page_size;
+
+    SysdarftIOHub hub;
+    Machine machine;
+    machine.attach_io_hub(hub);
+
+    SysdarftModule plain("./libExampleModule.so");
+    if (plain.is_device()) {
+        log("Plain module is a device\n");
+        return EXIT_FAILURE;
+    }
+
+    try {
+        SysdarftModule mismatched("./libExampleDeviceV2.so");
+        log("Device with an unsupported ABI version was loaded\n");
+        return EXIT_FAILURE;
+    } catch (const SysdarftModuleLibraryLoadError & error) {
+        log(error.what(), "\n");
+    }
+
+    SysdarftModule device("./libExampleDevice.so");
+    if (!device.is_device()) {
+        log("Device was not recognized\n");
+        return EXIT_FAILURE;
+    }
+
+    device.attach_device(hub);
+
+    // MMIO goes to the device, the RAM below is untouched
+    machine.write<uint64_t>(device_base, 0x1122334455667788);
+    if (machine.read<uint64_t>(device_base) != 0x1122334455667788 || machine.read<uint8_t>(device_base) != 0x88) {
+        log("MMIO register does not read back\n");
+        return EXIT_FAILURE;
+    }
+
+    // an access overlapping a device and RAM is an error
+    try {
+        (void)machine.read<uint64_t>(device_base - 4);
+        log("Access across an MMIO boundary succeeded\n");
+        return EXIT_FAILURE;
+    } catch (const SysdarftBaseError &) { }
+
+    // ports
+    hub.port_write(0x60, 2, 0x1234);
+    if (hub.port_read(0x60, 2) != 0x1235 || hub.port_read(0x61, 1) != 0xFF || hub.port_read(0x61, 8) != ~0ULL) {
+        log("Port I/O is wrong\n");
+        return EXIT_FAILURE;
+    }
+
+    // DMA straight into guest RAM, completion is an interrupt
+    if (hub.take_interrupt() != -1) {
+        log("Interrupt pending before the device raised one\n");
+        return EXIT_FAILURE;
+    }
+
+    machine.write<uint64_t>(device_base + 0x08, 0x10000);
+    machine.write<uint64_t>(device_base + 0x10, 5000);
+    machine.write<uint8_t>(device_base + 0x18, 0xAB);
+
+    if (machine.read<uint64_t>(0x10000) != 0xABABABABABABABAB || machine.read<uint8_t>(0x10000 + 4999) != 0xAB
+        || machine.read<uint8_t>(0x10000 + 5000) != 0)
+    {
+        log("DMA did not reach guest memory\n");
+        return EXIT_FAILURE;
+    }
+
+    if (hub.take_interrupt() != 5 || hub.take_interrupt() != -1) {
+        log("Device interrupt was not delivered once\n");
+        return EXIT_FAILURE;
+    }
+
+    // DMA windows stay inside guest memory
+    machine.write<uint64_t>(device_base + 0x08, 32 * 1024 * 1024 - 16);
+    machine.write<uint64_t>(device_base + 0x10, 32);
+    machine.write<uint8_t>(device_base + 0x18, 0xCD);
+    if (hub.take_interrupt() != -1 || machine.read<uint8_t>(32 * 1024 * 1024 - 16) != 0) {
+        log("DMA outside of guest memory was allowed\n");
+        return EXIT_FAILURE;
+    }
+
+    // hot reload while a CPU thread keeps accessing the device: it never sees the device missing, and the
+    // new build continues with the registers of the old one
+    machine.write<uint64_t>(device_base, 0xDEADBEEF);
+    hub.port_write(0x60, 8, 41);
+
+    std::atomic < bool > running = true;
+    std::atomic < int > failures = 0;
+    std::atomic < uint64_t > accesses = 0;
+    std::thread cpu([&]
+    {
+        hub.attach_executor();
+        while (running)
+        {
+            hub.safe_point();
+            if (machine.read<uint64_t>(device_base) != 0xDEADBEEF || hub.port_read(0x60, 8) != 42) {
+                ++failures;
+            }
+            ++accesses;
+        }
+        hub.detach_executor();
+    });
+
+    for (int i = 0; i < 5; i++)
+    {
+        const auto before = accesses.load();
+        device.reload();
+        while (accesses == before) {
+            std::this_thread::yield();
+        }
+    }
+
+    running = false;
+    cpu.join();
+
+    if (failures != 0 || !device.is_device() || machine.read<uint64_t>(device_base) != 0xDEADBEEF) {
+        log("Hot reload lost the device or its state (", failures.load(), " failed accesses)\n");
+        return EXIT_FAILURE;
+    }
+
+    // without a CPU thread the reload happens right away, modules that are not devices reload too
+    device.reload();
+    plain.reload();
+    if (hub.port_read(0x60, 8) != 42) {
+        log("Reload without a CPU thread lost the device state\n");
+        return EXIT_FAILURE;
+    }
+
+    // unloading releases everything the device registered
+    device.unload();
+    if (machine.read<uint64_t>(device_base) != 0 || hub.port_read(0x60, 2) != 0xFFFF) {
+        log("Device resources were not released\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <thread>
 #include <SysdarftDebug.h>
 
@@ -32,10 +33,55 @@ int main(int argc, char **)
 
     try {
         f1(12);
+        return EXIT_FAILURE;
     } catch (SysdarftBaseError& e) {
         std::cout << e.what() << std::endl;
-        return EXIT_SUCCESS;
     }
 
-    return EXIT_FAILURE;
+    // verbose errors only capture frames when thrown, what() symbolizes them once
+    debug::verbose = true;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++) {
+        try {
+            f3(i);
+        } catch (SysdarftBaseError&) { }
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    log("1000 verbose errors thrown in ",
+        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), " ms\n");
+
+    try {
+        f3(0);
+        return EXIT_FAILURE;
+    } catch (SysdarftBaseError& e) {
+        const SysdarftBaseError copy = e;
+        const char * report = e.what();
+        if (report != e.what() || report != copy.what()) {
+            log("Report built more than once\n");
+            return EXIT_FAILURE;
+        }
+
+        const std::string text = report;
+        if (text.find("Base error test") == std::string::npos || text.find("f3(int)+0x") == std::string::npos
+            || text.find("main+0x") == std::string::npos)
+        {
+            log("Frames not symbolized:\n", text);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // symbols are read again after the caches were dropped, as after a module was unloaded
+    debug::forget_symbols();
+    try {
+        f3(0);
+        return EXIT_FAILURE;
+    } catch (SysdarftBaseError& e) {
+        if (std::string(e.what()).find("f3(int)+0x") == std::string::npos) {
+            log("Frames not symbolized after the symbols were dropped:\n", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
 }
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstring>
+#include <EncodingDecoding.h>
+
+// Expressions as they reach the evaluator (spaces removed, capitalized),
+// paired with what `echo "..." | bc` printed for them (base 16 already converted to base 10)
+struct bc_record {
+    const char * expression;
+    const char * bc_output;
+};
+
+const bc_record bc_results[] = {
+    { "114514",                 "114514" },
+    { "0XFF",                   "255" },
+    { "0XFFFFFFFFFFFFFFFF",     "18446744073709551615" },
+    { "0XC1800",                "792576" },
+    { "-32",                    "-32" },
+    { "-65536",                 "-65536" },
+    { "1+2*3",                  "7" },
+    { "(1+2)*3",                "9" },
+    { "10-4-3",                 "3" },
+    { "100/10/5",               "2" },
+    { "7/2",                    "3" },
+    { "-7/2",                   "-3" },
+    { "-7%3",                   "-1" },
+    { "0X10%3",                 "1" },
+    { "2^10",                   "1024" },
+    { "2^3^2",                  "512" },
+    { "-2^2",                   "4" },
+    { "2^-1",                   "0" },
+    { "-(3+4)",                 "-7" },
+    { "(0X10+6)*2",             "44" },
+    { "255*4",                  "1020" },
+    { "2^64-1",                 "18446744073709551615" },
+    { "3.141592653589793",      "3.141592653589793" },
+    { "1.5*2",                  "3.0" },
+    { "2.5+1",                  "3.5" },
+    { "-0.25",                  "-.25" },
+};
+
+// What encode_constant() used to derive from bc's output
+uint64_t operand_from_bc_output(const std::string & output)
+{
+    if (output.contains('.')) {
+        const double result = strtod(output.c_str(), nullptr);
+        uint64_t ret;
+        std::memcpy(&ret, &result, sizeof(ret));
+        return ret;
+    }
+
+    return strtoull(output.c_str(), nullptr, 10);
+}
+
+int main()
+{
+    int failed = 0;
+    for (const auto & [expression, bc_output] : bc_results)
+    {
+        const auto value = evaluate_constant_expression(expression);
+        const bool is_float = std::string(bc_output).contains('.');
+        const auto expected = operand_from_bc_output(bc_output);
+        const auto actual = constant_value_to_operand(value);
+
+        if ((value.ValueType == constant_value_t::FLOAT) != is_float || expected != actual) {
+            log("Mismatch for ", expression, ": bc gave ", bc_output, ", evaluator gave ", actual, "\n");
+            failed++;
+        }
+    }
+
+    for (const auto * malformed : { "", "(1+2", "1+", "1/0", "0X", "2^200", "1.2.3", "%R0" })
+    {
+        try {
+            (void)evaluate_constant_expression(malformed);
+            log("Malformed expression accepted: ", malformed, "\n");
+            failed++;
+        } catch (const SysdarftCodeExpressionError &) { }
+    }
+
+    // throughput
+    constexpr int rounds = 10000;
+    uint64_t checksum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        for (const auto & [expression, bc_output] : bc_results) {
+            checksum += constant_value_to_operand(evaluate_constant_expression(expression));
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto seconds = std::chrono::duration<double>(end - begin).count();
+    const auto evaluated = static_cast<double>(rounds) * std::size(bc_results);
+    log("Evaluated ", evaluated, " expressions in ", seconds, "s (",
+        static_cast<uint64_t>(evaluated / seconds), " expressions/s, checksum ", checksum, ")\n");
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
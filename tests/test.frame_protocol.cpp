@@ -0,0 +1,62 @@
+#include <SysdarftFrameProtocol.h>
+
+int main()
+{
+    SysdarftTextFramebuffer screen, viewer;
+    screen.fill('.');
+    screen.write_text(3, 4, "Keyframe", SysdarftTextFramebuffer::ATTR_BOLD);
+    frame_protocol::cursor_state_t cursor { .position = { 5, 6 }, .visible = true };
+    frame_protocol::cursor_state_t viewer_cursor { };
+
+    // a keyframe carries the whole screen
+    const auto keyframe = frame_protocol::encode_keyframe(screen, cursor);
+    if (keyframe.size() != 8 + 2 * V_WIDTH * V_HEIGHT || !frame_protocol::apply(keyframe, viewer, viewer_cursor)
+        || viewer != screen || viewer_cursor != cursor)
+    {
+        log("Keyframe not applied\n");
+        return EXIT_FAILURE;
+    }
+
+    // nothing changed, nothing is sent
+    auto previous = screen;
+    auto previous_cursor = cursor;
+    if (!frame_protocol::encode_delta(screen, previous, cursor, previous_cursor).empty()) {
+        log("Delta of an unchanged screen\n");
+        return EXIT_FAILURE;
+    }
+
+    // a delta only carries the changed runs
+    screen.write_text(10, 0, "ab");
+    screen.set_cell(13, 0, 'c');
+    screen.set_cell(V_WIDTH - 1, V_HEIGHT - 1, '!' | SysdarftTextFramebuffer::ATTR_REVERSE << 8);
+    const auto delta = frame_protocol::encode_delta(screen, previous, cursor, previous_cursor);
+    // header, run count, two runs: "ab.c" and "!"
+    if (delta.size() != 6 + 2 + (3 + 2 * 4) + (3 + 2 * 1) || !frame_protocol::apply(delta, viewer, viewer_cursor)
+        || viewer != screen)
+    {
+        log("Delta of ", delta.size(), " bytes not applied\n");
+        return EXIT_FAILURE;
+    }
+
+    // the cursor alone is a change too
+    previous = screen;
+    cursor = { .position = { 7, 8 }, .visible = false };
+    const auto cursor_delta = frame_protocol::encode_delta(screen, previous, cursor, previous_cursor);
+    if (cursor_delta.size() != 8 || !frame_protocol::apply(cursor_delta, viewer, viewer_cursor)
+        || viewer_cursor != cursor)
+    {
+        log("Cursor change not sent\n");
+        return EXIT_FAILURE;
+    }
+
+    // malformed messages are refused
+    if (frame_protocol::apply(delta.substr(0, delta.size() - 1), viewer, viewer_cursor)
+        || frame_protocol::apply(keyframe.substr(0, 100), viewer, viewer_cursor)
+        || frame_protocol::apply(std::string("\x07\x00\x00\x00\x00\x00", 6), viewer, viewer_cursor))
+    {
+        log("Malformed message applied\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <SysdarftHeadlessUI.h>
+
+int main()
+{
+    const auto dump_path = std::filesystem::temp_directory_path()
+        / ("sysdarft_headless_" + std::to_string(getpid()) + ".txt");
+
+    SysdarftHeadlessUI headless;
+    headless.install();
+    headless.set_dump(dump_path.string(), SysdarftHeadlessUI::dump_mode_t::ON_CHANGE);
+    g_ui_initialize();
+
+    // everything goes through the same hooks as the other UIs
+    const std::string text = "Hello, headless";
+    for (int i = 0; i < static_cast<int>(text.size()); i++) {
+        g_ui_display_char(i, 2, text[i]);
+    }
+
+    const uint8_t region[] = { 'a', 'b', 'c', 'd' };
+    g_ui_display_region(10, 5, 2, 2, region, 2);
+    g_ui_set_cursor(4, 7);
+    headless.flush();
+
+    auto screen = headless.snapshot();
+    if (screen.glyph(0, 2) != 'H' || screen.glyph(14, 2) != 's' || screen.glyph(11, 6) != 'd'
+        || g_ui_get_cursor() != CursorPosition { 4, 7 })
+    {
+        log("Screen not updated\n");
+        return EXIT_FAILURE;
+    }
+
+    g_ui_scroll(2);
+    headless.flush();
+    screen = headless.snapshot();
+    if (screen.glyph(0, 0) != 'H' || screen.glyph(10, 3) != 'a' || screen.glyph(0, 2) != ' ') {
+        log("Screen not scrolled\n");
+        return EXIT_FAILURE;
+    }
+
+    // posting never waits for the UI thread
+    const auto frames = headless.get_frame_count();
+    for (int i = 0; i < 100000; i++) {
+        g_ui_display_char(i % V_WIDTH, 20, 'a' + i % 26);
+    }
+    headless.flush();
+
+    if (headless.get_frame_count() <= frames) {
+        log("No frame after a burst of updates\n");
+        return EXIT_FAILURE;
+    }
+
+    g_ui_cleanup();
+
+    std::ifstream dump(dump_path);
+    std::stringstream contents;
+    contents << dump.rdbuf();
+    std::filesystem::remove(dump_path);
+
+    if (contents.str().find("Hello, headless") == std::string::npos
+        || contents.str().find("cursor 4,7") == std::string::npos)
+    {
+        log("Frames not dumped:\n", contents.str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,6 +1,7 @@
 #include <array>
 #include <list>
 #include <set>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <SysdarftDebug.h>
@@ -16,5 +17,120 @@ int main()
     const std::map <std::string, int> map { { "one", 1 }, { "two", 2 } };
     log("Hello World!\n");
     log("Parameters: ", arr, " ", list, " ", vec, " ", set, " ", umap, " ", uset, " ", map, '\n');
+
+    // the asynchronous back-end prints exactly what log() prints
+    const std::vector<std::string> words = { "a", "b" };
+    const std::string_view view = "view";
+    const __uint128_t big = static_cast<__uint128_t>(1) << 100;
+    const void * pointer = &arr;
+    auto print_all = [&] {
+        log("Parameters: ", arr, " ", list, " ", vec, " ", set, " ", umap, " ", uset, " ", map, '\n');
+        log(words, view, big, ' ', 1.5, true, pointer, std::string("text"), 'c', -3, "\n");
+    };
+
+    std::stringstream sync_output, async_output;
+    auto * const stdout_buffer = std::cout.rdbuf(sync_output.rdbuf());
+    print_all();
+
+    std::cout.rdbuf(async_output.rdbuf());
+    debug::start_async_log();
+    print_all();
+    debug::stop_async_log();
+    std::cout.rdbuf(stdout_buffer);
+
+    if (sync_output.str() != async_output.str()) {
+        log("Asynchronous output differs:\n", sync_output.str(), async_output.str());
+        return EXIT_FAILURE;
+    }
+
+    // small rings under load: every record is printed in order or counted as dropped
+    constexpr int threads = 4, records = 5000;
+    std::stringstream output;
+    std::cout.rdbuf(output.rdbuf());
+    const auto dropped = debug::dropped_log_records();
+    debug::start_async_log(4096);
+
+    std::vector<std::thread> loggers;
+    for (int thread = 0; thread < threads; thread++) {
+        loggers.emplace_back([thread] {
+            for (int record = 0; record < records; record++) {
+                log(thread, " ", record, "\n");
+            }
+        });
+    }
+
+    for (auto & logger : loggers) {
+        logger.join();
+    }
+
+    debug::stop_async_log();
+    std::cout.rdbuf(stdout_buffer);
+
+    std::array<int, threads> last { -1, -1, -1, -1 };
+    int printed = 0, thread, record;
+    while (output >> thread >> record)
+    {
+        if (thread < 0 || thread >= threads || record <= last[thread]) {
+            log("Record ", thread, " ", record, " out of order\n");
+            return EXIT_FAILURE;
+        }
+        last[thread] = record;
+        printed++;
+    }
+
+    const auto lost = debug::dropped_log_records() - dropped;
+    log("Printed ", printed, ", dropped ", lost, "\n");
+    if (printed + lost != threads * records) {
+        log("Records went missing\n");
+        return EXIT_FAILURE;
+    }
+
+    // a disabled level does not evaluate its arguments
+    int evaluated = 0;
+    auto count = [&evaluated] { return ++evaluated; };
+    std::cout.rdbuf(output.rdbuf());
+    debug::set_log_level(debug::log_subsystem_t::CPU, debug::log_level_t::WARNING);
+    log_debug(CPU, "Counted ", count(), "\n");
+    log_info(CPU, "Counted ", count(), "\n");
+    log_warning(CPU, "Counted ", count(), "\n");
+    log_info(UI, "Counted ", count(), "\n");
+    std::cout.rdbuf(stdout_buffer);
+
+    // and neither does a level compiled out
+    constexpr int expected = (SYSDARFT_LOG_LEVEL <= SYSDARFT_LOG_WARNING) + (SYSDARFT_LOG_LEVEL <= SYSDARFT_LOG_INFO);
+    if (evaluated != expected) {
+        log("Arguments evaluated ", evaluated, " times instead of ", expected, "\n");
+        return EXIT_FAILURE;
+    }
+
+    auto level_of = [](const debug::log_subsystem_t subsystem) {
+        return debug::log_levels[static_cast<std::size_t>(subsystem)].load();
+    };
+
+    if (!debug::set_log_levels("error,cpu=trace,ui=none")
+        || level_of(debug::log_subsystem_t::GENERAL) != debug::log_level_t::ERROR
+        || level_of(debug::log_subsystem_t::CPU) != debug::log_level_t::TRACE
+        || level_of(debug::log_subsystem_t::UI) != debug::log_level_t::NONE)
+    {
+        log("Log level list not applied\n");
+        return EXIT_FAILURE;
+    }
+
+    if (debug::set_log_levels("info,cpu=loud") || debug::set_log_levels("disk=info") || debug::set_log_levels("")
+        || level_of(debug::log_subsystem_t::GENERAL) != debug::log_level_t::ERROR)
+    {
+        log("Malformed log level list accepted\n");
+        return EXIT_FAILURE;
+    }
+
+    // an error is only silenced by none
+    debug::set_log_levels("info");
+    if (!debug::log_enabled(debug::log_subsystem_t::MODULE, debug::log_level_t::ERROR)
+        || debug::log_enabled(debug::log_subsystem_t::MODULE, debug::log_level_t::DEBUG))
+    {
+        log("Default levels not restored\n");
+        return EXIT_FAILURE;
+    }
+
     return 0;
 }
@@ -94,5 +94,41 @@ int main()
         return EXIT_FAILURE;
     }
 
+    // typed handles: resolved before installation, follow reinstallation, reject other signatures
+    const auto typed = msg_map.handle<int(int)>("Typed", "return_any");
+    try {
+        (void)typed(1);
+        return EXIT_FAILURE;
+    } catch (const MessageMapNoSuchInstance &) { }
+
+    Instance other;
+    msg_map.install_instance("Typed", &instance, "return_any", &Instance::return_any);
+    if (!typed.installed() || typed(114514) != 114514) {
+        return EXIT_FAILURE;
+    }
+
+    const auto count = msg_map.handle<void()>("Main", "registration");
+    msg_map.install_instance("Main", &other, "registration", &Instance::registration_add_one);
+    for (int i = 0; i < 1000; ++i) {
+        count();
+    }
+
+    if (instance.c != 20000 || other.c != 1000
+        || std::any_cast<int>(msg_map.invoke_instance("Typed", "return_any", {42})) != 42)
+    {
+        return EXIT_FAILURE;
+    }
+
+    try {
+        (void)msg_map.handle<void(int)>("Typed", "return_any");
+        return EXIT_FAILURE;
+    } catch (const MessageMapArgumentMismatch &) { }
+
+    // same method installed with another signature, old handles are left uninstalled
+    msg_map.install_instance("Typed", &instance, "return_any", &Instance::return20);
+    if (typed.installed() || msg_map.handle<int()>("Typed", "return_any")() != 20) {
+        return EXIT_FAILURE;
+    }
+
     return EXIT_SUCCESS;
 }
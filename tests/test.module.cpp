@@ -28,5 +28,30 @@ int main()
         return EXIT_FAILURE;
     }
 
+    // bound functions: resolved once, called from many threads
+    const auto inc = Module.bind<void()>("inc");
+    const auto get = Module.bind<int()>("get");
+    threads.clear();
+    for (int i = 0; i < 100; i++) {
+        threads.emplace_back([&inc] {
+            for (int j = 0; j < 100; j++) {
+                inc();
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    if (get() != 20000) {
+        return EXIT_FAILURE;
+    }
+
+    try {
+        (void)Module.bind<void()>("no_such_function");
+        return EXIT_FAILURE;
+    } catch (const SysdarftModuleSymbolResolutionError &) { }
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,25 @@
+#include <SysdarftModule.h>
+
+int main()
+{
+    // records a module queued are printed before it is unmapped
+    debug::start_async_log();
+    for (int i = 0; i < 10; i++)
+    {
+        SysdarftModule Module("./libExampleLoggingModule.so");
+        Module.unload();
+    }
+
+    {
+        SysdarftModule Module("./libExampleLoggingModule.so");
+        Module.reload();
+    }
+
+    debug::stop_async_log();
+
+    if (debug::dropped_log_records() != 0) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
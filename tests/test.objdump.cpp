@@ -0,0 +1,85 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <SysdarftDebug.h>
+#include <SysdarftMemory.h>
+#include <EncodingDecoding.h>
+
+// the listing is formatted in chunks of 256 KiB
+constexpr uint64_t chunk_size = 256 * 1024;
+
+std::size_t occurrences(const std::string & text, const std::string & what)
+{
+    std::size_t count = 0;
+    for (auto at = text.find(what); at != std::string::npos; at = text.find(what, at + 1)) {
+        count++;
+    }
+
+    return count;
+}
+
+int main()
+{
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto prefix = "sysdarft_objdump_" + std::to_string(getpid());
+    const auto image_path = directory / (prefix + ".bin");
+    const auto symbols_path = directory / (prefix + ".sym");
+    const auto listing_path = directory / (prefix + ".txt");
+
+    // instructions of one length, so the first chunk ends inside a known one
+    std::vector < uint8_t > image;
+    encode_instruction(image, "add .64bit <%FER1>, <$(0x10)>");
+    const uint64_t length = image.size();
+    while (image.size() < chunk_size + 64 * length) {
+        encode_instruction(image, "add .64bit <%FER1>, <$(0x10)>");
+    }
+
+    const uint64_t chunk_end = (chunk_size + length - 1) / length * length;
+    std::ofstream(image_path, std::ios::binary).write(reinterpret_cast<const char *>(image.data()),
+        static_cast<std::streamsize>(image.size()));
+
+    std::ofstream symbols(symbols_path);
+    symbols << std::hex
+            << BIOS_START << " start\n"
+            << BIOS_START + chunk_end - 1 << " inside_last_of_chunk\n"
+            << BIOS_START + chunk_end << " next_chunk\n"
+            << BIOS_START + image.size() - 1 << " inside_last_of_image\n"
+            << BIOS_START + image.size() << " end_of_image\n";
+    symbols.close();
+
+    const auto status = debug::exec_command("./sysdarft-objdump", "-j", "2", "-s", symbols_path.string(),
+        "-o", listing_path.string(), image_path.string());
+
+    std::ifstream file(listing_path);
+    std::stringstream listing;
+    listing << file.rdbuf();
+    std::filesystem::remove(image_path);
+    std::filesystem::remove(symbols_path);
+    std::filesystem::remove(listing_path);
+
+    if (status.exit_status != 0) {
+        log("sysdarft-objdump failed: ", status.fd_stderr, "\n");
+        return EXIT_FAILURE;
+    }
+
+    const auto & text = listing.str();
+    if (occurrences(text, "\nstart:\n") != 1 || occurrences(text, "\nnext_chunk:\n") != 1
+        || occurrences(text, "\ninside_last_of_chunk: ; not on an instruction boundary") != 1
+        || occurrences(text, "\ninside_last_of_image: ; not on an instruction boundary") != 1
+        || occurrences(text, "\nend_of_image:\n") != 1
+        || occurrences(text, "not on an instruction boundary") != 2)
+    {
+        log("Symbols not labeled once each:\n", text.substr(0, 512), "\n");
+        return EXIT_FAILURE;
+    }
+
+    // symbols inside an instruction follow it
+    if (text.find("inside_last_of_chunk:") > text.find("next_chunk:")
+        || text.find("inside_last_of_image:") > text.find("end_of_image:"))
+    {
+        log("Symbol inside the last instruction of a chunk out of order\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
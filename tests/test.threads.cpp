@@ -0,0 +1,141 @@
+#include <set>
+#include <SysdarftExecutor.h>
+
+class counter_
+{
+public:
+    std::atomic < int > runs = 0;
+    std::set < std::thread::id > threads;
+    std::string name;
+    int cpu = -1;
+
+    void run(std::atomic < bool > & running)
+    {
+        threads.insert(std::this_thread::get_id());
+        char buffer[16] { };
+        pthread_getname_np(pthread_self(), buffer, sizeof(buffer));
+        name = buffer;
+        cpu = sched_getcpu();
+        ++runs;
+
+        while (running) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+int main()
+{
+    const auto cores = executor::usable_cores();
+    if (cores.empty()) {
+        log("No usable cores\n");
+        return EXIT_FAILURE;
+    }
+
+    // the same thread serves every run, named and pinned
+    counter_ counter;
+    {
+        SysdarftThread thread("A long thread name", &counter, &counter_::run, cores.back());
+        for (int i = 0; i < 3; i++)
+        {
+            thread.start();
+            while (counter.runs == i) {
+                std::this_thread::yield();
+            }
+            thread.stop();
+
+            if (thread.is_running()) {
+                log("Thread still running after stop()\n");
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (counter.runs != 3 || counter.threads.size() != 1 || counter.name != "A long thread n"
+        || counter.cpu != static_cast<int>(cores.back()))
+    {
+        log("Runs: ", counter.runs.load(), ", threads: ", counter.threads.size(), ", name: ", counter.name,
+            ", core: ", counter.cpu, "\n");
+        return EXIT_FAILURE;
+    }
+
+    // an exception ends the run, not the thread
+    {
+        std::atomic < int > runs = 0;
+        SysdarftThread thread("Failing", [&](std::atomic < bool > & running)
+        {
+            if (++runs == 2) {
+                throw std::runtime_error("expected");
+            }
+            while (running) {
+                std::this_thread::yield();
+            }
+        });
+
+        thread.start();
+        while (runs == 0) {
+            std::this_thread::yield();
+        }
+        thread.stop();
+        thread.start();
+        while (thread.is_running()) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (executor::pin_current_thread(std::vector < unsigned > { })) {
+        log("Pinned to no core\n");
+        return EXIT_FAILURE;
+    }
+
+    // the shared pool: results and errors come back through futures
+    auto & pool = SysdarftThreadPool::shared();
+    auto answer = pool.submit([] { return 42; });
+    auto failure = pool.submit([]() -> int { throw std::runtime_error("job failed"); });
+    if (answer.get() != 42) {
+        log("Wrong pool result\n");
+        return EXIT_FAILURE;
+    }
+
+    try {
+        (void)failure.get();
+        log("Pool error was lost\n");
+        return EXIT_FAILURE;
+    } catch (const std::runtime_error &) { }
+
+    // nested parallel loops inside pool jobs do not wait on each other
+    std::vector < std::future < std::size_t > > sums;
+    for (int job = 0; job < static_cast<int>(pool.size()) * 2; job++)
+    {
+        sums.push_back(pool.submit([]
+        {
+            std::atomic < std::size_t > sum = 0;
+            run_in_parallel(100, 8, [&sum](const std::size_t i) { sum += i; });
+            return sum.load();
+        }));
+    }
+
+    for (auto & sum : sums) {
+        if (sum.get() != 4950) {
+            log("Nested parallel loop lost tasks\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        run_in_parallel(10, 4, [](const std::size_t i) {
+            if (i == 3 || i == 7) {
+                throw std::runtime_error(std::to_string(i));
+            }
+        });
+        log("Parallel error was lost\n");
+        return EXIT_FAILURE;
+    } catch (const std::runtime_error & error) {
+        if (std::string(error.what()) != "3") {
+            log("Parallel error of task ", error.what(), " instead of 3\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
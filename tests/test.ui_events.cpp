@@ -0,0 +1,232 @@
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <SysdarftTextFramebuffer.h>
+#include <SysdarftUIEventQueue.h>
+
+class screen_
+{
+public:
+    SysdarftUIEventQueue queue;
+    void display_region(int x, int y, int w, int h, const uint8_t * cells, int stride) {
+        queue.display_region(x, y, w, h, cells, stride);
+    }
+    void scroll(int lines) { queue.scroll(lines); }
+} screen_events;
+
+int main()
+{
+    SysdarftUIEventQueue queue;
+    ui_frame_t frame;
+
+    // repeated writes to a cell and cursor moves collapse into their latest state
+    for (int i = 0; i < 100; i++)
+    {
+        queue.display_char(3, 4, 'a' + i % 26);
+        queue.set_cursor(i % V_WIDTH, 1);
+    }
+    queue.display_char(5, 4, 'z');
+    queue.set_cursor_visibility(false);
+
+    if (!queue.drain(frame) || frame.cells.size() != 2 || frame.cells[0].ch != 'a' + 99 % 26
+        || frame.cursor != CursorPosition { 99, 1 } || frame.cursor_visibility != false || frame.full_redraw)
+    {
+        log("Events were not coalesced\n");
+        return EXIT_FAILURE;
+    }
+
+    if (queue.drain(frame)) {
+        log("Drained events twice\n");
+        return EXIT_FAILURE;
+    }
+
+    // the wakeup descriptor is written once per batch and reset by drain()
+    auto wakeup_count = [&queue]() -> uint64_t {
+        uint64_t count = 0;
+        return read(queue.wakeup_fd(), &count, sizeof(count)) == sizeof(count) ? count : 0;
+    };
+
+    for (int i = 0; i < 50; i++) {
+        queue.display_char(i, 0, 'w');
+    }
+
+    if (wakeup_count() != 1) {
+        log("Wakeup not signalled exactly once\n");
+        return EXIT_FAILURE;
+    }
+
+    queue.display_char(1, 1, 'w');
+    queue.drain(frame);
+    if (wakeup_count() != 0) {
+        log("Wakeup still pending after drain\n");
+        return EXIT_FAILURE;
+    }
+
+    queue.display_char(2, 1, 'w');
+    if (wakeup_count() != 1 || !queue.drain(frame)) {
+        log("No wakeup after drain\n");
+        return EXIT_FAILURE;
+    }
+
+    // a producer that never lets the ring run empty does not hold frames back
+    std::atomic < bool > flooding = true;
+    std::thread flood([&queue, &flooding] {
+        for (int i = 0; flooding; i++) {
+            queue.display_char(i % V_WIDTH, 5, 'a' + i % 26);
+        }
+    });
+
+    for (int i = 0; i < 100; i++) {
+        (void)queue.drain(frame);
+    }
+
+    flooding = false;
+    flood.join();
+    while (queue.drain(frame)) { }
+
+    // several producers and a concurrent consumer: the screen ends in the last written state
+    std::array < std::array < int, V_HEIGHT >, V_WIDTH > screen { };
+    std::atomic < int > producing = 4;
+    std::vector < std::thread > producers;
+    for (int row = 0; row < 4; row++)
+    {
+        producers.emplace_back([&queue, &producing, row]
+        {
+            for (int i = 0; i < 20000; i++) {
+                queue.display_char(i % V_WIDTH, row, i);
+            }
+            --producing;
+        });
+    }
+
+    auto apply = [&]
+    {
+        for (const auto & [x, y, ch] : frame.cells) {
+            screen[x][y] = ch;
+        }
+    };
+
+    while (producing != 0)
+    {
+        if (queue.drain(frame)) {
+            apply();
+        }
+    }
+
+    for (auto & producer : producers) {
+        producer.join();
+    }
+
+    while (queue.drain(frame)) {
+        apply();
+    }
+
+    for (int row = 0; row < 4; row++)
+    {
+        for (int x = 0; x < V_WIDTH; x++)
+        {
+            // last i with i % V_WIDTH == x
+            const int expected = (19999 - x) / V_WIDTH * V_WIDTH + x;
+            if (screen[x][row] != expected) {
+                log("Cell ", x, ", ", row, " is ", screen[x][row], " instead of ", expected, "\n");
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    // a full ring drops events and redraws everything from the shadow copy
+    const auto dropped = queue.get_dropped();
+    for (std::size_t i = 0; i < SysdarftUIEventQueue::capacity + 100; i++) {
+        queue.display_char(static_cast<int>(i % V_WIDTH), 30, static_cast<int>(i));
+    }
+    queue.set_cursor(7, 8);
+
+    if (!queue.drain(frame) || !frame.full_redraw || queue.get_dropped() - dropped != 101
+        || frame.cells.size() != V_WIDTH * V_HEIGHT || frame.cursor != CursorPosition { 7, 8 })
+    {
+        log("Overflow did not cause a full redraw\n");
+        return EXIT_FAILURE;
+    }
+
+    apply();
+    if (screen[(SysdarftUIEventQueue::capacity + 99) % V_WIDTH][30] != static_cast<int>(SysdarftUIEventQueue::capacity + 99)) {
+        log("Redraw lost the latest character\n");
+        return EXIT_FAILURE;
+    }
+
+    // a whole screen is one call, and one event
+    g_ui_display_region_install(screen_events, display_region);
+    g_ui_scroll_install(screen_events, scroll);
+
+    std::vector < uint8_t > text(V_HEIGHT * 128);
+    for (std::size_t i = 0; i < text.size(); i++) {
+        text[i] = static_cast<uint8_t>('A' + i / 128 % 26);
+    }
+
+    g_ui_display_region(0, 0, V_WIDTH, V_HEIGHT, text.data(), 128);
+    if (!screen_events.queue.drain(frame) || frame.cells.size() != V_WIDTH * V_HEIGHT) {
+        log("Region was not drawn\n");
+        return EXIT_FAILURE;
+    }
+
+    apply();
+    for (int y = 0; y < V_HEIGHT; y++) {
+        if (screen[0][y] != 'A' + y % 26 || screen[V_WIDTH - 1][y] != 'A' + y % 26) {
+            log("Region row ", y, " is wrong\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // regions are clipped to the screen
+    const uint8_t block[] = { '1', '2', '3', '4', '5', '6' };
+    g_ui_display_region(V_WIDTH - 1, -1, 3, 2, block, 3);
+    if (!screen_events.queue.drain(frame) || frame.cells.size() != 1 || frame.cells[0].ch != '4'
+        || frame.cells[0].x != V_WIDTH - 1 || frame.cells[0].y != 0)
+    {
+        log("Region was not clipped\n");
+        return EXIT_FAILURE;
+    }
+
+    apply();
+    g_ui_scroll(2);
+    if (!screen_events.queue.drain(frame) || !frame.full_redraw) {
+        log("Scrolling did not redraw\n");
+        return EXIT_FAILURE;
+    }
+
+    apply();
+    if (screen[0][0] != 'C' || screen[0][V_HEIGHT - 3] != 'A' + (V_HEIGHT - 1) % 26
+        || screen[0][V_HEIGHT - 1] != ' ' || screen[V_WIDTH - 1][0] != 'C')
+    {
+        log("Scrolled screen is wrong\n");
+        return EXIT_FAILURE;
+    }
+
+    g_ui_scroll(-1);
+    (void)screen_events.queue.drain(frame);
+    apply();
+    if (screen[0][0] != ' ' || screen[0][1] != 'C') {
+        log("Scrolling down is wrong\n");
+        return EXIT_FAILURE;
+    }
+
+    // what the back-ends do with a drained frame
+    SysdarftTextFramebuffer framebuffer;
+    queue.display_char(7, 2, 'q' | SysdarftTextFramebuffer::ATTR_BOLD << 8);
+    queue.set_cursor_visibility(false);
+    (void)queue.drain(frame);
+    if (framebuffer.apply(frame, true) || framebuffer.cell(7, 2) != ('q' | SysdarftTextFramebuffer::ATTR_BOLD << 8))
+    {
+        log("Frame not applied to the framebuffer\n");
+        return EXIT_FAILURE;
+    }
+
+    queue.display_char(8, 2, 'r');
+    (void)queue.drain(frame);
+    if (framebuffer.apply(frame, false) || framebuffer.glyph(8, 2) != 'r') {
+        log("Cursor visibility changed by a frame without it\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}